@@ -4,6 +4,7 @@ const rl = @import("raylib");
 pub fn build(b: *std.Build) void {
     const target = b.standardTargetOptions(.{});
     const optimize = b.standardOptimizeOption(.{});
+    const board_size = b.option([]const u8, "board-size", "Side of the board: 15, or 21 for the super board") orelse "15";
 
     const raylib_dep = b.dependency("raylib", .{
         .target = target,
@@ -34,9 +35,29 @@ pub fn build(b: *std.Build) void {
         .files = &.{
             "src/arbol_diccionario.c",
             "src/scrabble.c",
+            "src/movegen.c",
+            "src/worker.c",
+            "src/preview.c",
+            "src/profiler.c",
+            "src/threadpool.c",
+            "src/record.c",
+            "src/gcg.c",
+            "src/analysis.c",
+            "src/snapshot.c",
+            "src/inference.c",
+            "src/wordlist.c",
+            "src/alphabet.c",
+            "src/wordhash.c",
+            "src/movecache.c",
+            "src/openings.c",
+            "src/duplicate.c",
+            "src/bot.c",
+            "src/util.c",
         },
     });
 
+    scrabble.root_module.addCMacro("BOARD_SIZE", board_size);
+
     b.installArtifact(scrabble);
 
     var graphics_mod = b.createModule(.{
@@ -53,6 +74,7 @@ pub fn build(b: *std.Build) void {
     });
 
     graphics_mod.addCMacro("ASSETS_PATH", "\"./assets/\"");
+    graphics_mod.addCMacro("BOARD_SIZE", board_size);
 
     const graphics = b.addLibrary(.{
         .name = "graphics",
@@ -70,11 +92,146 @@ pub fn build(b: *std.Build) void {
     });
 
     exe.linkLibrary(graphics);
+    exe.linkSystemLibrary("pthread");
 
     exe.addCSourceFile(.{ .file = b.path("src/main.c") });
 
+    exe.root_module.addCMacro("BOARD_SIZE", board_size);
+
     b.installArtifact(exe);
 
+    var server = b.addExecutable(.{
+        .name = "scrabble_server",
+        .target = target,
+        .optimize = optimize,
+        .link_libc = true,
+    });
+
+    server.linkLibrary(scrabble);
+    server.linkSystemLibrary("pthread");
+    server.addIncludePath(b.path("src"));
+
+    server.addCSourceFiles(.{
+        .files = &.{
+            "server/server.c",
+            "server/tables.c",
+            "server/protocol.c",
+        },
+    });
+
+    server.root_module.addCMacro("BOARD_SIZE", board_size);
+
+    b.installArtifact(server);
+
+    var loadgen = b.addExecutable(.{
+        .name = "scrabble_loadgen",
+        .target = target,
+        .optimize = optimize,
+        .link_libc = true,
+    });
+
+    loadgen.linkLibrary(scrabble);
+    loadgen.linkSystemLibrary("pthread");
+    loadgen.addIncludePath(b.path("src"));
+
+    loadgen.addCSourceFiles(.{
+        .files = &.{
+            "server/loadgen.c",
+            "server/tables.c",
+            "server/protocol.c",
+        },
+    });
+
+    loadgen.root_module.addCMacro("BOARD_SIZE", board_size);
+
+    b.installArtifact(loadgen);
+
+    var gcgtool = b.addExecutable(.{
+        .name = "scrabble_gcg",
+        .target = target,
+        .optimize = optimize,
+        .link_libc = true,
+    });
+
+    gcgtool.linkLibrary(scrabble);
+    gcgtool.linkSystemLibrary("pthread");
+    gcgtool.addIncludePath(b.path("src"));
+
+    gcgtool.addCSourceFile(.{ .file = b.path("tools/gcgtool.c") });
+
+    gcgtool.root_module.addCMacro("BOARD_SIZE", board_size);
+
+    b.installArtifact(gcgtool);
+
+    var analyze = b.addExecutable(.{
+        .name = "scrabble_analyze",
+        .target = target,
+        .optimize = optimize,
+        .link_libc = true,
+    });
+
+    analyze.linkLibrary(scrabble);
+    analyze.linkSystemLibrary("pthread");
+    analyze.addIncludePath(b.path("src"));
+
+    analyze.addCSourceFile(.{ .file = b.path("tools/analyze.c") });
+
+    analyze.root_module.addCMacro("BOARD_SIZE", board_size);
+
+    b.installArtifact(analyze);
+
+    var openings = b.addExecutable(.{
+        .name = "scrabble_openings",
+        .target = target,
+        .optimize = optimize,
+        .link_libc = true,
+    });
+
+    openings.linkLibrary(scrabble);
+    openings.linkSystemLibrary("pthread");
+    openings.addIncludePath(b.path("src"));
+
+    openings.addCSourceFile(.{ .file = b.path("tools/openings.c") });
+
+    openings.root_module.addCMacro("BOARD_SIZE", board_size);
+
+    b.installArtifact(openings);
+
+    var duplicate = b.addExecutable(.{
+        .name = "scrabble_duplicate",
+        .target = target,
+        .optimize = optimize,
+        .link_libc = true,
+    });
+
+    duplicate.linkLibrary(scrabble);
+    duplicate.linkSystemLibrary("pthread");
+    duplicate.addIncludePath(b.path("src"));
+
+    duplicate.addCSourceFile(.{ .file = b.path("tools/duplicate.c") });
+
+    duplicate.root_module.addCMacro("BOARD_SIZE", board_size);
+
+    b.installArtifact(duplicate);
+
+    var tournament = b.addExecutable(.{
+        .name = "scrabble_tournament",
+        .target = target,
+        .optimize = optimize,
+        .link_libc = true,
+    });
+
+    tournament.linkLibrary(scrabble);
+    tournament.linkSystemLibrary("pthread");
+    tournament.linkSystemLibrary("m");
+    tournament.addIncludePath(b.path("src"));
+
+    tournament.addCSourceFile(.{ .file = b.path("tools/tournament.c") });
+
+    tournament.root_module.addCMacro("BOARD_SIZE", board_size);
+
+    b.installArtifact(tournament);
+
     b.installDirectory(.{
         .source_dir = b.path("assets/"),
         .install_dir = .bin,
@@ -0,0 +1,590 @@
+// loadgen.c
+
+#include "scrabble.h"
+#include "movegen.h"
+#include "openings.h"
+#include "threadpool.h"
+#include "protocol.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Largest number of requests in one scripted game
+#define MAX_SCRIPT_STEPS 256
+
+// Most turns a script can hold: each takes a STATE and a PLAY or REROLL, and the game ends with four steps
+#define MAX_SCRIPT_TURNS ((MAX_SCRIPT_STEPS - 4) / 2)
+
+// Bytes of unread replies kept per session
+#define REPLY_BUFFER_SIZE 1024
+
+// Events handled per call to epoll_wait
+#define MAX_EVENTS 256
+
+// Percent of scripted turns that reroll the rack instead of playing, unless set with --reroll-rate
+#define DEFAULT_REROLL_RATE 5
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents one scripted request; the table id is filled in when it is sent
+typedef struct
+{
+    RequestKind kind;
+    char arguments[MAX_REQUEST_LENGTH - 16]; // Text after the table id
+    int expectedScore;                       // Score the server must answer to a PLAY
+} Step;
+
+// Represents the requests of one game, worked out beforehand by local self-play
+typedef struct
+{
+    unsigned long long seed;                 // Seed the table is dealt from, on the server and locally
+    int turns;                               // Turns the self-play may last
+    int rerollRate;                          // Percent of turns rerolled instead of played
+    Step steps[MAX_SCRIPT_STEPS];
+    int numSteps;
+    const Lexicon* lexicon;
+    const OpeningTable* openings;            // Best openings of every rack, or NULL to search the first turn
+} Script;
+
+// Represents a simulated client; each one plays its script on its own connection and table
+typedef struct
+{
+    int fd;
+    const Script* script;
+    int step;                                // Next step to send, -1 while creating the table
+    int loopsLeft;                           // Times the script is still to be played
+    int tableId;
+    RequestKind pending;                     // Operation of the request waiting for its reply
+    double sentAt;                           // When that request was sent, in microseconds
+    char replies[REPLY_BUFFER_SIZE];
+    int repliesLength;
+} Session;
+
+// Represents the latencies measured for one operation, in microseconds
+typedef struct
+{
+    double* samples;
+    long count;
+    long capacity;
+} LatencyLog;
+
+// Represents the outcome of the whole run
+typedef struct
+{
+    LatencyLog latencies[Request_Count];
+    long errors;                             // Replies that were ERR
+    long mismatches;                         // PLAY replies whose score differs from the self-play
+    int activeSessions;
+} RunTotals;
+
+// --------------------
+// Helpers
+// --------------------
+
+// Returns a monotonic timestamp in microseconds
+static double nowMicros(void)
+{
+    return nowSeconds() * 1e6;
+}
+
+// Appends a latency sample
+static void logLatency(LatencyLog* log, double micros)
+{
+    if (log->count == log->capacity)
+    {
+        long capacity = log->capacity ? log->capacity * 2 : 4096;
+        double* samples = realloc(log->samples, capacity * sizeof(double));
+        if (!samples)
+        {
+            perror("Error allocating latency log");
+            exit(EXIT_FAILURE);
+        }
+        log->samples = samples;
+        log->capacity = capacity;
+    }
+    log->samples[log->count++] = micros;
+}
+
+// Orders latency samples ascending
+static int compareLatencies(const void* a, const void* b)
+{
+    double first = *(const double*)a;
+    double second = *(const double*)b;
+    return (first > second) - (first < second);
+}
+
+// Returns a percentile of sorted samples (nearest rank)
+static double percentile(const LatencyLog* log, double fraction)
+{
+    long rank = (long)(fraction * log->count + 0.999999);
+    rank = rank < 1 ? 1 : (rank > log->count ? log->count : rank);
+    return log->samples[rank - 1];
+}
+
+// --------------------
+// Scripted Games
+// --------------------
+
+// Appends a step to a script
+static void addStep(Script* script, RequestKind kind, const char* arguments, int expectedScore)
+{
+    if (script->numSteps == MAX_SCRIPT_STEPS)
+    {
+        return;
+    }
+    Step* step = &script->steps[script->numSteps++];
+    step->kind = kind;
+    snprintf(step->arguments, sizeof(step->arguments), "%s", arguments);
+    step->expectedScore = expectedScore;
+}
+
+// Plays a game locally with the best scoring move each turn and records the requests a client would send;
+// a seeded share of the turns reroll instead. The server deals from the same seed with the same engine,
+// so the replayed moves stay legal there
+static void buildScript(void* arg)
+{
+    Script* script = arg;
+    Game* game = malloc(sizeof(Game));
+    if (!game)
+    {
+        perror("Error allocating script game");
+        exit(EXIT_FAILURE);
+    }
+    initGame(game, script->lexicon, script->seed);
+    script->numSteps = 0;
+    MoveList openers;
+    initMoveList(&openers);
+    unsigned long long rng = script->seed;
+
+    for (int turn = 0; turn < script->turns && !game->gameOver; turn++)
+    {
+        addStep(script, Request_State, "", 0);
+
+        const Player* player = (game->turn == Player1) ? &game->player1 : &game->player2;
+        Move move;
+        bool found;
+        if (nextSplitMix(&rng) % 100 < (unsigned long long)script->rerollRate)
+        {
+            found = false;
+        }
+        else if (findOpeningMoves(script->openings, game, player->letters, &openers))
+        {
+            found = openers.count > 0;
+            if (found)
+            {
+                move = openers.moves[0];
+            }
+        }
+        else
+        {
+            found = findBestMove(game, player->letters, &move, NULL, NULL);
+        }
+        if (!found)
+        {
+            addStep(script, Request_Reroll, "", 0);
+            rerollPlayerLetters(game);
+            continue;
+        }
+
+        char arguments[MAX_REQUEST_LENGTH - 16];
+        int length = 0;
+        for (int i = 0; i < move.numLetters; i++)
+        {
+            length += snprintf(arguments + length, sizeof(arguments) - length, "%s%d,%d,%c", i ? " " : "",
+                               move.squares[i].x, move.squares[i].y, letterSymbol(move.letters[i]));
+        }
+        int score = playMove(game, move.squares, move.letters, move.numLetters);
+        addStep(script, Request_Play, arguments, score);
+        if (isGameOver(game))
+        {
+            game->gameOver = true;
+        }
+    }
+
+    // Both players ask to end, then the table is closed
+    addStep(script, Request_State, "", 0);
+    addStep(script, Request_End, "", 0);
+    addStep(script, Request_End, "", 0);
+    addStep(script, Request_Close, "", 0);
+
+    freeMoveList(&openers);
+    freeGame(game);
+    free(game);
+}
+
+// --------------------
+// Sessions
+// --------------------
+
+// Connects a blocking socket to the server, then makes it non-blocking
+static int connectToServer(const char* socketPath, int port)
+{
+    int fd;
+    int result;
+    if (port != 0)
+    {
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_in address = {0};
+        address.sin_family = AF_INET;
+        address.sin_port = htons((unsigned short)port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        result = connect(fd, (struct sockaddr*)&address, sizeof(address));
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    }
+    else
+    {
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_un address = {0};
+        address.sun_family = AF_UNIX;
+        snprintf(address.sun_path, sizeof(address.sun_path), "%s", socketPath);
+        result = connect(fd, (struct sockaddr*)&address, sizeof(address));
+    }
+
+    if (fd < 0 || result < 0)
+    {
+        perror("Error connecting to the server");
+        exit(EXIT_FAILURE);
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+// Sends the session's next request
+static void sendNextRequest(Session* session)
+{
+    char line[MAX_REQUEST_LENGTH + 32];
+    int length;
+
+    if (session->step < 0)
+    {
+        session->pending = Request_New;
+        length = snprintf(line, sizeof(line), "NEW %llu\n", session->script->seed);
+    }
+    else
+    {
+        const Step* step = &session->script->steps[session->step];
+        session->pending = step->kind;
+        length = snprintf(line, sizeof(line), "%s %d%s%s\n", requestName(step->kind), session->tableId,
+                          step->arguments[0] ? " " : "", step->arguments);
+    }
+
+    session->sentAt = nowMicros();
+    if (send(session->fd, line, length, MSG_NOSIGNAL) != length)
+    {
+        perror("Error sending request");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Checks one reply against the script and moves the session to its next request
+static bool handleReply(Session* session, const char* reply, RunTotals* totals)
+{
+    logLatency(&totals->latencies[session->pending], nowMicros() - session->sentAt);
+
+    if (strncmp(reply, "OK", 2) != 0)
+    {
+        totals->errors++;
+    }
+
+    if (session->pending == Request_New)
+    {
+        session->tableId = atoi(reply + 2);
+        session->step = 0;
+        sendNextRequest(session);
+        return true;
+    }
+
+    const Step* step = &session->script->steps[session->step];
+    if (step->kind == Request_Play && strncmp(reply, "OK", 2) == 0 && atoi(reply + 2) != step->expectedScore)
+    {
+        totals->mismatches++;
+    }
+
+    session->step++;
+    if (session->step == session->script->numSteps)
+    {
+        // The table was closed; play the script again on a new table if asked to
+        if (--session->loopsLeft == 0)
+        {
+            return false;
+        }
+        session->step = -1;
+    }
+    sendNextRequest(session);
+    return true;
+}
+
+// Reads the replies waiting on a session's socket
+static void readReplies(Session* session, RunTotals* totals)
+{
+    ssize_t received = recv(session->fd, session->replies + session->repliesLength,
+                            REPLY_BUFFER_SIZE - session->repliesLength - 1, 0);
+    if (received <= 0)
+    {
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        {
+            return;
+        }
+        fprintf(stderr, "The server closed a session\n");
+        exit(EXIT_FAILURE);
+    }
+    session->repliesLength += (int)received;
+    session->replies[session->repliesLength] = '\0';
+
+    // Each request waits for its reply, so there is at most one complete line
+    char* newline = strchr(session->replies, '\n');
+    if (newline == NULL)
+    {
+        return;
+    }
+    *newline = '\0';
+    session->repliesLength = 0;
+
+    if (!handleReply(session, session->replies, totals))
+    {
+        close(session->fd);
+        session->fd = -1;
+        totals->activeSessions--;
+    }
+}
+
+// --------------------
+// Main Function
+// --------------------
+
+// Prints how to run the load generator
+static void printUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [--socket PATH | --port PORT] [--sessions N] [--games N] [--turns N] [--loops N]\n"
+            "          [--seed N] [--reroll-rate N] [--dict FILE] [--openings FILE] [--layout FILE]\n"
+            "  --sessions N  simulated clients, one connection and table each (default 1000)\n"
+            "  --games N     distinct games replayed by the sessions (default 64)\n"
+            "  --turns N     turns played in each game (default 20, at most %d)\n"
+            "  --loops N     times each session replays its game (default 1)\n"
+            "  --seed N      seed of the first game; game k is dealt from seed + k (default 1)\n"
+            "  --reroll-rate N  percent of turns that reroll the rack instead of playing (default %d)\n"
+            "  --openings F  opening table answering the scripts' first turns (see scrabble_openings)\n"
+            "  --layout F    premium squares of the board, the server's layout, to score the scripts\n",
+            program, MAX_SCRIPT_TURNS, DEFAULT_REROLL_RATE);
+}
+
+// Entry point of the load generator
+int main(int argc, char** argv)
+{
+    const char* socketPath = "scrabble.sock";
+    const char* dictionary = "palabras.txt";
+    const char* openingFile = NULL;
+    int port = 0;
+    int numSessions = 1000;
+    int numGames = 64;
+    int turns = 20;
+    int loops = 1;
+    int rerollRate = DEFAULT_REROLL_RATE;
+    unsigned long long seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--socket") == 0 && hasValue)
+        {
+            socketPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--port") == 0 && hasValue)
+        {
+            port = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--sessions") == 0 && hasValue)
+        {
+            numSessions = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--games") == 0 && hasValue)
+        {
+            numGames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--turns") == 0 && hasValue)
+        {
+            turns = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--loops") == 0 && hasValue)
+        {
+            loops = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--reroll-rate") == 0 && hasValue)
+        {
+            rerollRate = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--dict") == 0 && hasValue)
+        {
+            dictionary = argv[++i];
+        }
+        else if (strcmp(argv[i], "--layout") == 0 && hasValue)
+        {
+            if (!loadBoardLayout(argv[++i]))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--openings") == 0 && hasValue)
+        {
+            openingFile = argv[++i];
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (numSessions < 1 || numGames < 1 || turns < 1 || loops < 1 || rerollRate < 0 || rerollRate > 100)
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (turns > MAX_SCRIPT_TURNS)
+    {
+        fprintf(stderr, "--turns %d does not fit a script; at most %d turns are scripted\n", turns, MAX_SCRIPT_TURNS);
+        return EXIT_FAILURE;
+    }
+
+    // --------------------
+    // Script Generation
+    // --------------------
+
+    // Self-play the games on every core; the scripts only depend on the seed
+    Lexicon* lexicon = loadValidWords(dictionary);
+    OpeningTable* openings = openingFile ? mapOpeningTable(openingFile, lexicon) : NULL;
+    if (openingFile && !openings)
+    {
+        fprintf(stderr, "Ignoring %s: not an opening table for %s\n", openingFile, dictionary);
+    }
+    Script* scripts = calloc(numGames, sizeof(Script));
+    if (!scripts)
+    {
+        perror("Error allocating scripts");
+        return EXIT_FAILURE;
+    }
+    double scriptStart = nowMicros();
+    ThreadPool pool;
+    startThreadPool(&pool, 0);
+    for (int g = 0; g < numGames; g++)
+    {
+        scripts[g].seed = seed + g;
+        scripts[g].turns = turns;
+        scripts[g].rerollRate = rerollRate;
+        scripts[g].lexicon = lexicon;
+        scripts[g].openings = openings;
+        submitTask(&pool, buildScript, &scripts[g]);
+    }
+    waitForTasks(&pool);
+    stopThreadPool(&pool);
+    printf("Scripted %d games in %.2f s\n", numGames, (nowMicros() - scriptStart) / 1e6);
+
+    // --------------------
+    // Load Run
+    // --------------------
+
+    // Every session holds a socket open; raise the descriptor limit as far as allowed
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    Session* sessions = calloc(numSessions, sizeof(Session));
+    RunTotals totals = {0};
+    if (epollFd < 0 || !sessions)
+    {
+        perror("Error preparing sessions");
+        return EXIT_FAILURE;
+    }
+    for (int s = 0; s < numSessions; s++)
+    {
+        Session* session = &sessions[s];
+        session->fd = connectToServer(socketPath, port);
+        session->script = &scripts[s % numGames];
+        session->step = -1;
+        session->loopsLeft = loops;
+        struct epoll_event event = {.events = EPOLLIN, .data.ptr = session};
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, session->fd, &event);
+    }
+
+    // Every session keeps exactly one request in flight until its script ends
+    double runStart = nowMicros();
+    totals.activeSessions = numSessions;
+    for (int s = 0; s < numSessions; s++)
+    {
+        sendNextRequest(&sessions[s]);
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+    while (totals.activeSessions > 0)
+    {
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (ready < 0 && errno != EINTR)
+        {
+            perror("Error waiting for replies");
+            return EXIT_FAILURE;
+        }
+        for (int i = 0; i < ready; i++)
+        {
+            readReplies(events[i].data.ptr, &totals);
+        }
+    }
+    double seconds = (nowMicros() - runStart) / 1e6;
+
+    // --------------------
+    // Report
+    // --------------------
+    long requests = 0;
+    for (int kind = 0; kind < Request_Count; kind++)
+    {
+        requests += totals.latencies[kind].count;
+    }
+    printf("%d sessions sent %ld requests in %.2f s (%.0f per second), %ld errors, %ld score mismatches\n",
+           numSessions, requests, seconds, requests / seconds, totals.errors, totals.mismatches);
+    printf("%-8s %10s %10s %10s %10s %10s   (microseconds)\n", "request", "count", "p50", "p99", "p999", "max");
+    for (int kind = 0; kind < Request_Count; kind++)
+    {
+        LatencyLog* log = &totals.latencies[kind];
+        if (log->count == 0)
+        {
+            continue;
+        }
+        qsort(log->samples, log->count, sizeof(double), compareLatencies);
+        printf("%-8s %10ld %10.1f %10.1f %10.1f %10.1f\n", requestName((RequestKind)kind), log->count,
+               percentile(log, 0.50), percentile(log, 0.99), percentile(log, 0.999), log->samples[log->count - 1]);
+        free(log->samples);
+    }
+
+    close(epollFd);
+    free(sessions);
+    free(scripts);
+    freeOpeningTable(openings);
+    freeLexicon(lexicon);
+
+    return (totals.errors == 0 && totals.mismatches == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
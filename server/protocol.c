@@ -0,0 +1,255 @@
+// protocol.c
+
+#include "protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char* requestNames[Request_Count] = {
+    "NEW",
+    "PLAY",
+    "REROLL",
+    "END",
+    "STATE",
+    "CLOSE",
+    "UNKNOWN",
+};
+
+// --------------------
+// Parsing Helpers
+// --------------------
+
+// Parses a table id field; returns 0 if it is not a positive number
+static int parseTableId(const char* field)
+{
+    if (field == NULL)
+    {
+        return 0;
+    }
+    char* end;
+    long id = strtol(field, &end, 10);
+    return (*end == '\0' && id > 0 && id <= 0x7fffffff) ? (int)id : 0;
+}
+
+// Parses a "x,y,letter" tile field; the letter is any text parseLetter reads as one tile
+static bool parseTile(const char* field, Coordinate* square, char* letter)
+{
+    int x, y, used = 0;
+    if (sscanf(field, "%d,%d,%n", &x, &y, &used) != 2 || used == 0)
+    {
+        return false;
+    }
+    const char* text = field + used;
+    *letter = parseLetter(&text);
+    if (*letter == 0 || *text != '\0')
+    {
+        return false;
+    }
+    square->x = x;
+    square->y = y;
+    return true;
+}
+
+// Picks a seed for a table created without one; tables created in the same second still differ
+static unsigned long long unseededSeed(void)
+{
+    static unsigned long long created = 0;
+    return ((unsigned long long)time(NULL) << 20) + __atomic_fetch_add(&created, 1, __ATOMIC_RELAXED);
+}
+
+// --------------------
+// Request Handlers
+// --------------------
+
+// Writes the STATE reply of a game
+static void describeGame(const Game* game, char* reply, size_t replySize)
+{
+    const Player* player = (game->turn == Player1) ? &game->player1 : &game->player2;
+    char rack[MAX_LETTERS + 1];
+    char board[LENGTH * LENGTH + 1];
+
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        rack[i] = player->letters[i] != '\0' ? letterSymbol(player->letters[i]) : '.';
+    }
+    rack[MAX_LETTERS] = '\0';
+    for (int y = 0; y < LENGTH; y++)
+    {
+        for (int x = 0; x < LENGTH; x++)
+        {
+            const Piece* square = &game->board[y][x];
+            char tile = (char)(square->letter | (square->is_blank ? BLANK_TILE : 0));
+            board[y * LENGTH + x] = square->is_placed ? letterSymbol(tile) : '.';
+        }
+    }
+    board[LENGTH * LENGTH] = '\0';
+
+    snprintf(reply, replySize, "OK %d %d %d %d %d %s %s\n", game->turn == Player1 ? 1 : 2,
+             game->player1.score, game->player2.score, game->bag.remaining, game->gameOver ? 1 : 0, rack, board);
+}
+
+// Plays the tiles listed in the remaining fields of a PLAY request; returns true if they were played
+static bool playTiles(Game* game, char** savePointer, char* reply, size_t replySize)
+{
+    Coordinate squares[MAX_LETTERS];
+    char letters[MAX_LETTERS];
+    int numLetters = 0;
+
+    for (char* field = strtok_r(NULL, " ", savePointer); field != NULL; field = strtok_r(NULL, " ", savePointer))
+    {
+        if (numLetters == MAX_LETTERS || !parseTile(field, &squares[numLetters], &letters[numLetters]))
+        {
+            snprintf(reply, replySize, "ERR syntax\n");
+            return false;
+        }
+        numLetters++;
+    }
+
+    if (game->gameOver)
+    {
+        snprintf(reply, replySize, "ERR over\n");
+        return false;
+    }
+
+    int score = playMove(game, squares, letters, numLetters);
+    if (score < 0)
+    {
+        snprintf(reply, replySize, "ERR invalid\n");
+        return false;
+    }
+
+    // The game ends once every tile has been played
+    if (isGameOver(game))
+    {
+        game->gameOver = true;
+    }
+    snprintf(reply, replySize, "OK %d\n", score);
+    return true;
+}
+
+// Runs a request that addresses an existing table
+static void handleTableRequest(TableRegistry* tables, RequestKind kind, char** savePointer,
+                               char* reply, size_t replySize)
+{
+    int id = parseTableId(strtok_r(NULL, " ", savePointer));
+    if (id == 0)
+    {
+        snprintf(reply, replySize, "ERR syntax\n");
+        return;
+    }
+
+    if (kind == Request_Close)
+    {
+        snprintf(reply, replySize, closeTable(tables, id) ? "OK\n" : "ERR table\n");
+        return;
+    }
+
+    Table* table = acquireTable(tables, id);
+    if (table == NULL)
+    {
+        snprintf(reply, replySize, "ERR table\n");
+        return;
+    }
+
+    Game* game = &table->game;
+    bool changed = false;
+    switch (kind)
+    {
+    case Request_Play:
+        changed = playTiles(game, savePointer, reply, replySize);
+        break;
+    case Request_Reroll:
+        if (game->gameOver)
+        {
+            snprintf(reply, replySize, "ERR over\n");
+        }
+        else
+        {
+            rerollPlayerLetters(game);
+            snprintf(reply, replySize, "OK\n");
+            changed = true;
+        }
+        break;
+    case Request_End:
+        if (!game->gameOver)
+        {
+            requestEndGame(game);
+            changed = true;
+        }
+        snprintf(reply, replySize, "OK %d\n", game->gameOver ? 1 : 0);
+        break;
+    case Request_State:
+    default:
+        describeGame(game, reply, replySize);
+        break;
+    }
+
+    // Every change is saved before the reply goes out, so a restart resumes from the last move
+    if (changed)
+    {
+        checkpointTable(tables, table);
+    }
+    releaseTable(tables, table);
+}
+
+// --------------------
+// Protocol Functions
+// --------------------
+
+// Runs one request line (without its newline) and writes the reply line, newline included
+RequestKind handleRequest(TableRegistry* tables, const char* line, char* reply, size_t replySize)
+{
+    char buffer[MAX_REQUEST_LENGTH];
+    if (strlen(line) >= sizeof(buffer))
+    {
+        snprintf(reply, replySize, "ERR syntax\n");
+        return Request_Unknown;
+    }
+    strcpy(buffer, line);
+
+    char* savePointer;
+    char* keyword = strtok_r(buffer, " ", &savePointer);
+    RequestKind kind = Request_Unknown;
+    for (int k = 0; k < Request_Unknown && keyword != NULL; k++)
+    {
+        if (strcmp(keyword, requestNames[k]) == 0)
+        {
+            kind = (RequestKind)k;
+            break;
+        }
+    }
+
+    switch (kind)
+    {
+    case Request_New:
+    {
+        // Without a seed the game is dealt from the clock, like the GUI does; a seed makes the deal reproducible
+        char* seedField = strtok_r(NULL, " ", &savePointer);
+        char* end = NULL;
+        unsigned long long seed = seedField ? strtoull(seedField, &end, 10) : unseededSeed();
+        if (seedField != NULL && *end != '\0')
+        {
+            snprintf(reply, replySize, "ERR syntax\n");
+            break;
+        }
+        int id = createTable(tables, seed);
+        snprintf(reply, replySize, "OK %d\n", id);
+        break;
+    }
+    case Request_Unknown:
+        snprintf(reply, replySize, "ERR syntax\n");
+        break;
+    default:
+        handleTableRequest(tables, kind, &savePointer, reply, replySize);
+        break;
+    }
+
+    return kind;
+}
+
+// Returns the protocol keyword of an operation
+const char* requestName(RequestKind kind)
+{
+    return requestNames[kind];
+}
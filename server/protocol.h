@@ -0,0 +1,63 @@
+// protocol.h
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "tables.h"
+#include <stddef.h>
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Longest request line accepted, newline included
+#define MAX_REQUEST_LENGTH 256
+
+// Longest reply line produced, newline included: a STATE reply is mostly its board
+#define MAX_REPLY_LENGTH (LENGTH * LENGTH + 95)
+
+// Requests are one line of space separated fields; every request gets exactly one reply line,
+// in order. Squares are 0-based columns (x) and rows (y).
+//
+//   NEW [seed]                        -> OK <table>
+//   PLAY <table> <x>,<y>,<letter> ... -> OK <score>
+//   REROLL <table>                    -> OK
+//   END <table>                       -> OK <0|1>   (1 once the game is over)
+//   STATE <table>                     -> OK <turn> <score1> <score2> <bag> <over> <rack> <board>
+//   CLOSE <table>                     -> OK
+//
+// <letter> is one tile: a letter, "CH", "LL", "RR" or "Ñ" (UTF-8), or the tile's symbol; lowercase
+// plays a blank as that letter. <turn> is 1 or 2, <rack> has MAX_LETTERS characters and <board>
+// LENGTH * LENGTH characters, row by row, with '.' for empty places. Both write each tile as its
+// one-character symbol: its letter, or 1 for CH, 2 for LL, 3 for RR and 4 for Ñ; a laid blank is the
+// lowercase letter or 5 to 8, and a blank on the rack is '?'. Failures reply ERR followed by one of:
+// syntax (malformed request), table (no such table), over (the game ended) or invalid (illegal move).
+
+// --------------------
+// Enumerations
+// --------------------
+
+// Represents the operation a request asked for
+typedef enum
+{
+    Request_New,
+    Request_Play,
+    Request_Reroll,
+    Request_End,
+    Request_State,
+    Request_Close,
+    Request_Unknown,
+    Request_Count,
+} RequestKind;
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Runs one request line (without its newline) and writes the reply line, newline included
+RequestKind handleRequest(TableRegistry* tables, const char* line, char* reply, size_t replySize);
+
+// Returns the protocol keyword of an operation
+const char* requestName(RequestKind kind);
+
+#endif // PROTOCOL_H
@@ -0,0 +1,632 @@
+// server.c
+
+#define _GNU_SOURCE // accept4
+
+#include "scrabble.h"
+#include "threadpool.h"
+#include "wordlist.h"
+#include "tables.h"
+#include "protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Bytes of unread requests kept per connection
+#define INPUT_BUFFER_SIZE 4096
+
+// Events handled per call to epoll_wait
+#define MAX_EVENTS 256
+
+// Default path of the listening socket
+#define DEFAULT_SOCKET_PATH "scrabble.sock"
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents a client connection. Requests of one connection run one at a time so replies keep their order;
+// requests of different connections run in parallel on the worker pool
+typedef struct Connection
+{
+    int fd;
+    unsigned int events;                      // Events the connection is registered for
+
+    char input[INPUT_BUFFER_SIZE];            // Bytes read and not yet taken as requests
+    int inputLength;
+
+    char request[MAX_REQUEST_LENGTH];         // Request being run by a worker
+    char reply[MAX_REPLY_LENGTH];             // Reply of that request, then the part not sent yet
+    int replyLength;
+    int replySent;
+    RequestKind kind;
+
+    bool busy;                                // A worker is running the request
+    bool closing;                             // The client left; freed when the worker finishes
+
+    struct Connection* prev;                  // Neighbours in the list of live connections
+    struct Connection* next;
+    struct Connection* nextDone;              // Next connection in the list of finished or retired requests
+} Connection;
+
+// Represents the server state owned by the event loop thread
+typedef struct
+{
+    int epollFd;
+    int listenFd;
+    int wakeFd;                               // Eventfd the workers write when a request finishes
+    ThreadPool pool;
+    TableRegistry tables;
+    Connection* connections;                  // Live connections
+
+    pthread_mutex_t doneMutex;                // Protects the list of finished requests
+    Connection* done;
+    Connection* retired;                      // Closed connections, freed once the current batch of events is handled
+
+    unsigned long served[Request_Count];      // Replies sent per operation
+} Server;
+
+// Markers stored in the epoll data of the two descriptors that are not connections
+static int listenMarker;
+static int wakeMarker;
+
+// Set by SIGINT and SIGTERM
+static volatile sig_atomic_t stopRequested = 0;
+
+// The server, reached by the worker tasks
+static Server server;
+
+// --------------------
+// Worker Tasks
+// --------------------
+
+// Runs the connection's request on a worker thread and hands it back to the event loop
+static void runRequest(void* arg)
+{
+    Connection* connection = arg;
+    connection->kind = handleRequest(&server.tables, connection->request, connection->reply, sizeof(connection->reply));
+    connection->replyLength = strlen(connection->reply);
+
+    pthread_mutex_lock(&server.doneMutex);
+    connection->nextDone = server.done;
+    server.done = connection;
+    pthread_mutex_unlock(&server.doneMutex);
+
+    unsigned long long one = 1;
+    if (write(server.wakeFd, &one, sizeof(one)) < 0)
+    {
+        perror("Error waking the event loop");
+    }
+}
+
+// --------------------
+// Connection Functions
+// --------------------
+
+// Registers the events the connection is waiting for: input while there is room, output while a reply is pending
+static void updateInterest(Connection* connection)
+{
+    unsigned int events = 0;
+    if (connection->inputLength < INPUT_BUFFER_SIZE)
+    {
+        events |= EPOLLIN;
+    }
+    if (!connection->busy && connection->replySent < connection->replyLength)
+    {
+        events |= EPOLLOUT;
+    }
+    if (events != connection->events)
+    {
+        struct epoll_event event = {.events = events, .data.ptr = connection};
+        epoll_ctl(server.epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+        connection->events = events;
+    }
+}
+
+// Queues a closed connection to be freed; events already returned by epoll may still point to it
+static void retireConnection(Connection* connection)
+{
+    connection->nextDone = server.retired;
+    server.retired = connection;
+}
+
+// Frees the connections retired while handling the last batch of events
+static void freeRetiredConnections(void)
+{
+    while (server.retired != NULL)
+    {
+        Connection* connection = server.retired;
+        server.retired = connection->nextDone;
+        free(connection);
+    }
+}
+
+// Closes the socket and retires the connection, or leaves that to the request still running
+static void closeConnection(Connection* connection)
+{
+    if (connection->fd >= 0)
+    {
+        close(connection->fd);
+        connection->fd = -1;
+    }
+    if (connection->prev != NULL)
+    {
+        connection->prev->next = connection->next;
+    }
+    else if (server.connections == connection)
+    {
+        server.connections = connection->next;
+    }
+    if (connection->next != NULL)
+    {
+        connection->next->prev = connection->prev;
+    }
+    connection->prev = connection->next = NULL;
+
+    if (connection->busy)
+    {
+        connection->closing = true;
+    }
+    else
+    {
+        retireConnection(connection);
+    }
+}
+
+// Sends as much of the pending reply as the socket takes; returns false if the connection failed
+static bool flushReply(Connection* connection)
+{
+    while (connection->replySent < connection->replyLength)
+    {
+        ssize_t sent = send(connection->fd, connection->reply + connection->replySent,
+                            connection->replyLength - connection->replySent, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        connection->replySent += (int)sent;
+    }
+    return true;
+}
+
+// Hands the next complete request line to the pool, if the connection is free to run one
+static void dispatchRequest(Connection* connection)
+{
+    if (connection->busy || connection->replySent < connection->replyLength)
+    {
+        return;
+    }
+
+    char* newline = memchr(connection->input, '\n', connection->inputLength);
+    if (newline == NULL)
+    {
+        return;
+    }
+
+    // Take the line out of the input buffer, dropping the newline and a carriage return before it
+    int lineLength = (int)(newline - connection->input);
+    int consumed = lineLength + 1;
+    if (lineLength > 0 && connection->input[lineLength - 1] == '\r')
+    {
+        lineLength--;
+    }
+    if (lineLength >= MAX_REQUEST_LENGTH)
+    {
+        lineLength = 0; // An empty request is answered as malformed
+    }
+    memcpy(connection->request, connection->input, lineLength);
+    connection->request[lineLength] = '\0';
+    memmove(connection->input, connection->input + consumed, connection->inputLength - consumed);
+    connection->inputLength -= consumed;
+
+    connection->busy = true;
+    submitTask(&server.pool, runRequest, connection);
+}
+
+// Reads what the client sent and starts its next request
+static void handleReadable(Connection* connection)
+{
+    ssize_t received = recv(connection->fd, connection->input + connection->inputLength,
+                            INPUT_BUFFER_SIZE - connection->inputLength, 0);
+    if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+    {
+        closeConnection(connection);
+        return;
+    }
+    if (received > 0)
+    {
+        connection->inputLength += (int)received;
+    }
+
+    // A full buffer without a newline can never become a valid request
+    if (connection->inputLength == INPUT_BUFFER_SIZE && memchr(connection->input, '\n', INPUT_BUFFER_SIZE) == NULL)
+    {
+        closeConnection(connection);
+        return;
+    }
+
+    dispatchRequest(connection);
+    updateInterest(connection);
+}
+
+// Sends the rest of a reply the socket could not take at once
+static void handleWritable(Connection* connection)
+{
+    if (!flushReply(connection))
+    {
+        closeConnection(connection);
+        return;
+    }
+    dispatchRequest(connection);
+    updateInterest(connection);
+}
+
+// Sends the replies of the requests the workers finished
+static void collectFinishedRequests(void)
+{
+    unsigned long long count;
+    if (read(server.wakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+    {
+        perror("Error reading the wake descriptor");
+    }
+
+    pthread_mutex_lock(&server.doneMutex);
+    Connection* finished = server.done;
+    server.done = NULL;
+    pthread_mutex_unlock(&server.doneMutex);
+
+    while (finished != NULL)
+    {
+        Connection* connection = finished;
+        finished = connection->nextDone;
+        connection->busy = false;
+        server.served[connection->kind]++;
+
+        if (connection->closing)
+        {
+            retireConnection(connection);
+            continue;
+        }
+
+        connection->replySent = 0;
+        if (!flushReply(connection))
+        {
+            closeConnection(connection);
+            continue;
+        }
+        dispatchRequest(connection);
+        updateInterest(connection);
+    }
+}
+
+// Accepts every pending client
+static void acceptClients(bool tcp)
+{
+    while (true)
+    {
+        int fd = accept4(server.listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                perror("Error accepting client");
+            }
+            return;
+        }
+
+        if (tcp)
+        {
+            // Replies are single short lines; do not hold them back waiting for more data
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        }
+
+        Connection* connection = calloc(1, sizeof(Connection));
+        if (!connection)
+        {
+            perror("Error allocating connection");
+            exit(EXIT_FAILURE);
+        }
+        connection->fd = fd;
+        connection->events = EPOLLIN;
+        connection->next = server.connections;
+        if (server.connections != NULL)
+        {
+            server.connections->prev = connection;
+        }
+        server.connections = connection;
+
+        struct epoll_event event = {.events = EPOLLIN, .data.ptr = connection};
+        if (epoll_ctl(server.epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+        {
+            perror("Error watching client");
+            closeConnection(connection);
+        }
+    }
+}
+
+// --------------------
+// Server Setup
+// --------------------
+
+// Stops the event loop on SIGINT and SIGTERM
+static void handleStopSignal(int signal)
+{
+    (void)signal;
+    stopRequested = 1;
+}
+
+// Opens the listening socket on a Unix socket path, or on a localhost TCP port when port is not 0
+static int openListener(const char* socketPath, int port)
+{
+    int fd;
+    if (port != 0)
+    {
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        struct sockaddr_in address = {0};
+        address.sin_family = AF_INET;
+        address.sin_port = htons((unsigned short)port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd < 0 || bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+        {
+            perror("Error binding TCP port");
+            exit(EXIT_FAILURE);
+        }
+    }
+    else
+    {
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        struct sockaddr_un address = {0};
+        address.sun_family = AF_UNIX;
+        if (strlen(socketPath) >= sizeof(address.sun_path))
+        {
+            fprintf(stderr, "Socket path too long: %s\n", socketPath);
+            exit(EXIT_FAILURE);
+        }
+        strcpy(address.sun_path, socketPath);
+        unlink(socketPath);
+        if (fd < 0 || bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+        {
+            perror("Error binding Unix socket");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (listen(fd, SOMAXCONN) < 0)
+    {
+        perror("Error listening for clients");
+        exit(EXIT_FAILURE);
+    }
+    return fd;
+}
+
+// Prints how to run the server
+static void printUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [--socket PATH | --port PORT] [--threads N] [--dict FILE] [--hash FILE] [--checkpoint DIR]\n"
+            "          [--layout FILE]\n"
+            "  --socket PATH  listen on a Unix socket (default " DEFAULT_SOCKET_PATH ")\n"
+            "  --port PORT    listen on 127.0.0.1:PORT instead\n"
+            "  --threads N    worker threads validating requests (default: one per core)\n"
+            "  --dict FILE    word list (default palabras.txt)\n"
+            "  --hash FILE    validate words with a perfect hash mapped from FILE, built there if missing or stale\n"
+            "  --checkpoint DIR  save every table after each move and reopen the tables saved there\n"
+            "  --layout FILE  premium squares of the board (see scrabble.h), the standard ones by default;\n"
+            "                 required on 21 x 21 builds\n",
+            program);
+}
+
+// --------------------
+// Main Function
+// --------------------
+
+// Entry point of the headless game server
+int main(int argc, char** argv)
+{
+    const char* socketPath = DEFAULT_SOCKET_PATH;
+    const char* dictionary = "palabras.txt";
+    const char* checkpointDirectory = NULL;
+    const char* hashFile = NULL;
+    int port = 0;
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--socket") == 0 && hasValue)
+        {
+            socketPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--port") == 0 && hasValue)
+        {
+            port = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+        {
+            threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--dict") == 0 && hasValue)
+        {
+            dictionary = argv[++i];
+        }
+        else if (strcmp(argv[i], "--layout") == 0 && hasValue)
+        {
+            if (!loadBoardLayout(argv[++i]))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--hash") == 0 && hasValue)
+        {
+            hashFile = argv[++i];
+        }
+        else if (strcmp(argv[i], "--checkpoint") == 0 && hasValue)
+        {
+            checkpointDirectory = argv[++i];
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Load the dictionary once; every table validates against it
+    Lexicon* lexicon = loadHashedLexicon(dictionary, hashFile, 0);
+    initRegistry(&server.tables, lexicon);
+    if (checkpointDirectory != NULL)
+    {
+        printf("Restored %d tables from %s\n", restoreTables(&server.tables, checkpointDirectory), checkpointDirectory);
+    }
+    pthread_mutex_init(&server.doneMutex, NULL);
+    startThreadPool(&server.pool, threads);
+
+    server.listenFd = openListener(socketPath, port);
+    server.wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    server.epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (server.wakeFd < 0 || server.epollFd < 0)
+    {
+        perror("Error creating event loop");
+        return EXIT_FAILURE;
+    }
+    struct epoll_event listenEvent = {.events = EPOLLIN, .data.ptr = &listenMarker};
+    struct epoll_event wakeEvent = {.events = EPOLLIN, .data.ptr = &wakeMarker};
+    epoll_ctl(server.epollFd, EPOLL_CTL_ADD, server.listenFd, &listenEvent);
+    epoll_ctl(server.epollFd, EPOLL_CTL_ADD, server.wakeFd, &wakeEvent);
+
+    struct sigaction stopAction = {0};
+    stopAction.sa_handler = handleStopSignal;
+    sigaction(SIGINT, &stopAction, NULL);
+    sigaction(SIGTERM, &stopAction, NULL);
+
+    if (port != 0)
+    {
+        printf("Listening on 127.0.0.1:%d with %d workers\n", port, server.pool.numThreads);
+    }
+    else
+    {
+        printf("Listening on %s with %d workers\n", socketPath, server.pool.numThreads);
+    }
+    fflush(stdout);
+
+    // --------------------
+    // Event Loop
+    // --------------------
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    struct epoll_event events[MAX_EVENTS];
+    while (!stopRequested)
+    {
+        int ready = epoll_wait(server.epollFd, events, MAX_EVENTS, -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("Error waiting for events");
+            break;
+        }
+
+        for (int i = 0; i < ready; i++)
+        {
+            void* source = events[i].data.ptr;
+            if (source == &listenMarker)
+            {
+                acceptClients(port != 0);
+            }
+            else if (source == &wakeMarker)
+            {
+                collectFinishedRequests();
+            }
+            else
+            {
+                Connection* connection = source;
+                if (connection->fd < 0)
+                {
+                    continue; // Closed earlier in this batch
+                }
+                if (events[i].events & (EPOLLERR | EPOLLHUP) && !(events[i].events & EPOLLIN))
+                {
+                    closeConnection(connection);
+                }
+                else if (events[i].events & EPOLLIN)
+                {
+                    handleReadable(connection);
+                }
+                else if (events[i].events & EPOLLOUT)
+                {
+                    handleWritable(connection);
+                }
+            }
+        }
+        freeRetiredConnections();
+    }
+
+    // --------------------
+    // Cleanup and Resource Management
+    // --------------------
+    struct timespec stopped;
+    clock_gettime(CLOCK_MONOTONIC, &stopped);
+    double seconds = (stopped.tv_sec - started.tv_sec) + (stopped.tv_nsec - started.tv_nsec) / 1e9;
+
+    // Let the running requests finish before tearing anything down
+    stopThreadPool(&server.pool);
+    while (server.connections != NULL)
+    {
+        closeConnection(server.connections);
+    }
+    for (Connection* connection = server.done; connection != NULL;)
+    {
+        Connection* next = connection->nextDone;
+        server.served[connection->kind]++;
+        free(connection);
+        connection = next;
+    }
+    freeRetiredConnections();
+
+    unsigned long total = 0;
+    for (int kind = 0; kind < Request_Count; kind++)
+    {
+        total += server.served[kind];
+    }
+    printf("Served %lu requests in %.1f s (%.0f per second)\n", total, seconds, seconds > 0 ? total / seconds : 0.0);
+    for (int kind = 0; kind < Request_Count; kind++)
+    {
+        if (server.served[kind] > 0)
+        {
+            printf("  %-7s %lu\n", requestName((RequestKind)kind), server.served[kind]);
+        }
+    }
+
+    close(server.epollFd);
+    close(server.wakeFd);
+    close(server.listenFd);
+    if (port == 0)
+    {
+        unlink(socketPath);
+    }
+    freeRegistry(&server.tables);
+    pthread_mutex_destroy(&server.doneMutex);
+    freeLexicon(lexicon);
+
+    return EXIT_SUCCESS;
+}
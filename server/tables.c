@@ -0,0 +1,238 @@
+// tables.c
+
+#include "tables.h"
+#include "snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <dirent.h>
+
+// --------------------
+// Registry Functions
+// --------------------
+
+// Initializes an empty registry whose games validate words against the given lexicon
+void initRegistry(TableRegistry* registry, const Lexicon* lexicon)
+{
+    pthread_mutex_init(&registry->mutex, NULL);
+    registry->slots = NULL;
+    registry->count = 0;
+    registry->capacity = 0;
+    registry->open = 0;
+    registry->lexicon = lexicon;
+    registry->checkpointDirectory = NULL;
+}
+
+// Releases a table's memory
+static void destroyTable(Table* table)
+{
+    freeGame(&table->game);
+    pthread_mutex_destroy(&table->mutex);
+    free(table);
+}
+
+// Frees every table; no request may be running
+void freeRegistry(TableRegistry* registry)
+{
+    for (int i = 0; i < registry->count; i++)
+    {
+        if (registry->slots[i] != NULL)
+        {
+            destroyTable(registry->slots[i]);
+        }
+    }
+    free(registry->slots);
+    pthread_mutex_destroy(&registry->mutex);
+}
+
+// Allocates a table outside the registry
+static Table* newTable(void)
+{
+    Table* table = malloc(sizeof(Table));
+    if (!table)
+    {
+        perror("Error allocating table");
+        exit(EXIT_FAILURE);
+    }
+    pthread_mutex_init(&table->mutex, NULL);
+    table->refs = 0;
+    table->closed = false;
+    return table;
+}
+
+// Stores a table in its slot, growing the slots to reach the id; the registry lock must be held
+static void insertTable(TableRegistry* registry, Table* table)
+{
+    while (table->id > registry->capacity)
+    {
+        int capacity = registry->capacity ? registry->capacity * 2 : 256;
+        Table** slots = realloc(registry->slots, capacity * sizeof(Table*));
+        if (!slots)
+        {
+            perror("Error allocating table slots");
+            exit(EXIT_FAILURE);
+        }
+        registry->slots = slots;
+        registry->capacity = capacity;
+    }
+    while (registry->count < table->id)
+    {
+        registry->slots[registry->count++] = NULL;
+    }
+    registry->slots[table->id - 1] = table;
+    registry->open++;
+}
+
+// Writes the name of a table's snapshot file
+static void checkpointName(const TableRegistry* registry, int id, char* filename, size_t size)
+{
+    snprintf(filename, size, "%s/table_%d.snap", registry->checkpointDirectory, id);
+}
+
+// Frees a closed table once the last request released it, with its snapshot
+static void discardTable(const TableRegistry* registry, Table* table)
+{
+    if (registry->checkpointDirectory != NULL)
+    {
+        char filename[1024];
+        checkpointName(registry, table->id, filename, sizeof(filename));
+        remove(filename);
+    }
+    destroyTable(table);
+}
+
+// Creates a table with a new game dealt from the given seed and returns its id
+int createTable(TableRegistry* registry, unsigned long long seed)
+{
+    // The game is dealt before taking the lock so other requests are not held up
+    Table* table = newTable();
+    initGame(&table->game, registry->lexicon, seed);
+
+    pthread_mutex_lock(&registry->mutex);
+    table->id = registry->count + 1;
+    insertTable(registry, table);
+    pthread_mutex_unlock(&registry->mutex);
+
+    int id = table->id;
+    if (registry->checkpointDirectory != NULL)
+    {
+        table = acquireTable(registry, id);
+        if (table != NULL)
+        {
+            checkpointTable(registry, table);
+            releaseTable(registry, table);
+        }
+    }
+    return id;
+}
+
+// Finds an open table and locks it for the calling request; returns NULL if there is none
+Table* acquireTable(TableRegistry* registry, int id)
+{
+    pthread_mutex_lock(&registry->mutex);
+    Table* table = (id >= 1 && id <= registry->count) ? registry->slots[id - 1] : NULL;
+    if (table != NULL)
+    {
+        table->refs++;
+    }
+    pthread_mutex_unlock(&registry->mutex);
+
+    if (table != NULL)
+    {
+        pthread_mutex_lock(&table->mutex);
+    }
+    return table;
+}
+
+// Unlocks a table taken with acquireTable
+void releaseTable(TableRegistry* registry, Table* table)
+{
+    pthread_mutex_unlock(&table->mutex);
+
+    pthread_mutex_lock(&registry->mutex);
+    bool destroy = --table->refs == 0 && table->closed;
+    pthread_mutex_unlock(&registry->mutex);
+
+    if (destroy)
+    {
+        discardTable(registry, table);
+    }
+}
+
+// Closes a table; returns false if it does not exist
+bool closeTable(TableRegistry* registry, int id)
+{
+    pthread_mutex_lock(&registry->mutex);
+    Table* table = (id >= 1 && id <= registry->count) ? registry->slots[id - 1] : NULL;
+    bool destroy = false;
+    if (table != NULL)
+    {
+        // Requests still holding the table finish first; the last one frees it
+        registry->slots[id - 1] = NULL;
+        registry->open--;
+        table->closed = true;
+        destroy = table->refs == 0;
+    }
+    pthread_mutex_unlock(&registry->mutex);
+
+    if (destroy)
+    {
+        discardTable(registry, table);
+    }
+    return table != NULL;
+}
+
+// --------------------
+// Checkpoint Functions
+// --------------------
+
+// Reopens the tables checkpointed in a directory and keeps checkpointing there; returns the number restored
+int restoreTables(TableRegistry* registry, const char* directory)
+{
+    registry->checkpointDirectory = directory;
+    DIR* dir = opendir(directory);
+    if (!dir)
+    {
+        perror("Error opening checkpoint directory");
+        exit(EXIT_FAILURE);
+    }
+
+    int restored = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        int id, used = 0;
+        if (sscanf(entry->d_name, "table_%d.snap%n", &id, &used) != 1 || entry->d_name[used] != '\0' || id <= 0)
+        {
+            continue;
+        }
+
+        char filename[1024];
+        checkpointName(registry, id, filename, sizeof(filename));
+        Table* table = newTable();
+        if (!readSnapshotFile(filename, &table->game, registry->lexicon))
+        {
+            fprintf(stderr, "Skipping unreadable snapshot %s\n", filename);
+            destroyTable(table);
+            continue;
+        }
+        table->id = id;
+        pthread_mutex_lock(&registry->mutex);
+        insertTable(registry, table);
+        pthread_mutex_unlock(&registry->mutex);
+        restored++;
+    }
+    closedir(dir);
+    return restored;
+}
+
+// Saves the snapshot of a table locked with acquireTable; does nothing without a checkpoint directory
+void checkpointTable(const TableRegistry* registry, const Table* table)
+{
+    if (registry->checkpointDirectory == NULL)
+    {
+        return;
+    }
+    char filename[1024];
+    checkpointName(registry, table->id, filename, sizeof(filename));
+    writeSnapshotFile(filename, &table->game);
+}
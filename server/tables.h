@@ -0,0 +1,63 @@
+// tables.h
+
+#ifndef TABLES_H
+#define TABLES_H
+
+#include "scrabble.h"
+#include <pthread.h>
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents one game hosted by the server
+typedef struct
+{
+    int id;                        // Identifier clients use to address the table
+    pthread_mutex_t mutex;         // Serializes the requests made on this table
+    Game game;                     // State of the game played on the table
+    int refs;                      // Requests using the table right now (guarded by the registry lock)
+    bool closed;                   // The table was closed and is freed once the last request releases it
+} Table;
+
+// Represents every table hosted by the server, indexed by id
+typedef struct
+{
+    pthread_mutex_t mutex;         // Protects the slots and the reference counts
+    Table** slots;                 // Slot id - 1 holds the table with that id, or NULL once closed
+    int count;                     // Number of ids handed out so far
+    int capacity;                  // Number of allocated slots
+    int open;                      // Number of tables not closed yet
+    const Lexicon* lexicon;        // Dictionary shared by every table
+    const char* checkpointDirectory; // Directory holding a snapshot of every open table, NULL for none
+} TableRegistry;
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Initializes an empty registry whose games validate words against the given lexicon
+void initRegistry(TableRegistry* registry, const Lexicon* lexicon);
+
+// Frees every table; no request may be running
+void freeRegistry(TableRegistry* registry);
+
+// Creates a table with a new game dealt from the given seed and returns its id
+int createTable(TableRegistry* registry, unsigned long long seed);
+
+// Finds an open table and locks it for the calling request; returns NULL if there is none
+Table* acquireTable(TableRegistry* registry, int id);
+
+// Unlocks a table taken with acquireTable
+void releaseTable(TableRegistry* registry, Table* table);
+
+// Closes a table; returns false if it does not exist
+bool closeTable(TableRegistry* registry, int id);
+
+// Reopens the tables checkpointed in a directory and keeps checkpointing there; returns the number restored
+int restoreTables(TableRegistry* registry, const char* directory);
+
+// Saves the snapshot of a table locked with acquireTable; does nothing without a checkpoint directory
+void checkpointTable(const TableRegistry* registry, const Table* table);
+
+#endif // TABLES_H
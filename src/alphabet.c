@@ -0,0 +1,256 @@
+// alphabet.c
+
+#include "alphabet.h"
+#include <string.h>
+
+// Codes of the letters that start or are a special tile; each digraph follows its first letter
+enum
+{
+    Code_C = 3,
+    Code_CH = 4,
+    Code_H = 9,
+    Code_L = 12,
+    Code_LL = 13,
+    Code_NTilde = 16,
+    Code_R = 20,
+    Code_RR = 21,
+};
+
+// Represents what the engine knows of one tile
+typedef struct
+{
+    const char* text;              // UTF-8 text shown for the tile
+    const char* blankText;         // Text shown for a blank playing as the letter
+    char symbol;                   // One-character ASCII form
+    char blankSymbol;              // One-character ASCII form of a blank playing as the letter
+    int score;                     // Points the tile is worth
+    int count;                     // Tiles of this letter in a full bag
+    bool vowel;
+} LetterInfo;
+
+// Spanish tile set, indexed by letter code; entry 0 describes an unassigned blank
+static const LetterInfo letterTable[ALPHABET_SIZE + 1] = {
+    {"?", "?", '?', '?', 0, 0, false},
+    {"A", "a", 'A', 'a', 1, 12, true},
+    {"B", "b", 'B', 'b', 3, 2, false},
+    {"C", "c", 'C', 'c', 3, 4, false},
+    {"CH", "ch", '1', '5', 5, 1, false},
+    {"D", "d", 'D', 'd', 2, 5, false},
+    {"E", "e", 'E', 'e', 1, 12, true},
+    {"F", "f", 'F', 'f', 4, 1, false},
+    {"G", "g", 'G', 'g', 2, 2, false},
+    {"H", "h", 'H', 'h', 4, 2, false},
+    {"I", "i", 'I', 'i', 1, 6, true},
+    {"J", "j", 'J', 'j', 8, 1, false},
+    {"L", "l", 'L', 'l', 1, 4, false},
+    {"LL", "ll", '2', '6', 8, 1, false},
+    {"M", "m", 'M', 'm', 3, 2, false},
+    {"N", "n", 'N', 'n', 1, 5, false},
+    {"\xC3\x91", "\xC3\xB1", '4', '8', 8, 1, false},
+    {"O", "o", 'O', 'o', 1, 9, true},
+    {"P", "p", 'P', 'p', 3, 2, false},
+    {"Q", "q", 'Q', 'q', 5, 1, false},
+    {"R", "r", 'R', 'r', 1, 5, false},
+    {"RR", "rr", '3', '7', 8, 1, false},
+    {"S", "s", 'S', 's', 1, 6, false},
+    {"T", "t", 'T', 't', 1, 4, false},
+    {"U", "u", 'U', 'u', 1, 5, true},
+    {"V", "v", 'V', 'v', 4, 1, false},
+    {"X", "x", 'X', 'x', 8, 1, false},
+    {"Y", "y", 'Y', 'y', 4, 1, false},
+    {"Z", "z", 'Z', 'z', 10, 1, false},
+};
+
+// Letter code of each ASCII letter in either case; K and W are not tiles
+static const char asciiLetters[256] = {
+    ['A'] = 1, ['B'] = 2, ['C'] = 3, ['D'] = 5, ['E'] = 6, ['F'] = 7, ['G'] = 8, ['H'] = 9,
+    ['I'] = 10, ['J'] = 11, ['L'] = 12, ['M'] = 14, ['N'] = 15, ['O'] = 17, ['P'] = 18, ['Q'] = 19,
+    ['R'] = 20, ['S'] = 22, ['T'] = 23, ['U'] = 24, ['V'] = 25, ['X'] = 26, ['Y'] = 27, ['Z'] = 28,
+    ['a'] = 1, ['b'] = 2, ['c'] = 3, ['d'] = 5, ['e'] = 6, ['f'] = 7, ['g'] = 8, ['h'] = 9,
+    ['i'] = 10, ['j'] = 11, ['l'] = 12, ['m'] = 14, ['n'] = 15, ['o'] = 17, ['p'] = 18, ['q'] = 19,
+    ['r'] = 20, ['s'] = 22, ['t'] = 23, ['u'] = 24, ['v'] = 25, ['x'] = 26, ['y'] = 27, ['z'] = 28,
+};
+
+// Letter code of the second byte of the two-byte UTF-8 letters starting with 0xC3: accented vowels
+// lose their accent and Ñ is a tile of its own
+static const char latinLetters[64] = {
+    [0x01] = 1, [0x09] = 6, [0x0D] = 10, [0x13] = 17, [0x1A] = 24, [0x1C] = 24, [0x11] = Code_NTilde,
+    [0x21] = 1, [0x29] = 6, [0x2D] = 10, [0x33] = 17, [0x3A] = 24, [0x3C] = 24, [0x31] = Code_NTilde,
+};
+
+// --------------------
+// Tile Functions
+// --------------------
+
+// Checks if a char holds a letter code
+bool isLetterCode(char letter)
+{
+    return letter >= 1 && letter <= ALPHABET_SIZE;
+}
+
+// Checks if a tile is a blank, assigned a letter or not
+bool isBlankTile(char tile)
+{
+    return tile == BLANK_TILE || (isLetterCode(tile & ~BLANK_TILE) && (tile & BLANK_TILE));
+}
+
+// Returns the letter code a tile plays as, without its blank bit
+char tileLetter(char tile)
+{
+    return (char)(tile & ~BLANK_TILE);
+}
+
+// Returns the rack tile a laid letter came from: the letter itself, or BLANK_TILE for a blank
+char rackTile(char tile)
+{
+    return isBlankTile(tile) ? BLANK_TILE : tile;
+}
+
+// Returns the points a tile is worth, 0 for a blank or an invalid code
+int getLetterScore(char letter)
+{
+    return isLetterCode(letter) ? letterTable[(int)letter].score : 0;
+}
+
+// Returns how many tiles of a letter a full bag holds
+int getLetterCount(char letter)
+{
+    return isLetterCode(letter) ? letterTable[(int)letter].count * TILE_SETS : 0;
+}
+
+// Checks if a letter is a vowel
+bool isVowel(char letter)
+{
+    return isLetterCode(letter) && letterTable[(int)letter].vowel;
+}
+
+// Checks if a tile is written with two letters (CH, LL, RR)
+bool isDigraph(char letter)
+{
+    return letter == Code_CH || letter == Code_LL || letter == Code_RR;
+}
+
+// Returns the UTF-8 text of a tile ("A", "CH", "Ñ", "ch" for a blank), or "?" for an unassigned blank
+const char* letterText(char letter)
+{
+    if (isBlankTile(letter))
+    {
+        return letterTable[(int)tileLetter(letter)].blankText;
+    }
+    return letterTable[isLetterCode(letter) ? (int)letter : 0].text;
+}
+
+// Returns the one-character ASCII symbol of a tile, or '?' for an unassigned blank
+char letterSymbol(char letter)
+{
+    if (isBlankTile(letter))
+    {
+        return letterTable[(int)tileLetter(letter)].blankSymbol;
+    }
+    return letterTable[isLetterCode(letter) ? (int)letter : 0].symbol;
+}
+
+// --------------------
+// Text Conversion
+// --------------------
+
+// Reads one tile written as letters, advancing past it; returns 0 if the text starts with none
+static char readTile(const unsigned char** text)
+{
+    const unsigned char* c = *text;
+    char letter = asciiLetters[c[0]];
+    if (letter != 0)
+    {
+        // CH, LL and RR are single tiles, and their codes follow C, L and R
+        char next = asciiLetters[c[1]];
+        if ((letter == Code_C && next == Code_H) || (letter == Code_L && next == Code_L) ||
+            (letter == Code_R && next == Code_R))
+        {
+            *text = c + 2;
+            return (char)(letter + 1);
+        }
+        *text = c + 1;
+        return letter;
+    }
+    if (c[0] == 0xC3 && c[1] >= 0x80 && c[1] < 0xC0 && latinLetters[c[1] - 0x80] != 0)
+    {
+        *text = c + 2;
+        return latinLetters[c[1] - 0x80];
+    }
+    return 0;
+}
+
+// Checks if a tile's text starts with a lowercase letter, which marks a blank
+static bool startsLowercase(const unsigned char* c)
+{
+    return (c[0] >= 'a' && c[0] <= 'z') || (c[0] == 0xC3 && c[1] >= 0xA0 && c[1] < 0xC0);
+}
+
+// Reads one tile from text, advancing past it; returns 0 if the text starts with none
+char parseLetter(const char** text)
+{
+    const unsigned char* c = (const unsigned char*)*text;
+
+    if (c[0] == '?')
+    {
+        *text = (const char*)(c + 1);
+        return BLANK_TILE;
+    }
+    // Symbols of the special tiles: 1 to 4, and 5 to 8 for blanks playing as them
+    if (c[0] >= '1' && c[0] <= '8')
+    {
+        static const char symbolLetters[4] = {Code_CH, Code_LL, Code_RR, Code_NTilde};
+        *text = (const char*)(c + 1);
+        return (char)(symbolLetters[(c[0] - '1') % 4] | (c[0] >= '5' ? BLANK_TILE : 0));
+    }
+
+    // A bracketed tile is read whole, so "[C]H" and "[CH]" differ
+    const unsigned char* start = (c[0] == '[') ? c + 1 : c;
+    const unsigned char* end = start;
+    char letter = readTile(&end);
+    if (letter == 0 || (c[0] == '[' && *end++ != ']'))
+    {
+        return 0;
+    }
+    *text = (const char*)end;
+    return startsLowercase(start) ? (char)(letter | BLANK_TILE) : letter;
+}
+
+// Converts a UTF-8 word into letter codes; returns the number of codes or -1
+int encodeWord(const char* text, char* codes, size_t size)
+{
+    const unsigned char* c = (const unsigned char*)text;
+    size_t length = 0;
+    while (*c != '\0')
+    {
+        char letter = readTile(&c);
+        if (letter == 0 || length + 1 >= size)
+        {
+            return -1;
+        }
+        codes[length++] = letter;
+    }
+    codes[length] = '\0';
+    return (int)length;
+}
+
+// Writes the UTF-8 text of a string of letter codes
+void decodeWord(const char* codes, char* text, size_t size)
+{
+    size_t length = 0;
+    for (const char* code = codes; *code != '\0'; code++)
+    {
+        const char* tile = letterText(*code);
+        size_t tileLength = strlen(tile);
+        if (length + tileLength >= size)
+        {
+            break;
+        }
+        memcpy(text + length, tile, tileLength);
+        length += tileLength;
+    }
+    if (size > 0)
+    {
+        text[length] = '\0';
+    }
+}
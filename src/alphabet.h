@@ -0,0 +1,95 @@
+// alphabet.h
+
+#ifndef ALPHABET_H
+#define ALPHABET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Number of distinct tiles; letter codes run from 1 to ALPHABET_SIZE and 0 means no letter
+#define ALPHABET_SIZE 28
+
+// Longest UTF-8 text of one tile ("CH", "Ñ"), terminator included
+#define LETTER_TEXT_SIZE 3
+
+// Bit set on the letter of a blank tile; alone it is a blank on a rack, not yet given a letter
+#define BLANK_TILE 0x40
+
+// Full tile sets in a bag: one for the 15 x 15 board, two for the 21 x 21 one (see BOARD_SIZE)
+#if defined(BOARD_SIZE) && BOARD_SIZE == 21
+#define TILE_SETS 2
+#else
+#define TILE_SETS 1
+#endif
+
+// Number of blank tiles in a full bag
+#define BLANK_COUNT (2 * TILE_SETS)
+
+// Every letter the engine handles -- on the board, in racks, in the bag and in the lexicon -- is a
+// letter code stored in a char, so words are ordinary NUL terminated strings that sort in Spanish
+// alphabetical order and index tables directly. The Spanish set has the digraph tiles CH, LL and RR
+// and the letter Ñ, and no K or W:
+//
+//   A B C CH D E F G H I J L LL M N Ñ O P Q R RR S T U V X Y Z
+//   1 2 3 4  5 6 7 8 9 10 ...                                 28
+//
+// Racks, moves and records mark a blank with BLANK_TILE: a blank waiting on a rack is BLANK_TILE
+// alone and a blank laid as a letter is BLANK_TILE | code. The board keeps the plain code and a flag.
+//
+// Text enters through encodeWord (UTF-8, any case, accents dropped, "ch", "ll" and "rr" read as one
+// tile) and parseLetter (the same, but lowercase is a blank and '?' an unassigned blank), and leaves
+// through letterText, lowercase for blanks. Where a fixed width is needed each tile also has a
+// one-character ASCII symbol: its letter, or 1 = CH, 2 = LL, 3 = RR and 4 = Ñ; blanks use the
+// lowercase letter or 5 = ch, 6 = ll, 7 = rr and 8 = ñ, and '?' when unassigned.
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Returns the points a tile is worth, 0 for a blank or an invalid code
+int getLetterScore(char letter);
+
+// Returns how many tiles of a letter a full bag holds
+int getLetterCount(char letter);
+
+// Checks if a letter is a vowel
+bool isVowel(char letter);
+
+// Checks if a char holds a letter code
+bool isLetterCode(char letter);
+
+// Checks if a tile is a blank, assigned a letter or not
+bool isBlankTile(char tile);
+
+// Returns the letter code a tile plays as, without its blank bit
+char tileLetter(char tile);
+
+// Returns the rack tile a laid letter came from: the letter itself, or BLANK_TILE for a blank
+char rackTile(char tile);
+
+// Checks if a tile is written with two letters (CH, LL, RR)
+bool isDigraph(char letter);
+
+// Returns the UTF-8 text of a tile ("A", "CH", "Ñ", "ch" for a blank), or "?" for an unassigned blank
+const char* letterText(char letter);
+
+// Returns the one-character ASCII symbol of a tile, or '?' for an unassigned blank
+char letterSymbol(char letter);
+
+// Reads one tile from text, advancing past it: a letter, an accented vowel, "CH", "LL" or "RR", "Ñ", a
+// symbol or a bracketed tile such as "[CH]", as a blank when lowercase, or '?' for an unassigned blank;
+// returns 0 if the text starts with none
+char parseLetter(const char** text);
+
+// Converts a UTF-8 word into letter codes; returns the number of codes, or -1 if the word holds a
+// character that is not a tile or does not fit in 'size' codes plus the terminator
+int encodeWord(const char* text, char* codes, size_t size);
+
+// Writes the UTF-8 text of a string of letter codes
+void decodeWord(const char* codes, char* text, size_t size);
+
+#endif // ALPHABET_H
@@ -0,0 +1,430 @@
+// analysis.c
+
+#include "analysis.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Value of keeping each letter on the rack, by letter code - 1 (A B C CH D E F G H I J L LL M N Ñ O P Q R RR S T U
+// V X Y Z); the heavy tiles that fit few words are worth playing off
+static const double leaveValues[ALPHABET_SIZE] = {
+    1.0, -2.0, -0.5, -3.0, 0.0, 2.0, -2.0, -2.0, -1.5, -0.5, -2.5, 0.5, -3.5, 0.0,
+    0.5, -3.5, 0.5, -1.0, -6.0, 1.5, -3.5, 6.0, 0.5, -2.5, -3.5, -3.5, -2.5, -2.5,
+};
+
+// Value of keeping a blank, which fits any word
+#define BLANK_LEAVE_VALUE 20.0
+
+// Penalty for each copy of a letter beyond the first
+#define DUPLICATE_PENALTY 2.0
+
+// Penalty for each vowel or consonant beyond a one-tile imbalance
+#define BALANCE_PENALTY 1.5
+
+// Equity of a certain bingo on the next draw
+#define BINGO_EQUITY 25.0
+
+// --------------------
+// Equity Functions
+// --------------------
+
+// Returns the penalty of a rack with this many more vowels than consonants, or the other way round
+static double balancePenalty(int imbalance)
+{
+    return imbalance > 1 ? BALANCE_PENALTY * (imbalance - 1) : 0.0;
+}
+
+// Returns the value of the tiles kept on the rack
+double evaluateLeave(const char leave[], int numLetters)
+{
+    int counts[ALPHABET_SIZE] = {0};
+    int vowels = 0, consonants = 0;
+    double value = 0.0;
+
+    for (int i = 0; i < numLetters; i++)
+    {
+        if (isBlankTile(leave[i]))
+        {
+            value += BLANK_LEAVE_VALUE; // Neither a vowel nor a consonant: it plays as whichever is short
+            continue;
+        }
+        if (!isLetterCode(leave[i]))
+        {
+            continue;
+        }
+        int letter = leave[i] - 1;
+        value += leaveValues[letter];
+        if (counts[letter]++ > 0)
+        {
+            value -= DUPLICATE_PENALTY;
+        }
+        if (isVowel(leave[i]))
+        {
+            vowels++;
+        }
+        else
+        {
+            consonants++;
+        }
+    }
+
+    return value - balancePenalty(abs(vowels - consonants));
+}
+
+// Returns the mask of the occupied rack slots whose tiles a placement does not lay
+static unsigned int keptSlots(const char rack[MAX_LETTERS], const Move* move)
+{
+    unsigned int slots = 0;
+    for (int j = 0; j < MAX_LETTERS; j++)
+    {
+        slots |= (rack[j] != '\0') ? 1u << j : 0;
+    }
+
+    for (int i = 0; i < move->numLetters; i++)
+    {
+        for (int j = 0; j < MAX_LETTERS; j++)
+        {
+            if ((slots >> j & 1) && rack[j] == rackTile(move->letters[i]))
+            {
+                slots &= ~(1u << j);
+                break;
+            }
+        }
+    }
+    return slots;
+}
+
+// Collects the rack tiles a placement does not lay; returns how many there are
+static int keptTiles(const char rack[MAX_LETTERS], const Move* move, char kept[MAX_LETTERS])
+{
+    unsigned int slots = keptSlots(rack, move);
+    int numKept = 0;
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        if (slots >> i & 1)
+        {
+            kept[numKept++] = rack[i];
+        }
+    }
+    return numKept;
+}
+
+// Returns the score of a placement plus the value of the tiles it leaves from the rack
+double evaluateEquity(const char rack[MAX_LETTERS], const Move* move)
+{
+    char kept[MAX_LETTERS];
+    int numKept = keptTiles(rack, move, kept);
+    return move->score + evaluateLeave(kept, numKept);
+}
+
+// Returns the equity of a placement, with the leave's bingo chance when the turn has a bingo index
+static double turnEquity(const TurnAnalysis* turn, const char rack[MAX_LETTERS], const Move* move,
+                         const TileCounts* unseen, InferenceCache* cache, double* bingoChance)
+{
+    char kept[MAX_LETTERS];
+    int numKept = keptTiles(rack, move, kept);
+    double equity = move->score + evaluateLeave(kept, numKept);
+
+    *bingoChance = 0.0;
+    if (turn->bingos != NULL)
+    {
+        TileCounts keptCounts;
+        countTiles(kept, numKept, &keptCounts);
+        *bingoChance = bingoDrawProbability(turn->bingos, cache, unseen, turn->position.bag.remaining, &keptCounts);
+        equity += BINGO_EQUITY * *bingoChance;
+    }
+    return equity;
+}
+
+// --------------------
+// Exchange Functions
+// --------------------
+
+// Represents what drawing tiles from a pool adds to a rack, by the number of tiles drawn
+typedef struct
+{
+    double meanValue;                                        // Mean leave value of one tile of the pool
+    double letterShare;                                      // Share of the pool's tiles that are not blanks
+    double anyDrawn[MAX_LETTERS + 1][ALPHABET_SIZE];         // Chance of drawing a letter at least once
+    double anyDrawnTotal[MAX_LETTERS + 1];                   // Sum of those chances over the letters
+    double balance[MAX_LETTERS + 1][2 * MAX_LETTERS + 1];    // Expected balance penalty, by kept vowels - consonants
+} DrawTables;
+
+// Fills the tables of drawing up to 'maxDraws' tiles from the pool, which holds at least that many
+static void buildDrawTables(const TileCounts* pool, int maxDraws, DrawTables* tables)
+{
+    int vowels = 0, consonants = 0;
+    int blanks = pool->counts[BLANK_KIND];
+    double valueSum = blanks * BLANK_LEAVE_VALUE;
+    for (int letter = 0; letter < ALPHABET_SIZE; letter++)
+    {
+        valueSum += pool->counts[letter] * leaveValues[letter];
+        if (isVowel((char)(letter + 1)))
+        {
+            vowels += pool->counts[letter];
+        }
+        else
+        {
+            consonants += pool->counts[letter];
+        }
+    }
+    tables->meanValue = valueSum / pool->total;
+    tables->letterShare = (double)(pool->total - blanks) / pool->total;
+
+    // Ways of drawing each number of vowels, consonants and blanks
+    double ways[3][MAX_LETTERS + 1];
+    for (int k = 0; k <= maxDraws; k++)
+    {
+        ways[0][k] = binomial(vowels, k);
+        ways[1][k] = binomial(consonants, k);
+        ways[2][k] = binomial(blanks, k);
+    }
+
+    // Each further draw misses a letter with the odds of picking among the tiles left that are not it
+    double missed[ALPHABET_SIZE];
+    for (int letter = 0; letter < ALPHABET_SIZE; letter++)
+    {
+        missed[letter] = 1.0;
+    }
+    for (int draws = 0; draws <= maxDraws; draws++)
+    {
+        double all = binomial(pool->total, draws);
+        double perTile = 1.0 / (pool->total - draws + 1);
+        tables->anyDrawnTotal[draws] = 0.0;
+        for (int letter = 0; letter < ALPHABET_SIZE; letter++)
+        {
+            if (draws > 0)
+            {
+                missed[letter] *= (pool->total - pool->counts[letter] - draws + 1) * perTile;
+            }
+            tables->anyDrawn[draws][letter] = 1.0 - missed[letter];
+            tables->anyDrawnTotal[draws] += tables->anyDrawn[draws][letter];
+        }
+
+        // Odds of drawing each number of vowels more than consonants, over the splits of the draw
+        double excess[2 * MAX_LETTERS + 1] = {0};
+        for (int v = 0; v <= draws; v++)
+        {
+            for (int c = 0; v + c <= draws; c++)
+            {
+                excess[v - c + MAX_LETTERS] += ways[0][v] * ways[1][c] * ways[2][draws - v - c] / all;
+            }
+        }
+        for (int kept = -MAX_LETTERS; kept <= MAX_LETTERS; kept++)
+        {
+            double expected = 0.0;
+            for (int drawn = -draws; drawn <= draws; drawn++)
+            {
+                expected += excess[drawn + MAX_LETTERS] * balancePenalty(abs(kept + drawn));
+            }
+            tables->balance[draws][kept + MAX_LETTERS] = expected;
+        }
+    }
+}
+
+// Values every exchange of a rack that swaps no more tiles than the bag holds, drawing from the unseen
+// tiles. The subsets are visited in increasing mask order, so each one's kept value and letters extend
+// those of the subset without its lowest slot
+void evaluateExchanges(const char rack[MAX_LETTERS], const TileCounts* unseen, int bagRemaining,
+                       ExchangeEvaluation* exchanges)
+{
+    unsigned int occupied = 0, letterSlots = 0, vowelSlots = 0;
+    double slotValue[MAX_LETTERS] = {0};
+    unsigned int slotLetter[MAX_LETTERS] = {0};
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        if (isBlankTile(rack[i]))
+        {
+            occupied |= 1u << i;
+            slotValue[i] = BLANK_LEAVE_VALUE;
+        }
+        else if (isLetterCode(rack[i]))
+        {
+            occupied |= 1u << i;
+            letterSlots |= 1u << i;
+            vowelSlots |= isVowel(rack[i]) ? 1u << i : 0;
+            slotValue[i] = leaveValues[rack[i] - 1];
+            slotLetter[i] = 1u << (rack[i] - 1);
+        }
+    }
+
+    memset(exchanges, 0, sizeof(ExchangeEvaluation));
+    exchanges->bestKeep = occupied;
+    int numTiles = __builtin_popcount(occupied);
+    int maxDraws = numTiles < bagRemaining ? numTiles : bagRemaining;
+    if (maxDraws > unseen->total)
+    {
+        maxDraws = unseen->total;
+    }
+    if (maxDraws == 0)
+    {
+        return;
+    }
+    DrawTables tables;
+    buildDrawTables(unseen, maxDraws, &tables);
+
+    double keptValue[EXCHANGE_MASKS];
+    unsigned int keptLetters[EXCHANGE_MASKS];
+    keptValue[0] = 0.0;
+    keptLetters[0] = 0;
+    for (unsigned int keep = 0; keep < EXCHANGE_MASKS; keep++)
+    {
+        if (keep & ~occupied)
+        {
+            continue;
+        }
+        if (keep != 0)
+        {
+            int slot = __builtin_ctz(keep);
+            keptValue[keep] = keptValue[keep & (keep - 1)] + slotValue[slot];
+            keptLetters[keep] = keptLetters[keep & (keep - 1)] | slotLetter[slot];
+        }
+        int draws = numTiles - __builtin_popcount(keep);
+        if (draws == 0 || draws > maxDraws)
+        {
+            continue;
+        }
+
+        // Duplicates are the letter tiles beyond one per distinct letter; a drawn letter is a new one
+        // unless it is kept, so the letters kept are taken out of the chance of drawing new ones
+        int letters = __builtin_popcount(keep & letterSlots);
+        int vowels = __builtin_popcount(keep & vowelSlots);
+        double newLetters = tables.anyDrawnTotal[draws];
+        for (unsigned int set = keptLetters[keep]; set != 0; set &= set - 1)
+        {
+            newLetters -= tables.anyDrawn[draws][__builtin_ctz(set)];
+        }
+        double duplicates = letters + draws * tables.letterShare - __builtin_popcount(keptLetters[keep]) - newLetters;
+
+        double value = keptValue[keep] + draws * tables.meanValue - DUPLICATE_PENALTY * duplicates -
+                       tables.balance[draws][2 * vowels - letters + MAX_LETTERS];
+        exchanges->values[keep] = value;
+        if (exchanges->numExchanges++ == 0 || value > exchanges->bestValue)
+        {
+            exchanges->bestKeep = keep;
+            exchanges->bestValue = value;
+        }
+    }
+}
+
+// --------------------
+// Analysis Functions
+// --------------------
+
+// Generates every placement of a turn and compares the best ones with the move made
+void analyzeTurn(TurnAnalysis* turn)
+{
+    const Player* player = (turn->player == Player1) ? &turn->position.player1 : &turn->position.player2;
+
+    // Leaves repeat across the placements of a rack, so their bingo chances are memoized for the turn
+    TileCounts unseen;
+    InferenceCache* cache = NULL;
+    countUnseenTiles(&turn->position, turn->player, &unseen);
+    if (turn->bingos != NULL)
+    {
+        cache = malloc(sizeof(InferenceCache));
+        if (!cache)
+        {
+            perror("Error allocating inference cache");
+            exit(EXIT_FAILURE);
+        }
+        initInferenceCache(cache);
+    }
+
+    // Swapping the whole rack keeps nothing; an exchange keeps what it does not swap, and a pass or a play
+    // what it does not lay
+    double bingoChance;
+    Move played = turn->played;
+    if (turn->swapped && played.numLetters == 0)
+    {
+        memcpy(played.letters, player->letters, MAX_LETTERS);
+        played.numLetters = MAX_LETTERS;
+    }
+    turn->playedEquity = turnEquity(turn, player->letters, &played, &unseen, cache, &bingoChance);
+
+    ExchangeEvaluation exchanges;
+    evaluateExchanges(player->letters, &unseen, turn->position.bag.remaining, &exchanges);
+    turn->canExchange = exchanges.numExchanges > 0;
+    turn->exchangeKeep = exchanges.bestKeep;
+    turn->exchangeValue = exchanges.bestValue;
+
+    // An exchange made is priced like the exchanges it is weighed against, by what the draw is expected to
+    // add to the tiles kept, when it is one evaluateExchanges values
+    if (turn->swapped)
+    {
+        int draws = played.numLetters;
+        if (draws > 0 && draws <= turn->position.bag.remaining && draws <= unseen.total)
+        {
+            turn->playedEquity = exchanges.values[keptSlots(player->letters, &played)] + BINGO_EQUITY * bingoChance;
+        }
+    }
+
+    MoveList list;
+    initMoveList(&list);
+    turn->numMoves = generateSortedMoves(turn->moveCache, &turn->position, player->letters, &list, NULL, NULL);
+    turn->found = list.count > 0;
+
+    int bestScore = 0, bestEquity = 0;
+    double bestEquityValue = 0.0, bestBingoChance = 0.0;
+    for (int i = 0; i < list.count; i++)
+    {
+        double equity = turnEquity(turn, player->letters, &list.moves[i], &unseen, cache, &bingoChance);
+        if (list.moves[i].score > list.moves[bestScore].score)
+        {
+            bestScore = i;
+        }
+        if (i == 0 || equity > bestEquityValue)
+        {
+            bestEquity = i;
+            bestEquityValue = equity;
+            bestBingoChance = bingoChance;
+        }
+    }
+
+    if (turn->found)
+    {
+        turn->bestScore = list.moves[bestScore];
+        turn->bestEquity = list.moves[bestEquity];
+        turn->bestEquityValue = bestEquityValue;
+        turn->bingoChance = bestBingoChance;
+        turn->pointsLost = turn->bestScore.score - turn->played.score;
+        turn->equityLost = bestEquityValue - turn->playedEquity;
+    }
+    else
+    {
+        memset(&turn->bestScore, 0, sizeof(Move));
+        memset(&turn->bestEquity, 0, sizeof(Move));
+        turn->bestEquityValue = 0.0;
+        turn->bingoChance = 0.0;
+        turn->pointsLost = 0;
+        turn->equityLost = 0.0;
+    }
+    // A swap or a pass can have more equity than every placement
+    if (turn->pointsLost < 0)
+    {
+        turn->pointsLost = 0;
+    }
+    if (turn->equityLost < 0.0)
+    {
+        turn->equityLost = 0.0;
+    }
+
+    freeMoveList(&list);
+    free(cache);
+}
+
+// Runs one turn's analysis as a pool task
+static void analyzeTurnTask(void* arg)
+{
+    analyzeTurn(arg);
+}
+
+// Analyzes turns in parallel on the pool; each position is independent of the others
+void analyzeTurns(ThreadPool* pool, TurnAnalysis turns[], int numTurns)
+{
+    for (int i = 0; i < numTurns; i++)
+    {
+        submitTask(pool, analyzeTurnTask, &turns[i]);
+    }
+    waitForTasks(pool);
+}
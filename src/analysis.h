@@ -0,0 +1,90 @@
+// analysis.h
+
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include "scrabble.h"
+#include "movegen.h"
+#include "movecache.h"
+#include "threadpool.h"
+#include "inference.h"
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Equity is a placement's score plus the value of the tiles it leaves on the rack:
+// good tiles kept for the next turn (a blank, S, E) add to it, awkward ones (Q, V, duplicates,
+// an unbalanced mix of vowels and consonants) subtract from it. With a bingo index the chance of
+// drawing the leave into a seven-letter word is added as well.
+//
+// An exchange keeps some of the rack's tiles and draws the rest from those the player cannot see. It is
+// valued by the expected leave value of the rack it leads to: the kept tiles' values, the mean value of an
+// unseen tile per draw, and the duplicate and balance penalties weighted by the odds of the draws that
+// cause them. The odds are tabulated once by number of draws, so every subset of the rack, enumerated as a
+// bitmask of its slots, is valued with a few table lookups. An exchange made is priced the same way, plus
+// the bingo chance of the tiles it keeps.
+
+// Masks of rack slots, bit i for slot i
+#define EXCHANGE_MASKS (1 << MAX_LETTERS)
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents one turn of a game, the move actually made and the alternatives found for it
+typedef struct
+{
+    // Input
+    Game position;                 // Position before the turn, with the mover's rack
+    PlayerTurn player;             // Player whose turn it was
+    Move played;                   // Tiles actually laid or swapped; numLetters is 0 for a pass or a whole rack swap
+    bool swapped;                  // The player swapped tiles instead of playing
+    const BingoIndex* bingos;      // Seven-letter anagram keys valuing the leave's bingo chances, or NULL
+    MoveCache* moveCache;          // Move lists shared with other turns, or NULL to always generate
+
+    // Output
+    int numMoves;                  // Legal placements the rack had
+    bool found;                    // Indicates if there was any legal placement
+    Move bestScore;                // Highest scoring placement
+    Move bestEquity;               // Placement with the highest equity
+    double bestEquityValue;        // Equity of bestEquity
+    double playedEquity;           // Equity of the move actually made
+    int pointsLost;                // Points the best scoring placement would have added
+    double equityLost;             // Equity the best equity placement would have added
+    double bingoChance;            // Chance the best equity placement's leave draws into a bingo
+    bool canExchange;              // The bag holds tiles to exchange for
+    unsigned int exchangeKeep;     // Rack slots the best exchange keeps
+    double exchangeValue;          // Expected leave value of the rack after the best exchange
+} TurnAnalysis;
+
+// Represents the value of every exchange of a rack, by the mask of the slots it keeps
+typedef struct
+{
+    double values[EXCHANGE_MASKS]; // Expected leave value after the exchange; 0 for masks not valued
+    int numExchanges;              // Exchanges valued: keeping any subset of the tiles but all of them
+    unsigned int bestKeep;         // Slots kept by the exchange of the highest value
+    double bestValue;
+} ExchangeEvaluation;
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Returns the value of the tiles kept on the rack
+double evaluateLeave(const char leave[], int numLetters);
+
+// Returns the score of a placement plus the value of the tiles it leaves from the rack
+double evaluateEquity(const char rack[MAX_LETTERS], const Move* move);
+
+// Values every exchange of a rack that swaps no more tiles than the bag holds, drawing from the unseen tiles
+void evaluateExchanges(const char rack[MAX_LETTERS], const TileCounts* unseen, int bagRemaining,
+                       ExchangeEvaluation* exchanges);
+
+// Generates every placement of a turn and compares the best ones with the move made
+void analyzeTurn(TurnAnalysis* turn);
+
+// Analyzes turns in parallel on the pool; each position is independent of the others
+void analyzeTurns(ThreadPool* pool, TurnAnalysis turns[], int numTurns);
+
+#endif // ANALYSIS_H
@@ -42,6 +42,31 @@ void writeInOrder(Node *root, FILE *file) {
     }
 }
 
+// Funcion para recorrer el arbol en orden llamando a 'visit' con cada palabra
+// Es el mismo recorrido que writeInOrder, pero la operacion la decide quien llama
+void visitInOrder(Node *root, void (*visit)(const char *word, void *user), void *user) {
+    if (root) {
+        visitInOrder(root->left, visit, user);
+        visit(root->word, user);
+        visitInOrder(root->right, visit, user);
+    }
+}
+
+// Funcion para armar un BST balanceado a partir de palabras ya ordenadas y sin repetir
+// El nodo i guarda la palabra i, y la raiz de cada rango es su palabra del medio,
+// asi la altura del arbol es log2 de la cantidad de palabras sin importar el orden del archivo
+Node *buildBalanced(Node *nodes, char *const *words, int first, int last) {
+    if (first > last) {
+        return NULL;
+    }
+    int middle = first + (last - first) / 2; // La palabra del medio queda como raiz del rango
+    Node *node = &nodes[middle];
+    strcpy(node->word, words[middle]);
+    node->left = buildBalanced(nodes, words, first, middle - 1); // Las menores van a la izquierda
+    node->right = buildBalanced(nodes, words, middle + 1, last); // Las mayores van a la derecha
+    return node;
+}
+
 // Funcion para buscar una palabra en el BST
 bool search(Node *root, const char *word) {
     if (!root) {
@@ -56,6 +81,38 @@ bool search(Node *root, const char *word) {
     return search(root->right, word); // Si la palabra no igual o menor la busqueda se mueve a la derecha
 }
 
+// Funcion para saber si alguna palabra del BST empieza con el prefijo dado
+// Las palabras que comparten un prefijo forman un rango contiguo en el orden del arbol,
+// asi que basta con descender como en la busqueda normal comparando solo los primeros caracteres
+bool searchPrefix(Node *root, const char *prefix) {
+    if (!root) {
+        return false;
+    }
+    int comparison = strncmp(prefix, root->word, strlen(prefix)); // Compara el prefijo con el inicio de la palabra del nodo actual
+    if (comparison == 0) {
+        return true;
+    }
+    if (comparison < 0) { // Si el prefijo es menor, todas las palabras que lo comparten estan a la izquierda
+        return searchPrefix(root->left, prefix);
+    }
+    return searchPrefix(root->right, prefix);
+}
+
+// Funcion para encontrar la primera palabra del BST que no es menor a la dada (NULL si no hay ninguna)
+// Sirve para saltar de una continuacion de un prefijo a la siguiente sin probar cada letra
+Node *lowerBound(Node *root, const char *word) {
+    Node *candidate = NULL;
+    while (root) {
+        if (strcmp(root->word, word) >= 0) { // El nodo sirve, pero puede haber una palabra menor a la izquierda
+            candidate = root;
+            root = root->left;
+        } else {
+            root = root->right;
+        }
+    }
+    return candidate;
+}
+
 // Liberar memoria del arbol nodo por nodo hasta llegar al root del arbol
 void freeTree(Node *root) {
     if (root) {
@@ -19,10 +19,18 @@ Node *createNode(const char *word);
 
 Node *insert(Node *root, const char *word);
 
+Node *buildBalanced(Node *nodes, char *const *words, int first, int last);
+
 void writeInOrder(Node *root, FILE *file);
 
+void visitInOrder(Node *root, void (*visit)(const char *word, void *user), void *user);
+
 bool search(Node *root, const char *word);
 
+bool searchPrefix(Node *root, const char *prefix);
+
+Node *lowerBound(Node *root, const char *word);
+
 void freeTree(Node *root);
 
 #endif //ARBOL_DICCIONARIO_H
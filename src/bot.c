@@ -0,0 +1,171 @@
+// bot.c
+
+#include "bot.h"
+#include "alphabet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Names of the strategies, by BotStrategy
+static const char* strategyNames[] = {"score", "equity", "bingo"};
+
+// --------------------
+// Configuration
+// --------------------
+
+// Reads a configuration written as "STRATEGY[,swap=VALUE]" or "NAME=STRATEGY[,swap=VALUE]"
+bool parseBotConfig(const char* text, BotConfig* bot)
+{
+    memset(bot, 0, sizeof(BotConfig));
+    const char* strategy = text;
+    const char* equals = strchr(text, '=');
+    const char* comma = strchr(text, ',');
+    if (equals != NULL && (comma == NULL || equals < comma))
+    {
+        snprintf(bot->name, sizeof(bot->name), "%.*s", (int)(equals - text), text);
+        strategy = equals + 1;
+    }
+    else
+    {
+        snprintf(bot->name, sizeof(bot->name), "%s", text);
+    }
+
+    size_t length = comma ? (size_t)(comma - strategy) : strlen(strategy);
+    int found = -1;
+    for (int i = 0; i < (int)(sizeof(strategyNames) / sizeof(strategyNames[0])); i++)
+    {
+        if (strlen(strategyNames[i]) == length && strncmp(strategy, strategyNames[i], length) == 0)
+        {
+            found = i;
+        }
+    }
+    if (found < 0 || bot->name[0] == '\0')
+    {
+        return false;
+    }
+    bot->strategy = (BotStrategy)found;
+
+    if (comma != NULL)
+    {
+        if (strncmp(comma + 1, "swap=", 5) != 0)
+        {
+            return false;
+        }
+        char* end;
+        bot->swapBelow = strtod(comma + 6, &end);
+        if (end == comma + 6 || *end != '\0')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns the name of a strategy as parseBotConfig reads it
+const char* botStrategyName(BotStrategy strategy)
+{
+    return strategyNames[strategy];
+}
+
+// --------------------
+// Games
+// --------------------
+
+// Returns the points of the tiles left on a rack
+static int rackValue(const Player* player)
+{
+    int value = 0;
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        if (isLetterCode(player->letters[i]))
+        {
+            value += getLetterScore(player->letters[i]);
+        }
+    }
+    return value;
+}
+
+// Returns the mask of a player's rack slots that hold a tile
+static unsigned int rackSlots(const Player* player)
+{
+    unsigned int slots = 0;
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        if (player->letters[i] != '\0')
+        {
+            slots |= 1u << i;
+        }
+    }
+    return slots;
+}
+
+// Plays a game from a bag shuffled by the seed, 'first' moving first
+void playBotGame(const BotContext* context, const BotConfig* first, const BotConfig* second,
+                 unsigned long long seed, BotGame* result)
+{
+    Game* game = malloc(sizeof(Game));
+    TurnAnalysis* turn = malloc(sizeof(TurnAnalysis));
+    if (!game || !turn)
+    {
+        perror("Error allocating bot game");
+        exit(EXIT_FAILURE);
+    }
+    initGame(game, context->lexicon, seed);
+
+    int scoreless = 0;
+    int turns = 0;
+    while (!game->gameOver && turns < MAX_BOT_TURNS)
+    {
+        const BotConfig* bot = (game->turn == Player1) ? first : second;
+        const Player* player = (game->turn == Player1) ? &game->player1 : &game->player2;
+        memset(turn, 0, sizeof(TurnAnalysis));
+        cloneGame(game, &turn->position);
+        turn->player = game->turn;
+        turn->bingos = (bot->strategy == Bot_Bingo) ? context->bingos : NULL;
+        turn->moveCache = context->moveCache;
+        analyzeTurn(turn);
+        turns++;
+
+        // A placement worth less than the threshold is not played while the bag holds a full rack to swap for
+        const Move* choice = (bot->strategy == Bot_Score) ? &turn->bestScore : &turn->bestEquity;
+        double value = (bot->strategy == Bot_Score) ? turn->bestScore.score : turn->bestEquityValue;
+        bool canSwap = game->bag.remaining >= MAX_LETTERS && turn->canExchange;
+        if (!turn->found || (canSwap && bot->swapBelow > 0 && value < bot->swapBelow))
+        {
+            if (canSwap)
+            {
+                exchangePlayerLetters(game, rackSlots(player) & ~turn->exchangeKeep);
+            }
+            else
+            {
+                switchTurn(game);
+            }
+            game->gameOver = ++scoreless >= MAX_SCORELESS_TURNS;
+            continue;
+        }
+
+        int score = playMove(game, choice->squares, choice->letters, choice->numLetters);
+        scoreless = (score > 0) ? 0 : scoreless + 1;
+        game->gameOver = (game->bag.remaining == 0 && countPlayerLetters(player) == 0) ||
+                         scoreless >= MAX_SCORELESS_TURNS;
+    }
+
+    // Each player loses what is left on their rack, and a player who went out gains the other's
+    int left1 = rackValue(&game->player1);
+    int left2 = rackValue(&game->player2);
+    result->scores[0] = game->player1.score - left1;
+    result->scores[1] = game->player2.score - left2;
+    if (game->bag.remaining == 0 && countPlayerLetters(&game->player1) == 0)
+    {
+        result->scores[0] += left2;
+    }
+    if (game->bag.remaining == 0 && countPlayerLetters(&game->player2) == 0)
+    {
+        result->scores[1] += left1;
+    }
+    result->turns = turns;
+
+    freeGame(game);
+    free(game);
+    free(turn);
+}
@@ -0,0 +1,85 @@
+// bot.h
+
+#ifndef BOT_H
+#define BOT_H
+
+#include "scrabble.h"
+#include "analysis.h"
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Longest name of a bot configuration, terminator included
+#define BOT_NAME_LENGTH 32
+
+// Turns after which a game between bots is stopped and scored as it stands
+#define MAX_BOT_TURNS 200
+
+// Turns in a row without points (passes and swaps) after which a game ends
+#define MAX_SCORELESS_TURNS 6
+
+// A bot picks its placement from the turn analysis: the highest score, or the highest equity with or
+// without the chance of drawing the leave into a bingo. With no placement, or none worth more than its
+// swap threshold, it exchanges the tiles the best exchange of the turn analysis does not keep while the
+// bag holds a full rack, and passes otherwise.
+//
+// A game between bots ends when a player lays their last tile with the bag empty, after
+// MAX_SCORELESS_TURNS turns without points or after MAX_BOT_TURNS turns. The tiles left on a rack are
+// taken from its owner's score and, when the other player went out, added to theirs.
+
+// --------------------
+// Enumerations
+// --------------------
+
+// Represents how a bot ranks placements
+typedef enum
+{
+    Bot_Score,                     // Highest score
+    Bot_Equity,                    // Highest score plus leave value
+    Bot_Bingo,                     // Highest equity, the leave's bingo chance included
+} BotStrategy;
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents the settings of a bot
+typedef struct
+{
+    char name[BOT_NAME_LENGTH];
+    BotStrategy strategy;
+    double swapBelow;              // Swaps rather than play for less (points or equity by strategy); 0 or less never
+} BotConfig;
+
+// Represents what bots share while they play: read-only tables, and move lists any thread may add to
+typedef struct
+{
+    const Lexicon* lexicon;
+    const BingoIndex* bingos;      // Seven-letter anagram keys, required by Bot_Bingo
+    MoveCache* moveCache;          // Move lists of positions already searched, or NULL
+} BotContext;
+
+// Represents the outcome of one game between bots
+typedef struct
+{
+    int scores[2];                 // Final score of the first and the second player, adjustments included
+    int turns;
+} BotGame;
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Reads a configuration written as "STRATEGY[,swap=VALUE]" or "NAME=STRATEGY[,swap=VALUE]", the strategy
+// being score, equity or bingo; returns false if the text is not one
+bool parseBotConfig(const char* text, BotConfig* bot);
+
+// Returns the name of a strategy as parseBotConfig reads it
+const char* botStrategyName(BotStrategy strategy);
+
+// Plays a game from a bag shuffled by the seed, 'first' moving first
+void playBotGame(const BotContext* context, const BotConfig* first, const BotConfig* second,
+                 unsigned long long seed, BotGame* result);
+
+#endif // BOT_H
@@ -0,0 +1,286 @@
+// duplicate.c
+
+#include "duplicate.h"
+#include "alphabet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Searches splitting the board's rows and columns for the top
+#define SEARCH_TASKS ((2 * LENGTH + LINES_PER_SEARCH_TASK - 1) / LINES_PER_SEARCH_TASK)
+
+// --------------------
+// Game Functions
+// --------------------
+
+// Starts a duplicate game for a number of players, drawing the first rack from a bag shuffled by the seed
+void initDuplicateGame(DuplicateGame* dup, const Lexicon* lexicon, unsigned long long seed, int numPlayers)
+{
+    initGame(&dup->game, lexicon, seed);
+
+    // Every player plays the first rack, so the second one goes back to the bag
+    Player* second = &dup->game.player2;
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        if (second->letters[i] != '\0')
+        {
+            dup->game.bag.letters[dup->game.bag.remaining++] = second->letters[i];
+            second->letters[i] = '\0';
+        }
+    }
+
+    dup->scores = calloc(numPlayers > 0 ? numPlayers : 1, sizeof(int));
+    if (!dup->scores)
+    {
+        perror("Error allocating duplicate game");
+        exit(EXIT_FAILURE);
+    }
+    dup->numPlayers = numPlayers;
+    dup->topTotal = 0;
+    dup->round = 0;
+    dup->redraws = 0;
+    dup->openings = NULL;
+}
+
+// Frees the totals of a duplicate game
+void freeDuplicateGame(DuplicateGame* dup)
+{
+    free(dup->scores);
+    dup->scores = NULL;
+    dup->numPlayers = 0;
+}
+
+// --------------------
+// Judging
+// --------------------
+
+// Judges and scores a submission against the position without changing it
+SubmissionResult judgeSubmission(const DuplicateGame* dup, Game* scratch, const Move* move, int* score)
+{
+    *score = 0;
+    int numLetters = move->numLetters;
+    if (numLetters < 1 || numLetters > MAX_LETTERS || !isPlacementLegal(scratch, move->squares, numLetters))
+    {
+        return SubmissionIllegal;
+    }
+
+    // The tiles must come from the round's rack, a blank as BLANK_TILE whatever letter it is given
+    char word[MAX_LETTERS + 1];
+    for (int i = 0; i < numLetters; i++)
+    {
+        if (!isLetterCode(tileLetter(move->letters[i])))
+        {
+            return SubmissionIllegal;
+        }
+        word[i] = rackTile(move->letters[i]);
+    }
+    word[numLetters] = '\0';
+    if (!playerHasLetters(&dup->game.player1, word))
+    {
+        return SubmissionIllegal;
+    }
+
+    // Lay the tiles, score every word they form and lift them again
+    Coordinate placed[MAX_LETTERS];
+    for (int i = 0; i < numLetters; i++)
+    {
+        placed[i] = move->squares[i];
+        setSquare(scratch, move->squares[i].x, move->squares[i].y, move->letters[i]);
+    }
+    int points = validateAndScoreWords(scratch, placed, numLetters);
+    for (int i = 0; i < numLetters; i++)
+    {
+        setSquare(scratch, move->squares[i].x, move->squares[i].y, '\0');
+    }
+    if (points < 0)
+    {
+        return SubmissionInvalidWord;
+    }
+
+    *score = points;
+    return SubmissionValid;
+}
+
+// Represents a run of submissions judged by one task
+typedef struct
+{
+    const DuplicateGame* dup;
+    Submission* submissions;
+    int count;
+} JudgeTask;
+
+// Judges a run of submissions on a private copy of the position
+static void judgeSubmissions(void* arg)
+{
+    JudgeTask* task = (JudgeTask*)arg;
+    Game* scratch = malloc(sizeof(Game));
+    if (!scratch)
+    {
+        perror("Error allocating duplicate position");
+        exit(EXIT_FAILURE);
+    }
+    cloneGame(&task->dup->game, scratch);
+
+    for (int i = 0; i < task->count; i++)
+    {
+        Submission* submission = &task->submissions[i];
+        if (submission->player < 0 || submission->player >= task->dup->numPlayers)
+        {
+            submission->result = SubmissionNoSeat;
+            submission->score = 0;
+            continue;
+        }
+        submission->result = judgeSubmission(task->dup, scratch, &submission->move, &submission->score);
+    }
+
+    free(scratch);
+}
+
+// Represents the search for the best placement on some of the board's lines
+typedef struct
+{
+    const DuplicateGame* dup;
+    int firstLine;                 // First line searched, the rows counted from 0 and the columns from LENGTH
+    Move best;
+    bool found;
+} TopTask;
+
+// Finds the highest scoring placement of the round's rack on a range of lines
+static void findTopInLines(void* arg)
+{
+    TopTask* task = (TopTask*)arg;
+    const Game* game = &task->dup->game;
+
+    MoveList list;
+    initMoveList(&list);
+    generateLineMoves(game, game->player1.letters, &list, task->firstLine, LINES_PER_SEARCH_TASK);
+    task->found = list.count > 0;
+    if (task->found)
+    {
+        sortMovesByScore(&list);
+        task->best = list.moves[0];
+    }
+    freeMoveList(&list);
+}
+
+// --------------------
+// Round Functions
+// --------------------
+
+// Plays a round: judges every submission while the top is searched, credits them, then plays the top
+void playDuplicateRound(DuplicateGame* dup, Submission submissions[], int numSubmissions, ThreadPool* pool,
+                        DuplicateRound* round)
+{
+    memset(round, 0, sizeof(DuplicateRound));
+    if (dup->game.gameOver)
+    {
+        return;
+    }
+
+    // The first round is answered from the opening table when there is one; otherwise the search for the top
+    // is split by lines and queued first, as the longest work, and the submissions are judged around it
+    MoveList openings;
+    initMoveList(&openings);
+    bool opened = findOpeningMoves(dup->openings, &dup->game, dup->game.player1.letters, &openings);
+    TopTask searches[SEARCH_TASKS];
+    for (int t = 0; t < SEARCH_TASKS && !opened; t++)
+    {
+        searches[t].dup = dup;
+        searches[t].firstLine = t * LINES_PER_SEARCH_TASK;
+        searches[t].found = false;
+        submitTask(pool, findTopInLines, &searches[t]);
+    }
+
+    int numTasks = (numSubmissions + SUBMISSIONS_PER_TASK - 1) / SUBMISSIONS_PER_TASK;
+    JudgeTask* tasks = malloc((numTasks > 0 ? numTasks : 1) * sizeof(JudgeTask));
+    if (!tasks)
+    {
+        perror("Error allocating duplicate round");
+        exit(EXIT_FAILURE);
+    }
+    for (int t = 0; t < numTasks; t++)
+    {
+        int first = t * SUBMISSIONS_PER_TASK;
+        tasks[t].dup = dup;
+        tasks[t].submissions = &submissions[first];
+        tasks[t].count = (numSubmissions - first < SUBMISSIONS_PER_TASK) ? numSubmissions - first
+                                                                         : SUBMISSIONS_PER_TASK;
+        submitTask(pool, judgeSubmissions, &tasks[t]);
+    }
+    waitForTasks(pool);
+    free(tasks);
+
+    // Each player is credited once a round, for the first of their submissions that is valid
+    bool* credited = calloc(dup->numPlayers > 0 ? dup->numPlayers : 1, sizeof(bool));
+    if (!credited)
+    {
+        perror("Error allocating duplicate round");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < numSubmissions; i++)
+    {
+        Submission* submission = &submissions[i];
+        if (submission->result != SubmissionValid)
+        {
+            continue;
+        }
+        if (credited[submission->player])
+        {
+            submission->result = SubmissionRepeated;
+            submission->score = 0;
+            continue;
+        }
+        credited[submission->player] = true;
+        dup->scores[submission->player] += submission->score;
+        round->numValid++;
+        if (submission->score > round->bestSubmitted)
+        {
+            round->bestSubmitted = submission->score;
+        }
+    }
+    free(credited);
+
+    // The best of the lines' bests, in the generator's order, is the top findBestMove would find
+    Move candidates[SEARCH_TASKS];
+    MoveList best = {candidates, 0, SEARCH_TASKS};
+    if (opened && openings.count > 0)
+    {
+        best.count = 1;
+        candidates[0] = openings.moves[0];
+    }
+    for (int t = 0; t < SEARCH_TASKS && !opened; t++)
+    {
+        if (searches[t].found)
+        {
+            candidates[best.count++] = searches[t].best;
+        }
+    }
+    sortMovesByScore(&best);
+    freeMoveList(&openings);
+
+    dup->round++;
+    Game* game = &dup->game;
+    if (best.count > 0)
+    {
+        Move top = candidates[0];
+
+        // playMove passes the turn, but the round's rack is always the first player's
+        int score = playMove(game, top.squares, top.letters, top.numLetters);
+        game->turn = Player1;
+        dup->topTotal += score;
+        dup->redraws = 0;
+        round->played = true;
+        round->top = top;
+        round->top.score = score;
+        game->gameOver = countPlayerLetters(&game->player1) == 0;
+    }
+    else if (game->bag.remaining == 0 || ++dup->redraws > MAX_DUPLICATE_REDRAWS)
+    {
+        game->gameOver = true;
+    }
+    else
+    {
+        rerollPlayerLetters(game);
+        game->turn = Player1;
+    }
+}
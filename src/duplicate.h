@@ -0,0 +1,102 @@
+// duplicate.h
+
+#ifndef DUPLICATE_H
+#define DUPLICATE_H
+
+#include "scrabble.h"
+#include "movegen.h"
+#include "openings.h"
+#include "threadpool.h"
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Most players one duplicate game can seat
+#define MAX_DUPLICATE_PLAYERS 4096
+
+// Submissions checked by one task; a task copies the position once for all of them
+#define SUBMISSIONS_PER_TASK 32
+
+// Board lines searched by one task looking for the round's top
+#define LINES_PER_SEARCH_TASK 3
+
+// Rounds in a row the rack may be redrawn for having no placement before the game ends
+#define MAX_DUPLICATE_REDRAWS 3
+
+// In duplicate every player gets the same rack on the same board. Players submit a placement each round;
+// each is scored as if it were played, and then the highest scoring placement the generator finds (the
+// top) is played for everyone, so the board and the rack never depend on what the players chose. A
+// player's total is the sum of the scores of their submissions, compared with the sum of the tops.
+//
+// The position is kept in a Game whose first player holds the round's rack; the second player's rack
+// stays empty.
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents how a submission was judged
+typedef enum
+{
+    SubmissionValid,               // Scored and credited
+    SubmissionIllegal,             // Tiles not on the rack, or squares that are not a placement
+    SubmissionInvalidWord,         // Forms a word missing from the lexicon
+    SubmissionRepeated,            // Valid, but a valid submission of the same player came first
+    SubmissionNoSeat,              // Names a player the game does not seat
+} SubmissionResult;
+
+// Represents one player's placement for a round
+typedef struct
+{
+    // Input
+    int player;                    // Seat of the player, from 0
+    Move move;                     // Tiles laid; its score is ignored
+
+    // Output
+    SubmissionResult result;
+    int score;                     // Points credited, 0 unless the submission is valid
+} Submission;
+
+// Represents a duplicate game and the totals of its players
+typedef struct
+{
+    Game game;                     // Board, bag and, as player one's letters, the round's rack
+    int numPlayers;
+    int* scores;                   // Total of each player
+    int topTotal;                  // Total of the tops played so far
+    int round;                     // Rounds played, tops or redraws
+    int redraws;                   // Redraws since the last top was played
+    const OpeningTable* openings;  // Answers the first round without a search, or NULL
+} DuplicateGame;
+
+// Represents the outcome of one round
+typedef struct
+{
+    bool played;                   // A top was found and played; false if the rack was redrawn
+    Move top;                      // Placement played for everyone
+    int numValid;                  // Submissions credited
+    int bestSubmitted;             // Highest score credited to a player this round
+} DuplicateRound;
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Starts a duplicate game for a number of players, drawing the first rack from a bag shuffled by the seed
+void initDuplicateGame(DuplicateGame* dup, const Lexicon* lexicon, unsigned long long seed, int numPlayers);
+
+// Frees the totals of a duplicate game
+void freeDuplicateGame(DuplicateGame* dup);
+
+// Judges and scores a submission against the position without changing it; 'scratch' is a copy of the
+// position whose tiles are laid and lifted again
+SubmissionResult judgeSubmission(const DuplicateGame* dup, Game* scratch, const Move* move, int* score);
+
+// Plays a round: judges every submission on the pool's threads while they search the top, credits the
+// valid ones, then plays the top and draws the next rack. With no placement on the board the rack is
+// redrawn instead, and the game ends once the bag is empty or the redraws run out
+void playDuplicateRound(DuplicateGame* dup, Submission submissions[], int numSubmissions, ThreadPool* pool,
+                        DuplicateRound* round);
+
+#endif // DUPLICATE_H
@@ -0,0 +1,625 @@
+// gcg.c
+
+#include "gcg.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// Longest GCG line read
+#define GCG_LINE_LENGTH 512
+
+// --------------------
+// Parsing Helpers
+// --------------------
+
+// Copies at most size - 1 characters of a string
+static void copyField(char* destination, const char* source, size_t size)
+{
+    size_t length = strlen(source);
+    if (length >= size)
+    {
+        length = size - 1;
+    }
+    memcpy(destination, source, length);
+    destination[length] = '\0';
+}
+
+// Converts GCG tile text into letter codes, lowercase letters as blanks and '?' as an unassigned blank;
+// returns false on anything else
+static bool parseTiles(const char* field, char* codes, size_t size)
+{
+    size_t length = 0;
+    const char* c = field;
+    while (*c != '\0')
+    {
+        char letter = parseLetter(&c);
+        if (letter == 0 || length + 1 >= size)
+        {
+            return false;
+        }
+        codes[length++] = letter;
+    }
+    codes[length] = '\0';
+    return true;
+}
+
+// Finds the player a nickname belongs to, registering it if the file did not declare it
+static int findPlayer(GcgGame* gcg, const char* nickname)
+{
+    for (int player = 0; player < 2; player++)
+    {
+        if (strcmp(gcg->nicknames[player], nickname) == 0)
+        {
+            return player;
+        }
+    }
+    for (int player = 0; player < 2; player++)
+    {
+        if (gcg->nicknames[player][0] == '\0')
+        {
+            copyField(gcg->nicknames[player], nickname, GCG_NAME_LENGTH);
+            return player;
+        }
+    }
+    return -1;
+}
+
+// Parses a position such as "8H" (row 8, across) or "H8" (column H, down)
+static bool parsePosition(const char* field, GcgMove* move)
+{
+    int row = 0, column = -1;
+    const char* c = field;
+
+    move->horizontal = isdigit((unsigned char)*c);
+    if (!move->horizontal)
+    {
+        column = toupper((unsigned char)*c++) - 'A';
+    }
+    while (isdigit((unsigned char)*c))
+    {
+        row = row * 10 + (*c++ - '0');
+    }
+    if (move->horizontal)
+    {
+        column = toupper((unsigned char)*c++) - 'A';
+    }
+
+    move->row = row - 1;
+    move->column = column;
+    return *c == '\0' && move->row >= 0 && move->row < LENGTH && move->column >= 0 && move->column < LENGTH;
+}
+
+// Parses a played word into letter codes, turning "(..)" groups into '.' for letters already on the board
+static bool parseWord(const char* field, GcgMove* move)
+{
+    int length = 0;
+    bool onBoard = false;
+    const char* c = field;
+    while (*c != '\0')
+    {
+        if (*c == '(' || *c == ')')
+        {
+            onBoard = (*c++ == '(');
+            continue;
+        }
+        char letter = (*c == '.') ? *c++ : parseLetter(&c);
+        if (length == LENGTH || letter == 0)
+        {
+            return false;
+        }
+        move->word[length++] = onBoard ? '.' : letter;
+    }
+    move->word[length] = '\0';
+    return length > 0;
+}
+
+// Parses the fields of a move line after the nickname
+static bool parseMoveFields(char* fields[], int numFields, GcgMove* move)
+{
+    memset(move->rack, 0, sizeof(move->rack));
+    move->word[0] = '\0';
+    move->exchanged[0] = '\0';
+    move->label[0] = '\0';
+
+    // Points from the opponent's rack at the end: "(RACK) +score total"
+    if (numFields == 3 && fields[0][0] == '(')
+    {
+        move->type = Gcg_Adjustment;
+        fields[0][strcspn(fields[0], ")")] = '\0';
+        move->score = atoi(fields[1]);
+        move->total = atoi(fields[2]);
+        return parseTiles(fields[0] + 1, move->rack, sizeof(move->rack));
+    }
+
+    // Some files leave out the rack of a pass or an exchange
+    int first = (fields[0][0] == '-') ? 0 : 1;
+    if (first == 1 && !parseTiles(fields[0], move->rack, sizeof(move->rack)))
+    {
+        return false;
+    }
+    if (numFields - first < 3)
+    {
+        return false;
+    }
+
+    const char* action = fields[first];
+    move->score = atoi(fields[numFields - 2]);
+    move->total = atoi(fields[numFields - 1]);
+
+    if (strcmp(action, "--") == 0)
+    {
+        move->type = Gcg_Withdrawn;
+    }
+    else if (strcmp(action, "-") == 0)
+    {
+        move->type = Gcg_Pass;
+    }
+    else if (action[0] == '-')
+    {
+        move->type = Gcg_Exchange;
+        if (!parseTiles(action + 1, move->exchanged, sizeof(move->exchanged)))
+        {
+            return false;
+        }
+    }
+    else if (action[0] == '(')
+    {
+        move->type = Gcg_Adjustment;
+        copyField(move->label, action + 1, sizeof(move->label));
+        move->label[strcspn(move->label, ")")] = '\0';
+    }
+    else
+    {
+        move->type = Gcg_Play;
+        return numFields - first == 4 && parsePosition(action, move) && parseWord(fields[first + 1], move);
+    }
+    return numFields - first == 3;
+}
+
+// --------------------
+// Import and Export Functions
+// --------------------
+
+// Parses GCG text from a stream; 'source' names it in error messages
+bool parseGcg(FILE* file, const char* source, GcgGame* gcg)
+{
+    memset(gcg->nicknames, 0, sizeof(gcg->nicknames));
+    memset(gcg->names, 0, sizeof(gcg->names));
+    gcg->numMoves = 0;
+
+    char line[GCG_LINE_LENGTH];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        lineNumber++;
+        line[strcspn(line, "\r\n")] = '\0';
+
+        // Player declarations: "#player1 nick Full Name"
+        if (strncmp(line, "#player", 7) == 0 && (line[7] == '1' || line[7] == '2') && line[8] == ' ')
+        {
+            int player = line[7] - '1';
+            char* nickname = line + 9;
+            char* name = strchr(nickname, ' ');
+            if (name != NULL)
+            {
+                *name++ = '\0';
+                copyField(gcg->names[player], name, GCG_NAME_LENGTH);
+            }
+            copyField(gcg->nicknames[player], nickname, GCG_NAME_LENGTH);
+            continue;
+        }
+        if (line[0] != '>')
+        {
+            continue; // Notes, titles and other pragmas
+        }
+
+        char* colon = strchr(line, ':');
+        if (colon == NULL || gcg->numMoves == GCG_MAX_MOVES)
+        {
+            fprintf(stderr, "%s:%d: malformed move line\n", source, lineNumber);
+            return false;
+        }
+        *colon = '\0';
+
+        char* fields[8];
+        int numFields = 0;
+        char* savePointer;
+        for (char* field = strtok_r(colon + 1, " \t", &savePointer); field != NULL && numFields < 8;
+             field = strtok_r(NULL, " \t", &savePointer))
+        {
+            fields[numFields++] = field;
+        }
+
+        GcgMove* move = &gcg->moves[gcg->numMoves];
+        move->player = findPlayer(gcg, line + 1);
+        if (move->player < 0 || numFields < 3 || !parseMoveFields(fields, numFields, move))
+        {
+            fprintf(stderr, "%s:%d: malformed move line\n", source, lineNumber);
+            return false;
+        }
+        gcg->numMoves++;
+    }
+    return true;
+}
+
+// Parses a GCG file; returns false and prints the line on a malformed file
+bool readGcgFile(const char* filename, GcgGame* gcg)
+{
+    FILE* file = fopen(filename, "r");
+    if (!file)
+    {
+        perror("Error opening GCG file");
+        return false;
+    }
+    bool parsed = parseGcg(file, filename, gcg);
+    fclose(file);
+    return parsed;
+}
+
+// Checks if a tile's text would be read together with the next tile's, as "L" and "L" make "LL"
+static bool joinsNextTile(const char* code)
+{
+    if (!isLetterCode(tileLetter(code[0])) || !isLetterCode(tileLetter(code[1])))
+    {
+        return false;
+    }
+    char pair[2 * LETTER_TEXT_SIZE];
+    snprintf(pair, sizeof(pair), "%s%s", letterText(code[0]), letterText(code[1]));
+    const char* c = pair;
+    return parseLetter(&c) != code[0];
+}
+
+// Writes letter codes as GCG text: digraph tiles, and single tiles that would read as one with the next,
+// in brackets; '.' and '?' as they are
+void formatGcgTiles(const char* codes, char* text, size_t size)
+{
+    size_t length = 0;
+    for (const char* code = codes; *code != '\0'; code++)
+    {
+        char tile[8];
+        if (isDigraph(tileLetter(*code)) || joinsNextTile(code))
+        {
+            snprintf(tile, sizeof(tile), "[%s]", letterText(*code));
+        }
+        else if (isLetterCode(tileLetter(*code)) || *code == BLANK_TILE)
+        {
+            snprintf(tile, sizeof(tile), "%s", letterText(*code));
+        }
+        else
+        {
+            snprintf(tile, sizeof(tile), "%c", *code);
+        }
+        size_t tileLength = strlen(tile);
+        if (length + tileLength >= size)
+        {
+            break;
+        }
+        memcpy(text + length, tile, tileLength);
+        length += tileLength;
+    }
+    text[length] = '\0';
+}
+
+// Writes a game as GCG text
+void writeGcg(FILE* file, const GcgGame* gcg)
+{
+    for (int player = 0; player < 2; player++)
+    {
+        fprintf(file, "#player%d %s %s\n", player + 1, gcg->nicknames[player],
+                gcg->names[player][0] ? gcg->names[player] : gcg->nicknames[player]);
+    }
+
+    for (int i = 0; i < gcg->numMoves; i++)
+    {
+        const GcgMove* move = &gcg->moves[i];
+        const char* nickname = gcg->nicknames[move->player];
+        char rack[GCG_TEXT_LENGTH], word[GCG_TEXT_LENGTH], exchanged[GCG_TEXT_LENGTH];
+        formatGcgTiles(move->rack, rack, sizeof(rack));
+        formatGcgTiles(move->word, word, sizeof(word));
+        formatGcgTiles(move->exchanged, exchanged, sizeof(exchanged));
+        switch (move->type)
+        {
+        case Gcg_Play:
+            if (move->horizontal)
+            {
+                fprintf(file, ">%s: %s %d%c %s %+d %d\n", nickname, rack, move->row + 1, 'A' + move->column,
+                        word, move->score, move->total);
+            }
+            else
+            {
+                fprintf(file, ">%s: %s %c%d %s %+d %d\n", nickname, rack, 'A' + move->column, move->row + 1,
+                        word, move->score, move->total);
+            }
+            break;
+        case Gcg_Exchange:
+            fprintf(file, ">%s: %s -%s %+d %d\n", nickname, rack, exchanged, move->score, move->total);
+            break;
+        case Gcg_Pass:
+            fprintf(file, ">%s: %s - %+d %d\n", nickname, rack, move->score, move->total);
+            break;
+        case Gcg_Withdrawn:
+            fprintf(file, ">%s: %s -- %+d %d\n", nickname, rack, move->score, move->total);
+            break;
+        case Gcg_Adjustment:
+            if (move->label[0] == '\0')
+            {
+                fprintf(file, ">%s: (%s) %+d %d\n", nickname, rack, move->score, move->total);
+            }
+            else
+            {
+                fprintf(file, ">%s: %s (%s) %+d %d\n", nickname, rack, move->label, move->score, move->total);
+            }
+            break;
+        }
+    }
+}
+
+// Describes a placement as a GCG play; 'game' is the position before the tiles are laid
+void describeGcgPlay(const Game* game, const Coordinate squares[], const char letters[], int numLetters,
+                     GcgMove* move)
+{
+    // A single tile is written along the word it extends, across when it extends both
+    bool horizontal;
+    if (numLetters > 1)
+    {
+        horizontal = squares[0].y == squares[1].y;
+    }
+    else
+    {
+        int x = squares[0].x, y = squares[0].y;
+        bool vertical = (y > 0 && game->board[y - 1][x].is_placed) || (y < LENGTH - 1 && game->board[y + 1][x].is_placed);
+        bool across = (x > 0 && game->board[y][x - 1].is_placed) || (x < LENGTH - 1 && game->board[y][x + 1].is_placed);
+        horizontal = across || !vertical;
+    }
+
+    int line = horizontal ? squares[0].y : squares[0].x;
+    int first = LENGTH, last = -1;
+    char laid[LENGTH] = {0};
+    for (int i = 0; i < numLetters; i++)
+    {
+        int pos = horizontal ? squares[i].x : squares[i].y;
+        laid[pos] = letters[i];
+        first = (pos < first) ? pos : first;
+        last = (pos > last) ? pos : last;
+    }
+
+    // Stretch the word over the letters already on the board at both ends
+    while (first > 0 && (horizontal ? game->board[line][first - 1] : game->board[first - 1][line]).is_placed)
+    {
+        first--;
+    }
+    while (last < LENGTH - 1 && (horizontal ? game->board[line][last + 1] : game->board[last + 1][line]).is_placed)
+    {
+        last++;
+    }
+
+    move->type = Gcg_Play;
+    move->horizontal = horizontal;
+    move->row = horizontal ? line : first;
+    move->column = horizontal ? first : line;
+    int length = 0;
+    for (int pos = first; pos <= last; pos++)
+    {
+        move->word[length++] = laid[pos] ? laid[pos] : '.';
+    }
+    move->word[length] = '\0';
+}
+
+// Writes a placement in GCG notation ("8H WORD"), or "-" when no tile is laid
+void formatGcgPlacement(const Game* game, const Move* move, char* text, size_t size)
+{
+    if (move->numLetters == 0)
+    {
+        snprintf(text, size, "-");
+        return;
+    }
+
+    GcgMove gcg;
+    char word[GCG_TEXT_LENGTH];
+    describeGcgPlay(game, move->squares, move->letters, move->numLetters, &gcg);
+    formatGcgTiles(gcg.word, word, sizeof(word));
+    if (gcg.horizontal)
+    {
+        snprintf(text, size, "%d%c %s", gcg.row + 1, 'A' + gcg.column, word);
+    }
+    else
+    {
+        snprintf(text, size, "%c%d %s", 'A' + gcg.column, gcg.row + 1, word);
+    }
+}
+
+// Writes the tiles of a rack as GCG text, skipping its empty slots
+void formatGcgRack(const char letters[MAX_LETTERS], char* text, size_t size)
+{
+    char codes[MAX_LETTERS + 1];
+    int length = 0;
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        if (letters[i] != '\0')
+        {
+            codes[length++] = letters[i];
+        }
+    }
+    codes[length] = '\0';
+    formatGcgTiles(codes, text, size);
+}
+
+// --------------------
+// Replay Functions
+// --------------------
+
+// Applies a move to the game, scoring plays with the engine instead of trusting the file
+int makeGcgMove(Game* game, const GcgMove* move, GcgUndo* undo)
+{
+    Player* player = (move->player == 0) ? &game->player1 : &game->player2;
+
+    undo->numSquares = 0;
+    undo->player = move->player;
+    undo->scoreChange = 0;
+    undo->turn = game->turn;
+    memcpy(undo->rack, player->letters, MAX_LETTERS);
+
+    // The rack the file shows becomes the player's rack
+    if (move->type != Gcg_Adjustment && move->rack[0] != '\0')
+    {
+        memset(player->letters, '\0', MAX_LETTERS);
+        for (int i = 0; i < MAX_LETTERS && move->rack[i]; i++)
+        {
+            player->letters[i] = move->rack[i];
+        }
+    }
+
+    int result = 0;
+    switch (move->type)
+    {
+    case Gcg_Play:
+    {
+        int dx = move->horizontal ? 1 : 0;
+        int dy = move->horizontal ? 0 : 1;
+        int length = strlen(move->word);
+        if ((move->horizontal ? move->column : move->row) + length > LENGTH)
+        {
+            result = GCG_MISFIT;
+            break;
+        }
+
+        // Check the whole word first so a misfit leaves the board untouched
+        for (int i = 0; i < length; i++)
+        {
+            const Piece* square = &game->board[move->row + i * dy][move->column + i * dx];
+            bool throughLetter = move->word[i] == '.' || (square->is_placed && square->letter == tileLetter(move->word[i]));
+            if (throughLetter != square->is_placed || (!throughLetter && undo->numSquares == MAX_LETTERS))
+            {
+                result = GCG_MISFIT;
+                break;
+            }
+            if (!throughLetter)
+            {
+                undo->squares[undo->numSquares++] = (Coordinate){move->column + i * dx, move->row + i * dy};
+            }
+        }
+        if (result == GCG_MISFIT || undo->numSquares == 0)
+        {
+            undo->numSquares = 0;
+            result = GCG_MISFIT;
+            break;
+        }
+
+        for (int i = 0, laid = 0; i < length; i++)
+        {
+            if (laid < undo->numSquares && undo->squares[laid].x == move->column + i * dx &&
+                undo->squares[laid].y == move->row + i * dy)
+            {
+                setSquare(game, undo->squares[laid].x, undo->squares[laid].y, move->word[i]);
+                laid++;
+            }
+        }
+
+        result = validateAndScoreWords(game, undo->squares, undo->numSquares);
+        undo->scoreChange = result > 0 ? result : 0;
+        break;
+    }
+    case Gcg_Adjustment:
+        undo->scoreChange = move->score;
+        result = move->score;
+        break;
+    case Gcg_Exchange:
+    case Gcg_Pass:
+    case Gcg_Withdrawn:
+        break;
+    }
+
+    player->score += undo->scoreChange;
+
+    // Adjustments are not turns
+    if (move->type != Gcg_Adjustment)
+    {
+        game->turn = (move->player == 0) ? Player2 : Player1;
+    }
+    return result;
+}
+
+// Takes back a move laid with makeGcgMove
+void unmakeGcgMove(Game* game, const GcgUndo* undo)
+{
+    Player* player = (undo->player == 0) ? &game->player1 : &game->player2;
+
+    for (int i = 0; i < undo->numSquares; i++)
+    {
+        setSquare(game, undo->squares[i].x, undo->squares[i].y, '\0');
+    }
+    player->score -= undo->scoreChange;
+    memcpy(player->letters, undo->rack, MAX_LETTERS);
+    game->turn = undo->turn;
+}
+
+// Appends a word to the list, marked with '*' if the lexicon does not have it; returns true if missing
+static bool appendWord(const Game* game, const char* word, char* words, size_t wordsSize)
+{
+    char lookup[LENGTH + 1];
+    int length = 0;
+    for (; word[length] != '\0'; length++)
+    {
+        lookup[length] = tileLetter(word[length]);
+    }
+    lookup[length] = '\0';
+    bool missing = !isValidWord(game->lexicon, lookup);
+
+    char text[GCG_TEXT_LENGTH];
+    formatGcgTiles(word, text, sizeof(text));
+    size_t used = strlen(words);
+    snprintf(words + used, wordsSize - used, "%s%s%s", used ? " " : "", missing ? "*" : "", text);
+    return missing;
+}
+
+// Collects the words a laid move formed, marking with '*' those missing from the lexicon
+int listGcgWords(const Game* game, const GcgUndo* undo, char* words, size_t wordsSize)
+{
+    int missing = 0;
+    int spans[2 * MAX_LETTERS][3];
+    int numSpans = 0;
+    words[0] = '\0';
+
+    for (int i = 0; i < undo->numSquares; i++)
+    {
+        for (int direction = 0; direction < 2; direction++)
+        {
+            int dx = direction == 0 ? 1 : 0;
+            int dy = direction == 0 ? 0 : 1;
+            int x = undo->squares[i].x, y = undo->squares[i].y;
+            while (x - dx >= 0 && y - dy >= 0 && game->board[y - dy][x - dx].is_placed)
+            {
+                x -= dx;
+                y -= dy;
+            }
+
+            // Several laid tiles share the main word
+            bool seen = false;
+            for (int s = 0; s < numSpans && !seen; s++)
+            {
+                seen = spans[s][0] == x && spans[s][1] == y && spans[s][2] == direction;
+            }
+            if (seen)
+            {
+                continue;
+            }
+
+            char word[LENGTH + 1];
+            int length = 0;
+            for (int xi = x, yi = y; xi < LENGTH && yi < LENGTH && game->board[yi][xi].is_placed; xi += dx, yi += dy)
+            {
+                word[length++] = (char)(game->board[yi][xi].letter | (game->board[yi][xi].is_blank ? BLANK_TILE : 0));
+            }
+            word[length] = '\0';
+            if (length > 1)
+            {
+                spans[numSpans][0] = x;
+                spans[numSpans][1] = y;
+                spans[numSpans][2] = direction;
+                numSpans++;
+                missing += appendWord(game, word, words, wordsSize) ? 1 : 0;
+            }
+        }
+    }
+    return missing;
+}
@@ -0,0 +1,144 @@
+// gcg.h
+
+#ifndef GCG_H
+#define GCG_H
+
+#include "scrabble.h"
+#include "movegen.h"
+#include <stdio.h>
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Largest number of moves kept per game
+#define GCG_MAX_MOVES 256
+
+// Longest player nickname or name kept
+#define GCG_NAME_LENGTH 64
+
+// Returned by makeGcgMove when a play does not fit the board
+#define GCG_MISFIT -2
+
+// Longest text formatGcgTiles writes for a word, terminator included
+#define GCG_TEXT_LENGTH (4 * LENGTH + 1)
+
+// Longest text formatGcgPlacement writes: a coordinate, a space and a word, terminator included
+#define GCG_PLACEMENT_LENGTH (GCG_TEXT_LENGTH + 16)
+
+// GCG is the annotated game text format used by tournament software:
+//
+//   #player1 <nick> <full name>
+//   #player2 <nick> <full name>
+//   >nick: RACK 8H WORD +score total      play; "8H" is row 8 column H across, "H8" column H down;
+//                                          '.' or "(..)" mark letters already on the board
+//   >nick: RACK -TILES +0 total           exchange ("-" alone is a pass)
+//   >nick: RACK -- -score total           the previous play was challenged off
+//   >nick: (RACK) +score total            points from the opponent's rack at the end
+//   >nick: RACK (challenge) +5 total      other score adjustments: (challenge), (time), ...
+//
+// Other '#' lines are kept out of the model. Lowercase letters in a word are blanks. The digraph
+// tiles are written in brackets ("[CH]", "[LL]", "[RR]"), as are single tiles that would otherwise read
+// as one ("[L]L" is two L tiles), and Ñ in UTF-8; unbracketed "CH", "LL" and "RR" are read as digraph
+// tiles too. The model holds letter codes, not text.
+
+// --------------------
+// Enumerations
+// --------------------
+
+// Represents the kind of a GCG move line
+typedef enum
+{
+    Gcg_Play,                      // Tiles laid on the board
+    Gcg_Exchange,                  // Tiles swapped with the bag
+    Gcg_Pass,                      // The turn passed without playing
+    Gcg_Withdrawn,                 // The previous play was challenged off the board
+    Gcg_Adjustment,                // Points added or removed without a move (end rack, challenge, time)
+} GcgMoveType;
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents one move line of a GCG file
+typedef struct
+{
+    GcgMoveType type;
+    int player;                              // 0 or 1
+    char rack[MAX_LETTERS + 2];              // Rack before the move ('?' for a blank), or the counted rack, in letter codes
+    int row;                                 // Row of the first letter of the word (Play)
+    int column;                              // Column of the first letter of the word (Play)
+    bool horizontal;                         // Direction of the word (Play)
+    char word[LENGTH + 1];                   // Word in letter codes, '.' for letters already on the board (Play)
+    char exchanged[MAX_LETTERS + 1];         // Tiles swapped (Exchange)
+    char label[16];                          // Reason of an adjustment, empty for end rack points (Adjustment)
+    int score;                               // Points of the line, negative for a withdrawn play
+    int total;                               // Player's total after the line
+} GcgMove;
+
+// Represents a whole GCG game
+typedef struct
+{
+    char nicknames[2][GCG_NAME_LENGTH];
+    char names[2][GCG_NAME_LENGTH];
+    GcgMove moves[GCG_MAX_MOVES];
+    int numMoves;
+} GcgGame;
+
+// Represents what a move changed, so it can be taken back
+typedef struct
+{
+    Coordinate squares[MAX_LETTERS];         // Squares the move covered
+    int numSquares;
+    int player;                              // Player whose score changed
+    int scoreChange;                         // Points the move added
+    PlayerTurn turn;                         // Turn before the move
+    char rack[MAX_LETTERS];                  // Player's rack before the move
+} GcgUndo;
+
+// --------------------
+// Import and Export Functions
+// --------------------
+
+// Parses a GCG file; returns false and prints the line on a malformed file
+bool readGcgFile(const char* filename, GcgGame* gcg);
+
+// Parses GCG text from a stream; 'source' names it in error messages
+bool parseGcg(FILE* file, const char* source, GcgGame* gcg);
+
+// Writes a game as GCG text
+void writeGcg(FILE* file, const GcgGame* gcg);
+
+// Writes letter codes as GCG text: digraph tiles, and single tiles that would read as one with the next,
+// in brackets; '.' and '?' as they are
+void formatGcgTiles(const char* codes, char* text, size_t size);
+
+// Describes a placement as a GCG play; 'game' is the position before the tiles are laid
+void describeGcgPlay(const Game* game, const Coordinate squares[], const char letters[], int numLetters,
+                     GcgMove* move);
+
+// Writes a placement in GCG notation ("8H WORD"), or "-" when no tile is laid; 'game' is the position
+// before the tiles are laid
+void formatGcgPlacement(const Game* game, const Move* move, char* text, size_t size);
+
+// Writes the tiles of a rack as GCG text, skipping its empty slots
+void formatGcgRack(const char letters[MAX_LETTERS], char* text, size_t size);
+
+// --------------------
+// Replay Functions
+// --------------------
+
+// Applies a move to the game, scoring plays with the engine instead of trusting the file.
+// Returns the points added, -1 for a play forming a word missing from the lexicon (laid anyway and
+// scored 0, so it can be audited) or GCG_MISFIT for a play that does not fit the board (nothing laid).
+// A withdrawn line only passes the turn; the caller takes the previous play back first
+int makeGcgMove(Game* game, const GcgMove* move, GcgUndo* undo);
+
+// Takes back a move laid with makeGcgMove
+void unmakeGcgMove(Game* game, const GcgUndo* undo);
+
+// Collects the words a laid move formed, as GCG text separated by spaces, marking with '*' those missing
+// from the lexicon; returns the number of missing words
+int listGcgWords(const Game* game, const GcgUndo* undo, char* words, size_t wordsSize);
+
+#endif // GCG_H
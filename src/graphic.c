@@ -1,8 +1,14 @@
 // graphic.c
 
 #include <raylib.h>
+#include <rlgl.h>
 #include "raygui.h"
 #include "graphic.h"
+#include "worker.h"
+#include "openings.h"
+#include "preview.h"
+#include "profiler.h"
+#include "record.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -11,29 +17,60 @@
 // Define the global scaled dimensions
 ScaledDimensions scaled;
 
-// Global variables for resources
+// Global variables for resources shared by every session drawn in the window
 Font gameFont;
+Texture2D letterAtlas;                    // Pre-rendered letter tiles, one column per letter and one row per sprite
 
-// Variables for gameplay
-int selectedIndex = -1;
-char playerLetters[MAX_LETTERS] = {0};
-int currentAxis = 0;
-WordDirection currentDirection = Still_None;
-Coordinate lettersCoordinates[MAX_LETTERS];
-char placedLetters[MAX_LETTERS] = {0};
-int numPlacedLetters = 0;
-bool isInvalidMove = false; // Variable to track invalid moves
+// Window state
+bool waitingForEvents = false; // Frames are only produced when input arrives
+bool showProfiler = false;  // The timing overlay is visible (toggled with F3)
 
-Game clone;
+// Represents one game played in the window: the working copy of the game, the move in progress,
+// its hints and its cached board. Nothing here is global, so several sessions can coexist
+struct GuiSession
+{
+    Game* game;                               // Committed game state
+    Game clone;                               // Working copy where the move in progress is laid
+    RecordWriter* recorder;                   // Log the committed events are appended to, or NULL
+    bool gameChanged;                         // The committed game changed and the working copy must be refreshed
+
+    // Variables for gameplay
+    int selectedIndex;
+    char blankLetter;                         // Letter typed for the selected blank, 0 until one is typed
+    char playerLetters[MAX_LETTERS];
+    unsigned int exchangeSlots;               // Rack slots marked with a right click to be exchanged
+    int currentAxis;
+    WordDirection currentDirection;
+    Coordinate lettersCoordinates[MAX_LETTERS];
+    char placedLetters[MAX_LETTERS];
+    int numPlacedLetters;
+    bool isInvalidMove;                       // Variable to track invalid moves
+    ScorePreview preview;                     // Running score of the tiles placed this turn
+
+    // Variables for hints searched in the background
+    SearchWorker searchWorker;
+    MoveCache* hintCache;                     // Move lists of the positions hints were searched in
+    OpeningTable* openings;                   // Best openings of every rack, or NULL
+    bool hasHint;                             // A hint is ready to be shown for the current turn
+    bool hintNotFound;                        // The last hint search found no legal placement
+    Move hintMove;
+
+    // Cached board drawing
+    RenderTexture2D boardTexture;             // Cached image of the board tiles
+    bool boardTextureReady;                   // The cached board holds every tile
+    char drawnLetters[LENGTH][LENGTH];        // Tile each cached square shows ('\0' for an empty square)
+    bool availableTiles[LENGTH][LENGTH];      // Squares that can take the selected letter
+    int availableCount;                       // Number of placed letters when availability was computed
+};
 
 // Initializes the graphical interface
 void initGraphics()
 {
     // Initialize scaled dimensions
     scaled.baseTileSize = 30;
-    scaled.tileSize = (int)(scaled.baseTileSize * SCALE_FACTOR); // 30 *1.7=51
+    scaled.tileSize = (int)(scaled.baseTileSize * SCALE_FACTOR * BOARD_SCALE); // 30 *1.7=51 on the 15 x 15 board
 
-    scaled.fontSizeLetter = (int)(20 * SCALE_FACTOR); // 34
+    scaled.fontSizeLetter = (int)(20 * SCALE_FACTOR * BOARD_SCALE); // 34 on the 15 x 15 board
     scaled.fontSizeSmall = (int)(8 * SCALE_FACTOR); // 14
     scaled.fontSizeLarge = (int)(12 * SCALE_FACTOR); // 20
     scaled.fontSizeScore = (int)(20 * SCALE_FACTOR); // 34
@@ -55,20 +92,59 @@ void initGraphics()
 
     // Initialize control panel dimensions
     scaled.controlAreaWidth = (int)(450 * SCALE_FACTOR); // 765
-    scaled.controlAreaX = scaled.offsetX + (15 * scaled.tileSize) + (50 * SCALE_FACTOR); // 85 + 15*51=765 +85=850
-    scaled.controlAreaX = 85 + 765 + 85; // 935
+    scaled.controlAreaX = scaled.offsetX + (LENGTH * scaled.tileSize) + scaled.offsetX; // 85 + 15*51=765 +85=935
     scaled.paddingBetweenElements = (int)(20 * SCALE_FACTOR); // 34
 
     // Initialize the window with scaled dimensions
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Scrabble Game");
-    SetTargetFPS(60);
+    SetTargetFPS(60); // Upper bound while frames are needed; when idle the loop sleeps on input events
     loadResources();
 }
 
+// Creates a session that plays the given game in the window; call after initGraphics
+GuiSession* createSession(Game* game, RecordWriter* recorder)
+{
+    GuiSession* session = calloc(1, sizeof(GuiSession));
+    if (!session)
+    {
+        perror("Error allocating session");
+        exit(EXIT_FAILURE);
+    }
+
+    session->game = game;
+    session->recorder = recorder;
+    session->gameChanged = true;
+    session->selectedIndex = -1;
+    session->currentDirection = Still_None;
+    resetScorePreview(&session->preview);
+
+    // The board is drawn once into a texture and then only tiles that change are redrawn
+    session->boardTexture = LoadRenderTexture(LENGTH * scaled.tileSize, LENGTH * scaled.tileSize);
+    session->boardTextureReady = false;
+    session->availableCount = -1;
+
+    // Start the thread that searches hints away from the render loop
+    session->hintCache = createMoveCache(HINT_CACHE_BYTES);
+    session->openings = mapOpeningTable(OPENING_TABLE_FILE, game->lexicon);
+    startWorker(&session->searchWorker, session->hintCache, session->openings);
+
+    return session;
+}
+
+// Stops the session's hint search and releases everything it owns
+void destroySession(GuiSession* session)
+{
+    stopWorker(&session->searchWorker);
+    freeMoveCache(session->hintCache);
+    freeOpeningTable(session->openings);
+    UnloadRenderTexture(session->boardTexture);
+    free(session);
+}
+
 // Checks if a move is currently being played
-bool beingPlay()
+bool beingPlay(const GuiSession* session)
 {
-    return numPlacedLetters != 0;
+    return session->numPlacedLetters != 0;
 }
 
 // Closes the graphical interface
@@ -82,183 +158,412 @@ void closeGraphics()
 void loadResources()
 {
     // Load a font for rendering text, scaled appropriately
-    gameFont = LoadFontEx(TextFormat("%sfonts/arial.ttf", ASSETS_PATH), scaled.fontSizeLetter, 0, 0);
+    // Printable ASCII plus Ñ and the ñ of a blank, the tiles outside it
+    int codepoints[97];
+    for (int c = 32; c < 127; c++)
+    {
+        codepoints[c - 32] = c;
+    }
+    codepoints[95] = 0xD1;
+    codepoints[96] = 0xF1;
+    gameFont = LoadFontEx(TextFormat("%sfonts/arial.ttf", ASSETS_PATH), scaled.fontSizeLetter, codepoints, 97);
 
-    // Load letter tile textures if available
-    // For simplicity, we use rectangle drawings
+    // Render every letter tile once so tiles are drawn as sprites afterwards
+    buildLetterAtlas();
 }
 
 // Unloads resources
 void unloadResources()
 {
     UnloadFont(gameFont);
-    // Unload other resources if loaded
+    UnloadTexture(letterAtlas);
 }
 
-// Draws the game board
-void drawBoard()
+// Draws a letter and its value into a tile rectangle, as used by the atlas
+static void drawLetterFace(char letter, Rectangle tileRect, Color color)
+{
+    // Digraph tiles fit their two letters in the width of one
+    const char* letterStr = letterText(letter);
+    float fontSize = isDigraph(tileLetter(letter)) ? scaled.fontSizeLetter * 0.7f : scaled.fontSizeLetter;
+    Vector2 textSize = MeasureTextEx(gameFont, letterStr, fontSize, 1);
+    Vector2 textPos = {
+        tileRect.x + (scaled.tileSize - textSize.x) / 2,
+        tileRect.y + (scaled.tileSize - textSize.y) / 2
+    };
+    DrawTextEx(gameFont, letterStr, textPos, fontSize, 1, color);
+
+    char value[5];
+    sprintf(value, "%d", getLetterScore(letter));
+
+    Vector2 valuePos = {
+        tileRect.x + scaled.tileSize - 6 * SCALE_FACTOR,
+        tileRect.y + scaled.tileSize - 8 * SCALE_FACTOR
+    };
+    DrawTextEx(gameFont, value, valuePos, scaled.fontSizeLetter / 3, 1, color);
+}
+
+// Returns the tile drawn in an atlas column: the letters, the unassigned blank, then the assigned blanks
+static char atlasTile(int index)
 {
-    Piece (*board)[15] = clone.board;
+    if (index < ALPHABET_SIZE)
+    {
+        return (char)(index + 1);
+    }
+    return (char)(BLANK_TILE | (index - ALPHABET_SIZE));
+}
+
+// Returns the atlas column of a tile, or -1 if it has none
+static int atlasIndex(char tile)
+{
+    if (isBlankTile(tile))
+    {
+        return ALPHABET_SIZE + tileLetter(tile);
+    }
+    return isLetterCode(tile) ? tile - 1 : -1;
+}
+
+// Renders every letter tile at the current tile size into the letter atlas
+void buildLetterAtlas()
+{
+    RenderTexture2D target = LoadRenderTexture(ATLAS_LETTERS * scaled.tileSize, Sprite_Count * scaled.tileSize);
+
+    BeginTextureMode(target);
+    ClearBackground((Color){255, 255, 255, 0});
+
+    // Keep straight alpha in the atlas: colors blend as usual but coverage accumulates,
+    // so glyph edges are not faded twice when the sprites are drawn
+    rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA,
+                              RL_FUNC_ADD, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+
+    for (int i = 0; i < ATLAS_LETTERS; i++)
+    {
+        char letter = atlasTile(i);
+
+        // Board sprite: white letter on a transparent tile, tinted when drawn
+        Rectangle boardRect = {
+            (float)(i * scaled.tileSize),
+            (float)(Sprite_Board * scaled.tileSize),
+            (float)scaled.tileSize,
+            (float)scaled.tileSize
+        };
+        drawLetterFace(letter, boardRect, WHITE);
+
+        // Rack sprite: the letter box as shown in the control panel
+        Rectangle rackRect = {
+            (float)(i * scaled.tileSize),
+            (float)(Sprite_Rack * scaled.tileSize),
+            (float)scaled.tileSize,
+            (float)scaled.tileSize
+        };
+        DrawRectangleRec(rackRect, BEIGE);
+        DrawRectangleLinesEx(rackRect, 2 * SCALE_FACTOR, BLACK);
+        drawLetterFace(letter, rackRect, BLACK);
+    }
+
+    EndBlendMode();
+    EndTextureMode();
+
+    // Render textures are stored upside down; flip once so sprites use top-left coordinates
+    Image atlasImage = LoadImageFromTexture(target.texture);
+    ImageFlipVertical(&atlasImage);
+    letterAtlas = LoadTextureFromImage(atlasImage);
+    UnloadImage(atlasImage);
+    UnloadRenderTexture(target);
+}
+
+// Draws a pre-rendered letter tile from the atlas
+static void drawLetterSprite(char letter, LetterSprite sprite, float x, float y, Color tint)
+{
+    int index = atlasIndex(letter);
+    if (index < 0 || index >= ATLAS_LETTERS)
+    {
+        return;
+    }
+
+    Rectangle source = {
+        (float)(index * scaled.tileSize),
+        (float)(sprite * scaled.tileSize),
+        (float)scaled.tileSize,
+        (float)scaled.tileSize
+    };
+    DrawTextureRec(letterAtlas, source, (Vector2){x, y}, tint);
+}
+
+// Draws the static content of one tile: multiplier color, star, placed letter or multiplier text
+static void drawTile(const Piece* piece, Rectangle tileRect)
+{
+    // Determine tile color based on multiplier
+    Color tileColor;
+    switch (piece->multiplier)
+    {
+    case Center:
+    case Double_Word:
+        tileColor = COLOR_DOUBLE_WORD;
+        break;
+    case Triple_Word:
+        tileColor = COLOR_TRIPLE_WORD;
+        break;
+    case Double_Letter:
+        tileColor = COLOR_DOUBLE_LETTER;
+        break;
+    case Triple_Letter:
+        tileColor = COLOR_TRIPLE_LETTER;
+        break;
+    case Quadruple_Word:
+        tileColor = COLOR_QUADRUPLE_WORD;
+        break;
+    case Quadruple_Letter:
+        tileColor = COLOR_QUADRUPLE_LETTER;
+        break;
+    default:
+        tileColor = COLOR_NORMAL;
+        break;
+    }
+
+    // Draw the tile rectangle
+    DrawRectangleRec(tileRect, tileColor);
+    DrawRectangleLinesEx(tileRect, 1 * SCALE_FACTOR, WHITE);
+
+    // Draw the center star if applicable
+    if (piece->multiplier == Center && !piece->is_placed)
+    {
+        // Calculate center of the tile
+        float cx = tileRect.x + scaled.tileSize / 2.0f;
+        float cy = tileRect.y + scaled.tileSize / 2.0f;
+
+        // Calculate star radius (adjusted to fit nicely)
+        float r = scaled.tileSize * 0.4f; // 51 *0.4=20.4
+
+        // Calculate 60-degree angle in radians
+        float angle60 = 60.0f * DEG2RAD;
+
+        // Define vertices for upward-pointing triangle
+        Vector2 p1 = {cx, cy - r};
+        Vector2 p2 = {cx - r * sinf(angle60), cy + r * cosf(angle60)};
+        Vector2 p3 = {cx + r * sinf(angle60), cy + r * cosf(angle60)};
+
+        // Define vertices for downward-pointing triangle
+        Vector2 p4 = {cx, cy + r};
+        Vector2 p5 = {cx - r * sinf(angle60), cy - r * cosf(angle60)};
+        Vector2 p6 = {cx + r * sinf(angle60), cy - r * cosf(angle60)};
+
+        // Draw upward-pointing triangle
+        DrawTriangle(p1, p2, p3, WHITE);
+
+        // Draw downward-pointing triangle
+        DrawTriangle(p5, p4, p6, WHITE);
+    }
+
+    // Draw the letter if it has been placed
+    if (piece->is_placed && piece->letter != '\0')
+    {
+        char tile = (char)(piece->letter | (piece->is_blank ? BLANK_TILE : 0));
+        drawLetterSprite(tile, Sprite_Board, tileRect.x, tileRect.y, BLACK);
+    }
+
+    // Draw multiplier text for special tiles if not placed
+    if (!piece->is_placed && piece->multiplier != None && piece->multiplier != Center)
+    {
+        const char* typeText = NULL;
+        int multiplierNumber = 1;
+
+        switch (piece->multiplier)
+        {
+        case Double_Word:
+            typeText = "Palabra";
+            multiplierNumber = 2;
+            break;
+        case Triple_Word:
+            typeText = "Palabra";
+            multiplierNumber = 3;
+            break;
+        case Double_Letter:
+            typeText = "Letra";
+            multiplierNumber = 2;
+            break;
+        case Triple_Letter:
+            typeText = "Letra";
+            multiplierNumber = 3;
+            break;
+        case Quadruple_Word:
+            typeText = "Palabra";
+            multiplierNumber = 4;
+            break;
+        case Quadruple_Letter:
+            typeText = "Letra";
+            multiplierNumber = 4;
+            break;
+        default:
+            break;
+        }
+
+        if (typeText != NULL)
+        {
+            // Define font sizes, smaller on the larger board
+            int fontSizeSmall = (int)(scaled.fontSizeSmall * BOARD_SCALE);
+            int fontSizeLarge = (int)(scaled.fontSizeLarge * BOARD_SCALE);
+            float spacing = 0.0f; // No additional spacing
+            float yOffset = 0.0f; // Adjust as needed
+
+            // Measure text sizes
+            Vector2 typeTextSize = MeasureTextEx(gameFont, typeText, fontSizeSmall, 1);
+            char multiplierStr[4]; // For "x2" to "x4"
+            snprintf(multiplierStr, sizeof(multiplierStr), "x%d", multiplierNumber);
+            Vector2 multiplierTextSize = MeasureTextEx(gameFont, multiplierStr, fontSizeLarge, 1);
+
+            // Calculate total text height
+            float totalTextHeight = typeTextSize.y + multiplierTextSize.y + spacing;
+
+            // Calculate initial position to center vertically
+            float textStartY = tileRect.y + (scaled.tileSize - totalTextHeight) / 2 + yOffset;
+
+            // Draw type text ("Palabra" or "Letra")
+            Vector2 typeTextPos = {
+                tileRect.x + (scaled.tileSize - typeTextSize.x) / 2,
+                textStartY
+            };
+            DrawTextEx(gameFont, typeText, typeTextPos, fontSizeSmall, 1, WHITE);
+
+            // Draw multiplier text below type text
+            Vector2 multiplierTextPos = {
+                tileRect.x + (scaled.tileSize - multiplierTextSize.x) / 2,
+                typeTextPos.y + typeTextSize.y + spacing
+            };
+            DrawTextEx(gameFont, multiplierStr, multiplierTextPos, fontSizeLarge, 1, WHITE);
+        }
+    }
+}
+
+// Redraws into the cached board texture only the tiles whose content changed since the last frame
+// Returns true if any tile was redrawn
+bool refreshBoardTexture(GuiSession* session)
+{
+    bool redrawn = false;
 
     for (int y = 0; y < LENGTH; y++)
     {
         for (int x = 0; x < LENGTH; x++)
         {
-            // Determine tile color based on multiplier
-            Color tileColor;
-            switch (board[y][x].multiplier)
+            const Piece* piece = &session->clone.board[y][x];
+            char content = piece->is_placed ? (char)(piece->letter | (piece->is_blank ? BLANK_TILE : 0)) : '\0';
+            if (session->boardTextureReady && session->drawnLetters[y][x] == content)
             {
-            case Center:
-            case Double_Word:
-                tileColor = COLOR_DOUBLE_WORD;
-                break;
-            case Triple_Word:
-                tileColor = COLOR_TRIPLE_WORD;
-                break;
-            case Double_Letter:
-                tileColor = COLOR_DOUBLE_LETTER;
-                break;
-            case Triple_Letter:
-                tileColor = COLOR_TRIPLE_LETTER;
-                break;
-            default:
-                tileColor = COLOR_NORMAL;
-                break;
+                continue;
+            }
+
+            if (!redrawn)
+            {
+                BeginTextureMode(session->boardTexture);
+                redrawn = true;
             }
 
-            // Draw the tile rectangle
+            // Tiles are drawn in texture space, where the board starts at the origin
             Rectangle tileRect = {
-                (float)(scaled.offsetX + x * scaled.tileSize),
-                (float)(scaled.offsetY + y * scaled.tileSize),
+                (float)(x * scaled.tileSize),
+                (float)(y * scaled.tileSize),
                 (float)scaled.tileSize,
                 (float)scaled.tileSize
             };
-            DrawRectangleRec(tileRect, tileColor);
-            DrawRectangleLinesEx(tileRect, 1 * SCALE_FACTOR, WHITE);
-
-            // Draw the center star if applicable
-            if (board[y][x].multiplier == Center && !board[y][x].is_placed)
-            {
-                // Calculate center of the tile
-                float cx = tileRect.x + scaled.tileSize / 2.0f;
-                float cy = tileRect.y + scaled.tileSize / 2.0f;
-
-                // Calculate star radius (adjusted to fit nicely)
-                float r = scaled.tileSize * 0.4f; // 51 *0.4=20.4
-
-                // Calculate 60-degree angle in radians
-                float angle60 = 60.0f * DEG2RAD;
+            drawTile(piece, tileRect);
+            session->drawnLetters[y][x] = content;
+        }
+    }
 
-                // Define vertices for upward-pointing triangle
-                Vector2 p1 = {cx, cy - r};
-                Vector2 p2 = {cx - r * sinf(angle60), cy + r * cosf(angle60)};
-                Vector2 p3 = {cx + r * sinf(angle60), cy + r * cosf(angle60)};
+    if (redrawn)
+    {
+        EndTextureMode();
+        session->boardTextureReady = true;
+    }
 
-                // Define vertices for downward-pointing triangle
-                Vector2 p4 = {cx, cy + r};
-                Vector2 p5 = {cx - r * sinf(angle60), cy - r * cosf(angle60)};
-                Vector2 p6 = {cx + r * sinf(angle60), cy - r * cosf(angle60)};
+    return redrawn;
+}
 
-                // Draw upward-pointing triangle
-                DrawTriangle(p1, p2, p3, WHITE);
+// Recomputes which squares can take the selected letter
+void refreshAvailableTiles(GuiSession* session)
+{
+    for (int y = 0; y < LENGTH; y++)
+    {
+        for (int x = 0; x < LENGTH; x++)
+        {
+            session->availableTiles[y][x] = getTempFunc(session, x, y);
+        }
+    }
+}
 
-                // Draw downward-pointing triangle
-                DrawTriangle(p5, p4, p6, WHITE);
-            }
+// Returns the screen rectangle of a board tile
+static Rectangle getTileRect(int x, int y)
+{
+    return (Rectangle){
+        (float)(scaled.offsetX + x * scaled.tileSize),
+        (float)(scaled.offsetY + y * scaled.tileSize),
+        (float)scaled.tileSize,
+        (float)scaled.tileSize
+    };
+}
 
-            // Draw the letter if it has been placed
-            if (board[y][x].is_placed && board[y][x].letter != '\0')
-            {
-                char letterStr[2] = {board[y][x].letter, '\0'};
-                Vector2 textSize = MeasureTextEx(gameFont, letterStr, scaled.fontSizeLetter, 1);
-                Vector2 textPos = {
-                    tileRect.x + (scaled.tileSize - textSize.x) / 2,
-                    tileRect.y + (scaled.tileSize - textSize.y) / 2
-                };
+// Finds the board tile under the mouse; returns false if the mouse is outside the board
+static bool getTileUnderMouse(int* x, int* y)
+{
+    Vector2 mouse = GetMousePosition();
+    int boardSize = LENGTH * scaled.tileSize;
 
-                char value[5];
-                DrawTextEx(gameFont, letterStr, textPos, scaled.fontSizeLetter, 1, BLACK);
+    if (mouse.x < scaled.offsetX || mouse.y < scaled.offsetY ||
+        mouse.x >= scaled.offsetX + boardSize || mouse.y >= scaled.offsetY + boardSize)
+    {
+        return false;
+    }
 
-                sprintf(value, "%d", getLetterScore(board[y][x].letter));
+    *x = (int)(mouse.x - scaled.offsetX) / scaled.tileSize;
+    *y = (int)(mouse.y - scaled.offsetY) / scaled.tileSize;
+    return true;
+}
 
-                Vector2 valuePos = {
-                    tileRect.x + scaled.tileSize - 6 * SCALE_FACTOR,
-                    tileRect.y + scaled.tileSize - 8 * SCALE_FACTOR
-                };
+// Draws the game board
+void drawBoard(GuiSession* session)
+{
+    // Bring the cached texture up to date; availability only changes when tiles do
+    if (refreshBoardTexture(session) || session->availableCount != session->numPlacedLetters)
+    {
+        refreshAvailableTiles(session);
+        session->availableCount = session->numPlacedLetters;
+    }
 
-                DrawTextEx(gameFont, value, valuePos, scaled.fontSizeLetter / 3, 1, BLACK);
-            }
+    // Draw the whole board as one quad; render textures are stored upside down.
+    // Tiles are opaque, so the texture is copied as is instead of blended with its own alpha
+    Rectangle source = {0, 0, (float)session->boardTexture.texture.width, (float)-session->boardTexture.texture.height};
+    rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM);
+    DrawTextureRec(session->boardTexture.texture, source, (Vector2){(float)scaled.offsetX, (float)scaled.offsetY}, WHITE);
+    EndBlendMode();
 
-            // Draw multiplier text for special tiles if not placed
-            if (!board[y][x].is_placed && board[y][x].multiplier != None && board[y][x].multiplier != Center)
+    // Show the suggested tiles of the hint on empty squares
+    if (session->hasHint)
+    {
+        for (int i = 0; i < session->hintMove.numLetters; i++)
+        {
+            int x = session->hintMove.squares[i].x;
+            int y = session->hintMove.squares[i].y;
+            if (session->clone.board[y][x].is_placed)
             {
-                const char* typeText = NULL;
-                int multiplierNumber = 1;
-
-                switch (board[y][x].multiplier)
-                {
-                case Double_Word:
-                    typeText = "Palabra";
-                    multiplierNumber = 2;
-                    break;
-                case Triple_Word:
-                    typeText = "Palabra";
-                    multiplierNumber = 3;
-                    break;
-                case Double_Letter:
-                    typeText = "Letra";
-                    multiplierNumber = 2;
-                    break;
-                case Triple_Letter:
-                    typeText = "Letra";
-                    multiplierNumber = 3;
-                    break;
-                default:
-                    break;
-                }
-
-                if (typeText != NULL)
-                {
-                    // Define font sizes
-                    int fontSizeSmall = scaled.fontSizeSmall;
-                    int fontSizeLarge = scaled.fontSizeLarge;
-                    float spacing = 0.0f; // No additional spacing
-                    float yOffset = 0.0f; // Adjust as needed
-
-                    // Measure text sizes
-                    Vector2 typeTextSize = MeasureTextEx(gameFont, typeText, fontSizeSmall, 1);
-                    char multiplierStr[4]; // For "x2" or "x3"
-                    snprintf(multiplierStr, sizeof(multiplierStr), "x%d", multiplierNumber);
-                    Vector2 multiplierTextSize = MeasureTextEx(gameFont, multiplierStr, fontSizeLarge, 1);
-
-                    // Calculate total text height
-                    float totalTextHeight = typeTextSize.y + multiplierTextSize.y + spacing;
-
-                    // Calculate initial position to center vertically
-                    float textStartY = tileRect.y + (scaled.tileSize - totalTextHeight) / 2 + yOffset;
-
-                    // Draw type text ("Palabra" or "Letra")
-                    Vector2 typeTextPos = {
-                        tileRect.x + (scaled.tileSize - typeTextSize.x) / 2,
-                        textStartY
-                    };
-                    DrawTextEx(gameFont, typeText, typeTextPos, fontSizeSmall, 1, WHITE);
-
-                    // Draw multiplier text below type text
-                    Vector2 multiplierTextPos = {
-                        tileRect.x + (scaled.tileSize - multiplierTextSize.x) / 2,
-                        typeTextPos.y + typeTextSize.y + spacing
-                    };
-                    DrawTextEx(gameFont, multiplierStr, multiplierTextPos, fontSizeLarge, 1, WHITE);
-                }
+                continue;
             }
 
-            // Check if the tile is available for placement
-            bool available = getTempFunc(x, y);
+            Rectangle tileRect = getTileRect(x, y);
+            drawLetterSprite(session->hintMove.letters[i], Sprite_Board, tileRect.x, tileRect.y, COLOR_HINT);
+            DrawRectangleLinesEx(tileRect, 2 * SCALE_FACTOR, DARKGREEN);
+        }
+    }
 
-            if (selectedIndex != -1)
+    // Shade the squares that cannot take the selected letter
+    if (session->selectedIndex != -1)
+    {
+        for (int y = 0; y < LENGTH; y++)
+        {
+            for (int x = 0; x < LENGTH; x++)
             {
-                if (!available)
+                Rectangle tileRect = getTileRect(x, y);
+                if (!session->availableTiles[y][x])
                 {
                     DrawRectangleRec(tileRect, COLOR_HOVER);
                 }
@@ -267,97 +572,117 @@ void drawBoard()
                     DrawRectangleLinesEx(tileRect, 1 * SCALE_FACTOR, GREEN);
                 }
             }
+        }
+    }
 
-            // Handle left mouse button press for placing a letter
-            if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && CheckCollisionPointRec(GetMousePosition(), tileRect) &&
-                available && selectedIndex != -1)
-            {
-                placeLetter(x, y);
-            }
+    // Highlight invalid placed letters with red border
+    if (session->isInvalidMove)
+    {
+        for (int i = 0; i < session->numPlacedLetters; i++)
+        {
+            DrawRectangleLinesEx(getTileRect(session->lettersCoordinates[i].x, session->lettersCoordinates[i].y), 2 * SCALE_FACTOR, RED);
+        }
+    }
+}
 
-            // Handle right mouse button press for unplacing the last letter
-            if (numPlacedLetters > 0)
-            {
-                Coordinate lastLetter = lettersCoordinates[numPlacedLetters - 1];
-                bool wannaErase = IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) &&
-                    CheckCollisionPointRec(GetMousePosition(), tileRect) && lastLetter.x == x && lastLetter.y == y &&
-                    selectedIndex == -1;
-                if (wannaErase)
-                {
-                    unplaceLastLetter();
-                }
-            }
+// Handles clicks on the tile under the mouse
+void handleBoardInput(GuiSession* session)
+{
+    int x, y;
+    if (getTileUnderMouse(&x, &y))
+    {
+        // Handle left mouse button press for placing a letter; a blank needs its letter typed first
+        bool ready = session->selectedIndex != -1 &&
+                     (session->playerLetters[session->selectedIndex] != BLANK_TILE || session->blankLetter != 0);
+        if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && session->availableTiles[y][x] && ready)
+        {
+            placeLetter(session, x, y);
+        }
 
-            // Highlight invalid placed letters with red border
-            if (isInvalidMove)
+        // Handle right mouse button press for unplacing the last letter
+        if (session->numPlacedLetters > 0)
+        {
+            Coordinate lastLetter = session->lettersCoordinates[session->numPlacedLetters - 1];
+            bool wannaErase = IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) && lastLetter.x == x && lastLetter.y == y &&
+                session->selectedIndex == -1;
+            if (wannaErase)
             {
-                for (int i = 0; i < numPlacedLetters; i++)
-                {
-                    if (lettersCoordinates[i].x == x && lettersCoordinates[i].y == y)
-                    {
-                        DrawRectangleLinesEx(tileRect, 2 * SCALE_FACTOR, RED);
-                        break;
-                    }
-                }
+                unplaceLastLetter(session);
             }
         }
     }
 }
 
 // Removes the last placed letter from the board and player’s letters
-void unplaceLastLetter()
+void unplaceLastLetter(GuiSession* session)
 {
-    if (numPlacedLetters <= 0) return;
+    if (session->numPlacedLetters <= 0) return;
 
-    isInvalidMove = false;
+    session->isInvalidMove = false;
 
-    Coordinate lastLetter = lettersCoordinates[numPlacedLetters - 1];
+    Coordinate lastLetter = session->lettersCoordinates[session->numPlacedLetters - 1];
 
-    clone.board[lastLetter.y][lastLetter.x].is_placed = false;
-    clone.board[lastLetter.y][lastLetter.x].letter = '\0';
+    setSquare(&session->clone, lastLetter.x, lastLetter.y, '\0');
 
     // Find the first empty slot in playerLetters to put back the letter
     int index = 0;
-    while (index < MAX_LETTERS && playerLetters[index] != '\0')
+    while (index < MAX_LETTERS && session->playerLetters[index] != '\0')
     {
         index++;
     }
     if (index < MAX_LETTERS)
     {
-        playerLetters[index] = placedLetters[numPlacedLetters - 1];
+        session->playerLetters[index] = rackTile(session->placedLetters[session->numPlacedLetters - 1]);
     }
 
-    placedLetters[numPlacedLetters - 1] = '\0';
-    numPlacedLetters--;
+    session->placedLetters[session->numPlacedLetters - 1] = '\0';
+    session->numPlacedLetters--;
 
-    if (numPlacedLetters <= 1)
+    // Only the words that went through the removed tile are checked again
+    double previewStart = profilerNow();
+    updateScorePreview(&session->preview, &session->clone, session->lettersCoordinates, session->numPlacedLetters, lastLetter);
+    recordMetric(Metric_Preview, profilerNow() - previewStart);
+
+    if (session->numPlacedLetters <= 1)
     {
-        currentDirection = Still_None;
+        session->currentDirection = Still_None;
     }
 }
 
 // Places a letter on the board at the specified coordinates
-void placeLetter(int x, int y)
+void placeLetter(GuiSession* session, int x, int y)
 {
-    clone.board[y][x].is_placed = true;
-    clone.board[y][x].letter = playerLetters[selectedIndex];
-    placedLetters[numPlacedLetters] = playerLetters[selectedIndex];
-    lettersCoordinates[numPlacedLetters] = (Coordinate){x, y};
-    numPlacedLetters++;
-    playerLetters[selectedIndex] = '\0';
-    selectedIndex = -1;
+    // A blank is laid as the letter typed for it
+    char tile = session->playerLetters[session->selectedIndex];
+    if (tile == BLANK_TILE)
+    {
+        tile |= session->blankLetter;
+    }
+
+    setSquare(&session->clone, x, y, tile);
+    session->placedLetters[session->numPlacedLetters] = tile;
+    session->lettersCoordinates[session->numPlacedLetters] = (Coordinate){x, y};
+    session->numPlacedLetters++;
+    session->playerLetters[session->selectedIndex] = '\0';
+    session->selectedIndex = -1;
+    session->blankLetter = 0;
 
-    if (numPlacedLetters == 2)
+    // Only the words that go through the new tile are checked
+    double previewStart = profilerNow();
+    updateScorePreview(&session->preview, &session->clone, session->lettersCoordinates, session->numPlacedLetters, (Coordinate){x, y});
+    recordMetric(Metric_Preview, profilerNow() - previewStart);
+
+    if (session->numPlacedLetters == 2)
     {
-        currentDirection = determineDirection(x, y);
+        session->currentDirection = determineDirection(session, x, y);
 
-        switch (currentDirection)
+        switch (session->currentDirection)
         {
         case Vertical:
-            currentAxis = x;
+            session->currentAxis = x;
             break;
         case Horizontal:
-            currentAxis = y;
+            session->currentAxis = y;
             break;
         default:
             break;
@@ -366,25 +691,25 @@ void placeLetter(int x, int y)
 }
 
 // Temporary function to check if a spot is available for placement
-bool getTempFunc(int x, int y)
+bool getTempFunc(GuiSession* session, int x, int y)
 {
     bool available = false;
 
-    if (currentDirection != Still_None)
+    if (session->currentDirection != Still_None)
     {
-        available = isSpotAvailable(&clone, x, y, currentDirection, currentAxis);
+        available = isSpotAvailable(&session->clone, x, y, session->currentDirection, session->currentAxis);
     }
     else
     {
-        if (!beingPlay())
+        if (!beingPlay(session))
         {
-            available = isSpotAvailable(&clone, x, y, currentDirection, currentAxis);
+            available = isSpotAvailable(&session->clone, x, y, session->currentDirection, session->currentAxis);
         }
         else
         {
-            WordDirection tempDirection = determineDirection(x, y);
+            WordDirection tempDirection = determineDirection(session, x, y);
 
-            Coordinate firstLetter = getStartingLetter();
+            Coordinate firstLetter = getStartingLetter(session);
             int yStartLetter = firstLetter.y;
             int xStartLetter = firstLetter.x;
 
@@ -394,10 +719,10 @@ bool getTempFunc(int x, int y)
                 available = false;
                 break;
             case Vertical:
-                available = isSpotAvailable(&clone, x, y, tempDirection, xStartLetter);
+                available = isSpotAvailable(&session->clone, x, y, tempDirection, xStartLetter);
                 break;
             case Horizontal:
-                available = isSpotAvailable(&clone, x, y, tempDirection, yStartLetter);
+                available = isSpotAvailable(&session->clone, x, y, tempDirection, yStartLetter);
                 break;
             }
         }
@@ -413,7 +738,7 @@ bool isSpotAvailable(Game* game, int x, int y, WordDirection direction, int axis
     if (game->player1.score == 0 && game->player2.score == 0 && direction == Still_None)
     {
         // The middle of the board is the only possible position that can be placed
-        if (x == 7 && y == 7 && !game->board[y][x].is_placed)
+        if (x == LENGTH / 2 && y == LENGTH / 2 && !game->board[y][x].is_placed)
         {
             return true;
         }
@@ -458,9 +783,9 @@ bool isSpotAvailable(Game* game, int x, int y, WordDirection direction, int axis
 }
 
 // Determines the direction based on the starting point
-WordDirection determineDirection(int x, int y)
+WordDirection determineDirection(const GuiSession* session, int x, int y)
 {
-    Coordinate firstLetter = getStartingLetter();
+    Coordinate firstLetter = getStartingLetter(session);
     int yStartLetter = firstLetter.y;
     int xStartLetter = firstLetter.x;
 
@@ -471,8 +796,10 @@ WordDirection determineDirection(int x, int y)
 }
 
 // Draws the control panel on the right side
-void drawPanel(Game* game)
+void drawPanel(GuiSession* session)
 {
+    Game* game = session->game;
+
     // Draw the control panel background
     DrawRectangle(scaled.controlAreaX, 0, scaled.controlAreaWidth, SCREEN_HEIGHT, LIGHTGRAY);
 
@@ -519,7 +846,7 @@ void drawPanel(Game* game)
     // Iterate through player's letters and draw them
     for (int i = 0; i < MAX_LETTERS; i++)
     {
-        if (playerLetters[i] != '\0')
+        if (session->playerLetters[i] != '\0')
         {
             // Define the rectangle for the letter
             Rectangle letterBox = {
@@ -532,38 +859,57 @@ void drawPanel(Game* game)
             // Handle left mouse button click on a letter box
             if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && CheckCollisionPointRec(GetMousePosition(), letterBox))
             {
-                if (selectedIndex < 0 || selectedIndex != i)
+                if (session->selectedIndex < 0 || session->selectedIndex != i)
                 {
-                    selectedIndex = i;
+                    session->selectedIndex = i;
                 }
                 else
                 {
-                    selectedIndex = -1;
+                    session->selectedIndex = -1;
                 }
+                session->blankLetter = 0;
             }
 
-            // Draw the letter box
-            DrawRectangleRec(letterBox, BEIGE);
-            DrawRectangleLinesEx(letterBox, 2 * SCALE_FACTOR, BLACK);
+            // A right click marks the letter to be exchanged, or unmarks it
+            if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) && CheckCollisionPointRec(GetMousePosition(), letterBox) &&
+                !beingPlay(session))
+            {
+                session->exchangeSlots ^= 1u << i;
+            }
 
-            // Draw the letter centered in the box
-            char letterStr[2] = {playerLetters[i], '\0'};
-            Vector2 textSize = MeasureTextEx(gameFont, letterStr, scaled.fontSizeLetter, 1);
-            Vector2 textPos = {
-                letterBox.x + (scaled.tileSize - textSize.x) / 2,
-                letterBox.y + (scaled.tileSize - textSize.y) / 2
-            };
-            DrawTextEx(gameFont, letterStr, textPos, scaled.fontSizeLetter, 1, BLACK);
+            // A selected blank takes the letter typed next: a letter, or 1 to 4 for CH, LL, RR and Ñ
+            char tile = session->playerLetters[i];
+            if (tile == BLANK_TILE && session->selectedIndex == i)
+            {
+                for (int key = GetCharPressed(); key != 0; key = GetCharPressed())
+                {
+                    const char typed[2] = {(char)key, '\0'};
+                    const char* text = typed;
+                    char letter = (key < 128) ? tileLetter(parseLetter(&text)) : 0;
+                    if (isLetterCode(letter))
+                    {
+                        session->blankLetter = letter;
+                    }
+                }
+                tile |= session->blankLetter;
+            }
+
+            // Draw the letter box with its letter and value
+            drawLetterSprite(tile, Sprite_Rack, letterBox.x, letterBox.y, WHITE);
 
             // Highlight selected letter
-            if (selectedIndex == i)
+            if (session->selectedIndex == i)
             {
                 DrawRectangleLinesEx(letterBox, 2 * SCALE_FACTOR, GREEN);
             }
-            else if (selectedIndex >= 0 && selectedIndex != i)
+            else if (session->selectedIndex >= 0 && session->selectedIndex != i)
             {
                 DrawRectangleRec(letterBox, COLOR_HOVER);
             }
+            if (session->exchangeSlots & (1u << i))
+            {
+                DrawRectangleLinesEx(letterBox, 2 * SCALE_FACTOR, RED);
+            }
 
             letterCount++;
         }
@@ -572,6 +918,13 @@ void drawPanel(Game* game)
     // Increment Y position for buttons
     currentY = lettersStartY + scaled.tileSize + scaled.paddingBetweenElements;
 
+    // Draw the running score of the tiles placed this turn
+    if (beingPlay(session))
+    {
+        drawScorePreview(session, startX, currentY);
+        currentY += scaled.fontSizeLarge + scaled.paddingBetweenElements;
+    }
+
     // Draw the "Accept" or "Reroll Letters" button
     Rectangle actionButtonRect = {
         startX,
@@ -580,30 +933,61 @@ void drawPanel(Game* game)
         40 * SCALE_FACTOR
     };
 
-    if (beingPlay())
+    if (beingPlay(session))
     {
         // "Accept" button in green
         Color acceptColor = GREEN;
         if (GuiButton(actionButtonRect, "Aceptar"))
         {
-            handleSubmit(game);
+            handleSubmit(session);
         }
     }
     else
     {
-        // "Reroll Letters" button in green
+        // "Reroll Letters" button in green, exchanging only the marked letters when there are some
         Color rerollColor = GREEN;
-        if (GuiButton(actionButtonRect, "Rerrollear Letras"))
+        if (GuiButton(actionButtonRect, session->exchangeSlots != 0 ? "Cambiar Letras" : "Rerrollear Letras"))
         {
-            handleRerollLetters(game);
+            handleRerollLetters(session);
         }
     }
 
     // Increment Y position
     currentY += actionButtonRect.height + scaled.paddingBetweenElements;
 
+    // Draw the "Hint" button, which cancels the search while it is running
+    Rectangle hintButtonRect = {
+        startX,
+        currentY,
+        scaled.controlAreaWidth - 40 * SCALE_FACTOR,
+        40 * SCALE_FACTOR
+    };
+
+    if (isSearchRunning(&session->searchWorker))
+    {
+        int percent = (int)(searchProgress(&session->searchWorker) * 100);
+        if (GuiButton(hintButtonRect, TextFormat("Cancelar pista (%d%%)", percent)))
+        {
+            cancelSearch(&session->searchWorker);
+        }
+    }
+    else if (GuiButton(hintButtonRect, "Pista"))
+    {
+        handleHint(session);
+    }
+
+    // Increment Y position
+    currentY += hintButtonRect.height + scaled.paddingBetweenElements;
+
+    // Draw the hint found by the worker
+    if (session->hasHint || session->hintNotFound)
+    {
+        drawHintMessage(session, startX, currentY);
+        currentY += scaled.fontSizeLarge + scaled.paddingBetweenElements;
+    }
+
     // Draw invalid move message if needed
-    if (isInvalidMove)
+    if (session->isInvalidMove)
     {
         drawInvalidMoveMessage(startX, currentY);
         currentY += scaled.fontSizeTitle + scaled.paddingBetweenElements;
@@ -619,7 +1003,7 @@ void drawPanel(Game* game)
 
     if (GuiButton(endGameButtonRect, "Terminar Partida"))
     {
-        handleEndGame(game);
+        handleEndGame(session);
     }
 
     // Increment Y position
@@ -645,113 +1029,215 @@ void drawInvalidMoveMessage(float startX, float currentY)
     DrawTextEx(gameFont, errorMessage, (Vector2){startX, currentY}, scaled.fontSizeTitle, 1, RED);
 }
 
+// Draws the score the tentative move would earn, or that it is not valid yet
+void drawScorePreview(const GuiSession* session, float startX, float currentY)
+{
+    if (session->preview.valid)
+    {
+        char previewText[50];
+        sprintf(previewText, "Puntos de la jugada: %d", session->preview.score);
+        DrawTextEx(gameFont, previewText, (Vector2){startX, currentY}, scaled.fontSizeLarge, 1, DARKGREEN);
+    }
+    else
+    {
+        DrawTextEx(gameFont, "Palabra no valida", (Vector2){startX, currentY}, scaled.fontSizeLarge, 1, RED);
+    }
+}
+
+// Draws the hint found by the worker below the hint button
+void drawHintMessage(const GuiSession* session, float startX, float currentY)
+{
+    if (session->hintNotFound)
+    {
+        DrawTextEx(gameFont, "No hay jugadas posibles.", (Vector2){startX, currentY}, scaled.fontSizeLarge, 1, BLACK);
+        return;
+    }
+
+    char hintCodes[MAX_LETTERS + 1] = {0};
+    char hintLetters[MAX_LETTERS * LETTER_TEXT_SIZE];
+    memcpy(hintCodes, session->hintMove.letters, session->hintMove.numLetters);
+    decodeWord(hintCodes, hintLetters, sizeof(hintLetters));
+
+    char hintText[80];
+    sprintf(hintText, "Pista: %s (%d puntos)", hintLetters, session->hintMove.score);
+    DrawTextEx(gameFont, hintText, (Vector2){startX, currentY}, scaled.fontSizeLarge, 1, DARKGREEN);
+}
+
+// Function to handle the "Hint" button click
+void handleHint(GuiSession* session)
+{
+    Game* game = session->game;
+
+    session->hasHint = false;
+    session->hintNotFound = false;
+    submitSearch(&session->searchWorker, game, Search_Hint);
+}
+
+// Discards the current hint and any search still running, since the turn changed
+void clearHint(GuiSession* session)
+{
+    cancelSearch(&session->searchWorker);
+    session->hasHint = false;
+    session->hintNotFound = false;
+}
+
+// Collects the hint found by the worker, if one finished since the last frame
+void pollHint(GuiSession* session)
+{
+    SearchResult result;
+    if (pollSearch(&session->searchWorker, &result) && result.kind == Search_Hint)
+    {
+        session->hasHint = result.found;
+        session->hintNotFound = !result.found;
+        session->hintMove = result.move;
+    }
+}
+
 // Function to handle the "Accept" button click
-void handleSubmit(Game* game)
+void handleSubmit(GuiSession* session)
 {
-    if (numPlacedLetters > 0)
+    Game* game = session->game;
+
+    if (session->numPlacedLetters > 0)
     {
-        int moveScore = validateAndScoreWords(&clone, lettersCoordinates, numPlacedLetters);
+        // The tiles are played on the game itself, by the engine's rules; the clone only shows them laid
+        PlayerTurn player = game->turn;
+        double validateStart = profilerNow();
+        unsigned long lookupsBefore = getDictionaryLookups();
+        int moveScore = playMove(game, session->lettersCoordinates, session->placedLetters, session->numPlacedLetters);
+        recordMetric(Metric_Validate, profilerNow() - validateStart);
+        recordMetric(Metric_Lookups, (double)(getDictionaryLookups() - lookupsBefore));
 
         if (moveScore >= 0)
         {
-            // Valid move
-            isInvalidMove = false;
-            Player* currentPlayer = (clone.turn == Player1) ? &clone.player1 : &clone.player2;
-            currentPlayer->score += moveScore;
-
-            // Remove used letters from the player's hand
-            removeLettersFromPlayer(currentPlayer, placedLetters);
-
-            // Refill the player's letters
-            refillPlayerLetters(&clone.bag, currentPlayer);
+            // Valid move: the letters left the rack, the rack was refilled and the turn passed
+            session->isInvalidMove = false;
+            recordPlay(session->recorder, game, player, session->lettersCoordinates, session->placedLetters,
+                       session->numPlacedLetters, moveScore);
 
             // Reset movement variables
-            numPlacedLetters = 0;
-            memset(lettersCoordinates, 0, sizeof(lettersCoordinates));
-            memset(placedLetters, 0, sizeof(placedLetters));
-            selectedIndex = -1;
-            currentDirection = Still_None;
-            currentAxis = 0;
-
-            // Switch turn to the next player
-            switchTurn(&clone);
-
-            // Clone the updated game state
-            cloneGame(&clone, game);
+            session->numPlacedLetters = 0;
+            memset(session->lettersCoordinates, 0, sizeof(session->lettersCoordinates));
+            memset(session->placedLetters, 0, sizeof(session->placedLetters));
+            session->selectedIndex = -1;
+            session->currentDirection = Still_None;
+            session->currentAxis = 0;
+            resetScorePreview(&session->preview);
+            clearHint(session);
+
+            // The working copy is refreshed from the game before the next frame is drawn
+            session->gameChanged = true;
         }
         else
         {
             // Invalid move
-            isInvalidMove = true;
+            session->isInvalidMove = true;
         }
     }
 }
 
 // Function to handle "Reroll Letters" button click
-void handleRerollLetters(Game* game)
+void handleRerollLetters(GuiSession* session)
 {
-    Player* currentPlayer = (game->turn == Player1) ? &game->player1 : &game->player2;
-
-    // Return letters to the bag
-    for (int i = 0; i < MAX_LETTERS; i++)
+    PlayerTurn player = session->game->turn;
+    if (session->exchangeSlots != 0)
     {
-        if (currentPlayer->letters[i] != '\0')
+        // Only the marked letters go back, and only if the bag can replace them all
+        const Player* mover = (player == Player1) ? &session->game->player1 : &session->game->player2;
+        char returned[MAX_LETTERS];
+        int numReturned = 0;
+        for (int i = 0; i < MAX_LETTERS; i++)
         {
-            game->bag.letters[game->bag.remaining++] = currentPlayer->letters[i];
-            currentPlayer->letters[i] = '\0';
+            if (session->exchangeSlots & (1u << i))
+            {
+                returned[numReturned++] = mover->letters[i];
+            }
         }
+        if (!exchangePlayerLetters(session->game, session->exchangeSlots))
+        {
+            session->isInvalidMove = true;
+            return;
+        }
+        recordExchange(session->recorder, session->game, player, returned, numReturned);
+        session->exchangeSlots = 0;
     }
-
-    // Refill the player's letters
-    refillPlayerLetters(&game->bag, currentPlayer);
-
-    // Switch turn to the next player
-    switchTurn(game);
+    else
+    {
+        rerollPlayerLetters(session->game);
+        recordReroll(session->recorder, session->game, player);
+    }
+    clearHint(session);
+    session->gameChanged = true;
 }
 
 // Function to handle "End Game" button click
-void handleEndGame(Game* game)
+void handleEndGame(GuiSession* session)
 {
-    if (game->turn == Player1)
+    recordEnd(session->recorder, session->game->turn);
+    requestEndGame(session->game);
+    clearHint(session);
+    session->gameChanged = true;
+}
+
+// Draws the entire game state
+bool drawGame(GuiSession* session)
+{
+    Game* game = session->game;
+
+    double frameStart = profilerNow();
+
+    // F3 toggles the timing overlay and F4 saves the recorded timings
+    if (IsKeyPressed(KEY_F3))
     {
-        game->player1WantsToEnd = true;
-        switchTurn(game);
+        showProfiler = !showProfiler;
     }
-    else
+    if (IsKeyPressed(KEY_F4))
     {
-        game->player2WantsToEnd = true;
-        switchTurn(game);
+        dumpMetricsCsv("profile.csv");
     }
 
-    // If both players want to end, set the game as over
-    if (game->player1WantsToEnd && game->player2WantsToEnd)
+    // The committed game only changes through the button handlers, so the end of the
+    // game is checked and the working copy refreshed after they run instead of every frame
+    if (session->gameChanged && isGameOver(game))
     {
-        game->gameOver = true;
+        return false; // Signal to close the game
     }
-}
 
-// Draws the entire game state
-bool drawGame(Game* game)
-{
     if (!game->gameOver)
     {
-        if (!beingPlay())
+        if (session->gameChanged && !beingPlay(session))
         {
+            double cloneStart = profilerNow();
             Player* player = (game->turn == Player1) ? &game->player1 : &game->player2;
-            memcpy(playerLetters, player->letters, sizeof(playerLetters));
-            cloneGame(game, &clone);
+            memcpy(session->playerLetters, player->letters, sizeof(session->playerLetters));
+            session->exchangeSlots = 0;
+            cloneGame(game, &session->clone);
+            session->gameChanged = false;
+            recordMetric(Metric_CloneGame, profilerNow() - cloneStart);
         }
 
+        // Pick up the hint searched in the background without waiting for it
+        pollHint(session);
+
         // Start drawing
         BeginDrawing();
 
         ClearBackground(RAYWHITE);
 
         // Draw the game board
-        drawBoard();
+        double boardStart = profilerNow();
+        drawBoard(session);
+        recordMetric(Metric_DrawBoard, profilerNow() - boardStart);
+
+        // Handle clicks on the board
+        double inputStart = profilerNow();
+        handleBoardInput(session);
+        recordMetric(Metric_Input, profilerNow() - inputStart);
 
         // Draw the control panel
-        drawPanel(game); // Pass the `game` pointer
+        double panelStart = profilerNow();
+        drawPanel(session);
+        recordMetric(Metric_DrawPanel, profilerNow() - panelStart);
     }
     else // If the game has ended, show the winner screen
     {
@@ -797,14 +1283,105 @@ bool drawGame(Game* game)
         }
     }
 
+    // Draw the timing overlay on top of everything else
+    if (showProfiler)
+    {
+        drawProfilerOverlay(session);
+    }
+    recordMetric(Metric_Frame, profilerNow() - frameStart);
+
+    // Sleep until the next input event unless a search needs its progress redrawn or its result collected
+    updateEventWaiting(!isSearchBusy(&session->searchWorker));
+
     // End drawing
     EndDrawing();
 
     return true; // Continue the game
 }
 
+// Draws the recent timings of each metric with a histogram of their distribution, then the hint cache
+void drawProfilerOverlay(GuiSession* session)
+{
+    float lineHeight = scaled.fontSizeSmall + 8 * SCALE_FACTOR;
+    float barWidth = 4 * SCALE_FACTOR;
+    Rectangle box = {
+        (float)scaled.offsetX,
+        (float)scaled.offsetY,
+        (float)(9 * scaled.tileSize),
+        (Metric_Count + 3) * lineHeight
+    };
+    DrawRectangleRec(box, COLOR_OVERLAY);
+
+    float textX = box.x + 8 * SCALE_FACTOR;
+    float currentY = box.y + 4 * SCALE_FACTOR;
+    DrawTextEx(gameFont, "Tiempos (F3 ocultar, F4 guardar CSV)", (Vector2){textX, currentY}, scaled.fontSizeSmall, 1,
+               WHITE);
+    currentY += lineHeight;
+
+    for (int metric = 0; metric < Metric_Count; metric++)
+    {
+        MetricStats stats;
+        getMetricStats((Metric)metric, &stats);
+
+        // Times are recorded in microseconds and shown in milliseconds; lookups are plain counts
+        const char* line;
+        if (metric == Metric_Lookups)
+        {
+            line = TextFormat("%-22s %6.0f  prom %6.1f  max %6.0f", metricName((Metric)metric), stats.last,
+                              stats.average, stats.max);
+        }
+        else
+        {
+            line = TextFormat("%-22s %6.3f  prom %6.3f  max %6.3f ms", metricName((Metric)metric), stats.last / 1000,
+                              stats.average / 1000, stats.max / 1000);
+        }
+        DrawTextEx(gameFont, line, (Vector2){textX, currentY}, scaled.fontSizeSmall, 1, WHITE);
+
+        // Histogram of the window, one bar per power-of-two bucket
+        int tallest = 1;
+        for (int b = 0; b < PROFILER_BUCKETS; b++)
+        {
+            if (stats.histogram[b] > tallest)
+            {
+                tallest = stats.histogram[b];
+            }
+        }
+        float histogramX = box.x + box.width - PROFILER_BUCKETS * barWidth - 8 * SCALE_FACTOR;
+        float barBottom = currentY + lineHeight - 6 * SCALE_FACTOR;
+        for (int b = 0; b < PROFILER_BUCKETS; b++)
+        {
+            float height = (lineHeight - 8 * SCALE_FACTOR) * stats.histogram[b] / tallest;
+            DrawRectangleRec((Rectangle){histogramX + b * barWidth, barBottom - height, barWidth - 1, height}, GREEN);
+        }
+
+        currentY += lineHeight;
+    }
+
+    MoveCacheStats cache;
+    getMoveCacheStats(session->hintCache, &cache);
+    const char* line = TextFormat("%-22s %d listas  %.1f / %.0f MB  aciertos %lu  fallos %lu", "Cache de jugadas",
+                                  cache.entries, cache.bytes / 1048576.0, cache.budget / 1048576.0, cache.hits,
+                                  cache.misses);
+    DrawTextEx(gameFont, line, (Vector2){textX, currentY}, scaled.fontSizeSmall, 1, WHITE);
+}
+
+// Switches between sleeping on input events and drawing at the target frame rate
+void updateEventWaiting(bool idle)
+{
+    if (idle && !waitingForEvents)
+    {
+        EnableEventWaiting();
+        waitingForEvents = true;
+    }
+    else if (!idle && waitingForEvents)
+    {
+        DisableEventWaiting();
+        waitingForEvents = false;
+    }
+}
+
 // Retrieves the starting letter's coordinates
-Coordinate getStartingLetter()
+Coordinate getStartingLetter(const GuiSession* session)
 {
-    return lettersCoordinates[0];
+    return session->lettersCoordinates[0];
 }
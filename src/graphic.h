@@ -4,6 +4,7 @@
 #define GRAPHIC_H
 
 #include "scrabble.h"
+#include "record.h"
 
 // --------------------
 // Color Definitions
@@ -14,8 +15,12 @@
 #define COLOR_TRIPLE_LETTER  (Color){ 0, 24, 136, 255 }       // Strong Blue
 #define COLOR_DOUBLE_LETTER  (Color){ 74, 196, 192, 255 }     // Cyan
 #define COLOR_DOUBLE_WORD    (Color){ 246, 179, 126, 255 }    // Desaturated Mustard Yellow
+#define COLOR_QUADRUPLE_WORD   (Color){ 128, 0, 64, 255 }   // Dark Crimson
+#define COLOR_QUADRUPLE_LETTER (Color){ 90, 40, 160, 255 }  // Violet
 #define COLOR_NORMAL         (Color){ 230, 230, 230, 255 }    // Beige
 #define COLOR_HOVER          (Color){ 230, 230, 230, 120 }    // Transparent Beige
+#define COLOR_HINT           (Color){ 0, 117, 44, 160 }       // Transparent Dark Green
+#define COLOR_OVERLAY        (Color){ 0, 0, 0, 190 }          // Transparent Black
 
 // --------------------
 // Window Dimensions
@@ -28,10 +33,41 @@
 // Scaling factor for UI elements
 #define SCALE_FACTOR 1.7f
 
+// Scaling of the board's squares and letters, so a larger board fits the same window
+#define BOARD_SCALE (15.0f / LENGTH)
+
 // Calculated scaled dimensions based on the scaling factor
 #define SCREEN_WIDTH  (int)(BASE_SCREEN_WIDTH * SCALE_FACTOR)
 #define SCREEN_HEIGHT (int)(BASE_SCREEN_HEIGHT * SCALE_FACTOR)
 
+// --------------------
+// Letter Atlas
+// --------------------
+
+// Number of tiles pre-rendered in the letter atlas: one per letter code, the unassigned blank, then a
+// blank playing as each letter
+#define ATLAS_LETTERS (2 * ALPHABET_SIZE + 1)
+
+// Represents the rows of the letter atlas
+typedef enum
+{
+    Sprite_Board,      // Letter and value on a transparent tile, drawn over the board square
+    Sprite_Rack,       // Letter and value on a beige box, as shown in the control panel
+    Sprite_Count,
+} LetterSprite;
+
+// --------------------
+// Hints
+// --------------------
+
+// Memory kept for the move lists of earlier hint searches, so asking again in a position seen before is
+// answered without searching
+#define HINT_CACHE_BYTES (32 * 1024 * 1024)
+
+// Table of the best opening of every rack, built by scrabble_openings; when it is missing or was built
+// for another word list the first turn is searched like any other
+#define OPENING_TABLE_FILE "openings.tbl"
+
 // --------------------
 // Structures
 // --------------------
@@ -73,6 +109,9 @@ typedef struct
     int paddingBetweenElements; // Padding between elements in the panel
 } ScaledDimensions;
 
+// Represents the state of one game played in the window (selection, placed tiles, hint search, caches)
+typedef struct GuiSession GuiSession;
+
 // --------------------
 // Function Prototypes
 // --------------------
@@ -83,8 +122,18 @@ void initGraphics();
 // Closes the graphical interface
 void closeGraphics();
 
+// Creates a session that plays the given game in the window, logging its events to the recorder if not NULL;
+// call after initGraphics
+GuiSession* createSession(Game* game, RecordWriter* recorder);
+
+// Stops the session's hint search and releases everything it owns
+void destroySession(GuiSession* session);
+
 // Handles user input and updates the game state
-bool drawGame(Game* game);
+bool drawGame(GuiSession* session);
+
+// Sleeps on input events while idle and draws at the target frame rate otherwise
+void updateEventWaiting(bool idle);
 
 // Loads resources (fonts, textures)
 void loadResources();
@@ -92,40 +141,70 @@ void loadResources();
 // Unloads resources
 void unloadResources();
 
+// Renders every letter tile into the letter atlas
+void buildLetterAtlas();
+
 // Draws the game board
-void drawBoard();
+void drawBoard(GuiSession* session);
+
+// Redraws the tiles that changed into the cached board texture
+bool refreshBoardTexture(GuiSession* session);
+
+// Recomputes which squares can take the selected letter
+void refreshAvailableTiles(GuiSession* session);
+
+// Handles clicks on the tile under the mouse
+void handleBoardInput(GuiSession* session);
+
+// Draws the timing overlay toggled with F3, with the counters of the session's hint cache
+void drawProfilerOverlay(GuiSession* session);
 
 // Draws the control panel
-void drawPanel(Game* game);
+void drawPanel(GuiSession* session);
 
 // Determines the direction based on the starting point
-WordDirection determineDirection(int x, int y);
+WordDirection determineDirection(const GuiSession* session, int x, int y);
 
 // Checks if a letter can be placed in a specific spot
 bool isSpotAvailable(Game* game, int x, int y, WordDirection direction, int axis);
 
 // Temporary function to check if a spot is available for placement
-bool getTempFunc(int x, int y);
+bool getTempFunc(GuiSession* session, int x, int y);
 
 // Retrieves the starting letter's coordinates
-Coordinate getStartingLetter();
+Coordinate getStartingLetter(const GuiSession* session);
 
 // Places a letter on the board at the specified coordinates
-void placeLetter(int x, int y);
+void placeLetter(GuiSession* session, int x, int y);
 
 // Removes the last placed letter from the board and player's letters
-void unplaceLastLetter();
+void unplaceLastLetter(GuiSession* session);
 
 // Handles the "Accept" button click
-void handleSubmit(Game* game);
+void handleSubmit(GuiSession* session);
 
-// Handles the "Reroll Letters" button click
-void handleRerollLetters(Game* game);
+// Handles the "Reroll Letters" button click: exchanges the marked letters, or the whole rack if none is marked
+void handleRerollLetters(GuiSession* session);
 
 // Handles the "End Game" button click
-void handleEndGame(Game* game);
+void handleEndGame(GuiSession* session);
 
 // Draws an invalid move message on the screen
 void drawInvalidMoveMessage(float startX, float currentY);
 
+// Handles the "Hint" button click by queueing a background search
+void handleHint(GuiSession* session);
+
+// Discards the current hint and cancels any search still running
+void clearHint(GuiSession* session);
+
+// Collects a finished hint search without blocking the frame
+void pollHint(GuiSession* session);
+
+// Draws the running score of the tiles placed this turn
+void drawScorePreview(const GuiSession* session, float startX, float currentY);
+
+// Draws the hint found by the background search
+void drawHintMessage(const GuiSession* session, float startX, float currentY);
+
 #endif // GRAPHIC_H
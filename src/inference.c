@@ -0,0 +1,476 @@
+// inference.c
+
+#include "inference.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --------------------
+// Helpers
+// --------------------
+
+// Returns the number of ways of choosing k items out of n
+double binomial(int n, int k)
+{
+    if (k < 0 || k > n)
+    {
+        return 0.0;
+    }
+    double ways = 1.0;
+    for (int i = 1; i <= k; i++)
+    {
+        ways = ways * (n - k + i) / i;
+    }
+    return ways;
+}
+
+// Returns the bit set of the letters present in a multiset, blanks left out
+static unsigned int letterMask(const unsigned char counts[TILE_KINDS])
+{
+    unsigned int mask = 0;
+    for (int i = 0; i < ALPHABET_SIZE; i++)
+    {
+        if (counts[i] > 0)
+        {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+// --------------------
+// Tile Counting Functions
+// --------------------
+
+// Counts the tiles of a string or rack into a multiset, blanks apart whatever letter they play as;
+// '\0' slots are skipped
+void countTiles(const char letters[], int numLetters, TileCounts* counts)
+{
+    memset(counts, 0, sizeof(TileCounts));
+    for (int i = 0; i < numLetters; i++)
+    {
+        if (isBlankTile(letters[i]))
+        {
+            counts->counts[BLANK_KIND]++;
+            counts->total++;
+        }
+        else if (isLetterCode(letters[i]))
+        {
+            counts->counts[letters[i] - 1]++;
+            counts->total++;
+        }
+    }
+}
+
+// Counts the tiles a new game's bag starts with
+void fullTileSet(TileCounts* counts)
+{
+    LetterBag bag;
+    initLetterBag(&bag, 0);
+    countTiles(bag.letters, bag.remaining, counts);
+}
+
+// Counts the tiles a player cannot see: the whole set minus the board and the player's own rack
+void countUnseenTiles(const Game* game, PlayerTurn viewer, TileCounts* unseen)
+{
+    fullTileSet(unseen);
+
+    const Player* player = (viewer == Player1) ? &game->player1 : &game->player2;
+    TileCounts seen;
+    countTiles(player->letters, MAX_LETTERS, &seen);
+    for (int y = 0; y < LENGTH; y++)
+    {
+        for (int x = 0; x < LENGTH; x++)
+        {
+            const Piece* square = &game->board[y][x];
+            if (square->is_placed && square->is_blank)
+            {
+                seen.counts[BLANK_KIND]++;
+            }
+            else if (square->is_placed && isLetterCode(square->letter))
+            {
+                seen.counts[square->letter - 1]++;
+            }
+        }
+    }
+
+    for (int i = 0; i < TILE_KINDS; i++)
+    {
+        unseen->counts[i] = unseen->counts[i] > seen.counts[i] ? unseen->counts[i] - seen.counts[i] : 0;
+    }
+    unseen->total = 0;
+    for (int i = 0; i < TILE_KINDS; i++)
+    {
+        unseen->total += unseen->counts[i];
+    }
+}
+
+// --------------------
+// Probability Functions
+// --------------------
+
+// Sums the ways of drawing at least the wanted count of each listed letter, the rest from the other tiles
+static double countDraws(const int available[], const int wanted[], int numLetters, int others, int draws)
+{
+    if (numLetters == 0)
+    {
+        return binomial(others, draws);
+    }
+    double ways = 0.0;
+    for (int x = wanted[0]; x <= available[0] && x <= draws; x++)
+    {
+        ways += binomial(available[0], x) * countDraws(available + 1, wanted + 1, numLetters - 1, others, draws - x);
+    }
+    return ways;
+}
+
+// Returns the chance that 'draws' tiles taken from the pool include every tile of 'wanted'
+double drawProbability(const TileCounts* pool, int draws, const TileCounts* wanted)
+{
+    if (draws > pool->total)
+    {
+        draws = pool->total;
+    }
+
+    int available[TILE_KINDS], needed[TILE_KINDS];
+    int numLetters = 0, others = pool->total;
+    for (int i = 0; i < TILE_KINDS; i++)
+    {
+        if (wanted->counts[i] > 0)
+        {
+            available[numLetters] = pool->counts[i];
+            needed[numLetters] = wanted->counts[i];
+            others -= pool->counts[i];
+            numLetters++;
+        }
+    }
+    if (wanted->total > draws)
+    {
+        return 0.0;
+    }
+    return countDraws(available, needed, numLetters, others, draws) / binomial(pool->total, draws);
+}
+
+// Returns the chance that 'draws' tiles taken from the pool include at least 'atLeast' of the given letter codes
+double letterClassProbability(const TileCounts* pool, int draws, const char* letters, int atLeast)
+{
+    if (draws > pool->total)
+    {
+        draws = pool->total;
+    }
+
+    int inClass = 0;
+    for (int i = 0; i < TILE_KINDS; i++)
+    {
+        if (strchr(letters, i + 1))
+        {
+            inClass += pool->counts[i];
+        }
+    }
+
+    double ways = 0.0;
+    for (int x = atLeast; x <= draws; x++)
+    {
+        ways += binomial(inClass, x) * binomial(pool->total - inClass, draws - x);
+    }
+    return ways / binomial(pool->total, draws);
+}
+
+// Returns the chance that the opponent of 'viewer' holds every letter code of 'letters'
+double opponentHoldsProbability(const Game* game, PlayerTurn viewer, const char* letters)
+{
+    const Player* opponent = (viewer == Player1) ? &game->player2 : &game->player1;
+    TileCounts unseen, wanted;
+    countUnseenTiles(game, viewer, &unseen);
+    countTiles(letters, strlen(letters), &wanted);
+    return drawProbability(&unseen, countPlayerLetters(opponent), &wanted);
+}
+
+// --------------------
+// Bingo Functions
+// --------------------
+
+// Represents the keys collected while walking the lexicon
+typedef struct
+{
+    char (*keys)[MAX_LETTERS];
+    int count;
+    int capacity;
+} KeyCollector;
+
+// Orders two anagram keys
+static int compareKeys(const void* a, const void* b)
+{
+    return memcmp(a, b, MAX_LETTERS);
+}
+
+// Orders two letters
+static int compareLetters(const void* a, const void* b)
+{
+    return *(const char*)a - *(const char*)b;
+}
+
+// Adds the anagram key of a seven-letter word
+static void collectKey(const char* word, void* user)
+{
+    KeyCollector* collector = user;
+    if (strlen(word) != MAX_LETTERS)
+    {
+        return;
+    }
+
+    char key[MAX_LETTERS];
+    memcpy(key, word, MAX_LETTERS);
+    qsort(key, MAX_LETTERS, 1, compareLetters);
+
+    if (collector->count == collector->capacity)
+    {
+        int capacity = collector->capacity ? collector->capacity * 2 : 4096;
+        char (*keys)[MAX_LETTERS] = realloc(collector->keys, capacity * sizeof(*keys));
+        if (!keys)
+        {
+            perror("Error allocating bingo keys");
+            exit(EXIT_FAILURE);
+        }
+        collector->keys = keys;
+        collector->capacity = capacity;
+    }
+    memcpy(collector->keys[collector->count++], key, MAX_LETTERS);
+}
+
+// Builds the anagram keys of the lexicon's seven-letter words
+BingoIndex* buildBingoIndex(const Lexicon* lexicon)
+{
+    KeyCollector collector = {NULL, 0, 0};
+    forEachWord(lexicon, collectKey, &collector);
+
+    // Anagrams share a key; keep each once
+    qsort(collector.keys, collector.count, MAX_LETTERS, compareKeys);
+    int distinct = 0;
+    for (int i = 0; i < collector.count; i++)
+    {
+        if (distinct == 0 || memcmp(collector.keys[i], collector.keys[distinct - 1], MAX_LETTERS) != 0)
+        {
+            memmove(collector.keys[distinct++], collector.keys[i], MAX_LETTERS);
+        }
+    }
+
+    BingoIndex* index = malloc(sizeof(BingoIndex));
+    unsigned int* masks = malloc((distinct > 0 ? distinct : 1) * sizeof(unsigned int));
+    if (!index || !masks)
+    {
+        perror("Error allocating bingo index");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < distinct; i++)
+    {
+        masks[i] = 0;
+        for (int j = 0; j < MAX_LETTERS; j++)
+        {
+            masks[i] |= 1u << (collector.keys[i][j] - 1);
+        }
+    }
+    index->keys = collector.keys;
+    index->masks = masks;
+    index->count = distinct;
+    return index;
+}
+
+// Frees a bingo index
+void freeBingoIndex(BingoIndex* index)
+{
+    if (index)
+    {
+        free(index->keys);
+        free(index->masks);
+        free(index);
+    }
+}
+
+// Clears a cache and its counters
+void initInferenceCache(InferenceCache* cache)
+{
+    memset(cache, 0, sizeof(InferenceCache));
+}
+
+// Orders two packed draws
+static int compareDraws(const void* a, const void* b)
+{
+    unsigned long long x = *(const unsigned long long*)a, y = *(const unsigned long long*)b;
+    return (x > y) - (x < y);
+}
+
+// Counts the ways of drawing a multiset of letters, given as a sorted list, from the unseen tiles
+static double countDrawWays(const char letters[], int numLetters, const TileCounts* unseen)
+{
+    double ways = 1.0;
+    for (int j = 0; j < numLetters && ways > 0.0;)
+    {
+        int run = 1;
+        while (j + run < numLetters && letters[j + run] == letters[j])
+        {
+            run++;
+        }
+        ways *= binomial(unseen->counts[letters[j] - 1], run);
+        j += run;
+    }
+    return ways;
+}
+
+// Collects the tiles of a key that the kept letters do not cover, in order; returns false if the key
+// lacks a kept letter
+static bool missingTiles(const char key[MAX_LETTERS], const TileCounts* kept, char missing[MAX_LETTERS],
+                         int* numMissing)
+{
+    unsigned char used[ALPHABET_SIZE] = {0};
+    *numMissing = 0;
+    for (int j = 0; j < MAX_LETTERS; j++)
+    {
+        int letter = key[j] - 1;
+        if (used[letter] < kept->counts[letter])
+        {
+            used[letter]++;
+        }
+        else
+        {
+            missing[(*numMissing)++] = key[j];
+        }
+    }
+    return *numMissing == MAX_LETTERS - (kept->total - kept->counts[BLANK_KIND]);
+}
+
+// Sums the ways of drawing letters that, with kept blanks standing in for the rest, complete some key. A
+// draw fits many keys once blanks are free to play as anything, so the draws are packed, sorted and each
+// one counted once
+static double countBlankDraws(const BingoIndex* index, const TileCounts* unseen, const TileCounts* kept,
+                              int draws, unsigned int keptMask)
+{
+    unsigned long long* packed = NULL;
+    int count = 0, capacity = 0;
+    for (int i = 0; i < index->count; i++)
+    {
+        char missing[MAX_LETTERS];
+        int numMissing;
+        if ((index->masks[i] & keptMask) != keptMask || !missingTiles(index->keys[i], kept, missing, &numMissing))
+        {
+            continue;
+        }
+
+        // Every way of leaving the blanks' places out of the missing tiles is a draw that completes the key
+        for (int skipped = 0; skipped < (1 << numMissing); skipped++)
+        {
+            unsigned long long draw = 0;
+            int drawn = 0;
+            for (int j = 0; j < numMissing; j++)
+            {
+                if (!(skipped & (1 << j)))
+                {
+                    draw = (draw << 5) | (unsigned long long)missing[j];
+                    drawn++;
+                }
+            }
+            if (drawn != draws)
+            {
+                continue;
+            }
+            if (count == capacity)
+            {
+                capacity = capacity ? capacity * 2 : 4096;
+                unsigned long long* grown = realloc(packed, capacity * sizeof(*packed));
+                if (!grown)
+                {
+                    perror("Error allocating bingo draws");
+                    exit(EXIT_FAILURE);
+                }
+                packed = grown;
+            }
+            packed[count++] = draw;
+        }
+    }
+
+    qsort(packed, count, sizeof(*packed), compareDraws);
+    double ways = 0.0;
+    for (int i = 0; i < count; i++)
+    {
+        if (i > 0 && packed[i] == packed[i - 1])
+        {
+            continue;
+        }
+        char letters[MAX_LETTERS];
+        for (int j = draws - 1; j >= 0; j--)
+        {
+            letters[j] = (char)((packed[i] >> (5 * (draws - 1 - j))) & 31);
+        }
+        ways += countDrawWays(letters, draws, unseen);
+    }
+    free(packed);
+    return ways;
+}
+
+// Sums the chances of drawing the missing tiles of every key that contains the kept ones
+static double computeBingoProbability(const BingoIndex* index, const TileCounts* unseen, const TileCounts* kept,
+                                      int draws)
+{
+    unsigned int keptMask = letterMask(kept->counts);
+    if (kept->counts[BLANK_KIND] > 0)
+    {
+        return countBlankDraws(index, unseen, kept, draws, keptMask) / binomial(unseen->total, draws);
+    }
+
+    // Without a kept blank each key needs exactly one draw, so the keys' chances add up
+    unsigned int drawable = keptMask | letterMask(unseen->counts);
+    double ways = 0.0;
+    for (int i = 0; i < index->count; i++)
+    {
+        // Every kept letter must be in the word and every other letter must still be unseen
+        if ((index->masks[i] & keptMask) != keptMask || (index->masks[i] & ~drawable) != 0)
+        {
+            continue;
+        }
+
+        char missing[MAX_LETTERS];
+        int numMissing;
+        if (missingTiles(index->keys[i], kept, missing, &numMissing))
+        {
+            ways += countDrawWays(missing, numMissing, unseen);
+        }
+    }
+    return ways / binomial(unseen->total, draws);
+}
+
+// Returns the chance that refilling the kept tiles from the unseen pool makes a seven-letter word
+double bingoDrawProbability(const BingoIndex* index, InferenceCache* cache, const TileCounts* unseen,
+                            int bagRemaining, const TileCounts* kept)
+{
+    int draws = MAX_LETTERS - kept->total;
+    if (draws < 0 || draws > bagRemaining || draws > unseen->total)
+    {
+        return 0.0; // The rack cannot be filled back to seven tiles
+    }
+    if (cache == NULL)
+    {
+        return computeBingoProbability(index, unseen, kept, draws);
+    }
+
+    // Direct-mapped memo keyed by both multisets
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < TILE_KINDS; i++)
+    {
+        hash = (hash ^ unseen->counts[i]) * 16777619u;
+        hash = (hash ^ kept->counts[i]) * 16777619u;
+    }
+    InferenceEntry* entry = &cache->entries[hash % INFERENCE_CACHE_SIZE];
+    if (entry->used && memcmp(entry->unseen, unseen->counts, TILE_KINDS) == 0 &&
+        memcmp(entry->kept, kept->counts, TILE_KINDS) == 0)
+    {
+        cache->hits++;
+        return entry->probability;
+    }
+
+    cache->misses++;
+    entry->used = true;
+    memcpy(entry->unseen, unseen->counts, TILE_KINDS);
+    memcpy(entry->kept, kept->counts, TILE_KINDS);
+    entry->probability = computeBingoProbability(index, unseen, kept, draws);
+    return entry->probability;
+}
@@ -0,0 +1,112 @@
+// inference.h
+
+#ifndef INFERENCE_H
+#define INFERENCE_H
+
+#include "scrabble.h"
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Number of distinct tiles counted: every letter, then the blank
+#define TILE_KINDS (ALPHABET_SIZE + 1)
+
+// Slot of the blanks in a multiset, after the letters
+#define BLANK_KIND ALPHABET_SIZE
+
+// Number of memoized draw probabilities kept per cache
+#define INFERENCE_CACHE_SIZE 1024
+
+// From one player's point of view the unseen tiles are the opponent's rack and the bag together,
+// and every way of splitting them is equally likely. The opponent's rack and our next draw are
+// therefore both uniform samples without replacement from the unseen multiset, and their odds are
+// exact (multivariate hypergeometric) rather than simulated.
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents a multiset of tiles, counted by letter code - 1 and blanks in BLANK_KIND
+typedef struct
+{
+    unsigned char counts[TILE_KINDS];
+    int total;
+} TileCounts;
+
+// Represents the lexicon's seven-letter words as sorted-letter anagram keys, for bingo odds
+typedef struct
+{
+    char (*keys)[MAX_LETTERS];     // Distinct sorted letter sets of the seven-letter words
+    unsigned int* masks;           // Bit per letter present in each key, to skip keys quickly
+    int count;
+} BingoIndex;
+
+// Represents one memoized probability
+typedef struct
+{
+    bool used;
+    unsigned char unseen[TILE_KINDS];        // Unseen tiles the probability was computed from
+    unsigned char kept[TILE_KINDS];          // Tiles kept on the rack
+    double probability;
+} InferenceEntry;
+
+// Represents a memo of bingo draw probabilities, keyed by the unseen and kept multisets
+// Not shared between threads: each thread keeps its own
+typedef struct
+{
+    InferenceEntry entries[INFERENCE_CACHE_SIZE];
+    unsigned long hits;
+    unsigned long misses;
+} InferenceCache;
+
+// --------------------
+// Tile Counting Functions
+// --------------------
+
+// Counts the tiles of a string or rack into a multiset, blanks apart whatever letter they play as;
+// '\0' slots are skipped
+void countTiles(const char letters[], int numLetters, TileCounts* counts);
+
+// Counts the tiles a new game's bag starts with
+void fullTileSet(TileCounts* counts);
+
+// Counts the tiles a player cannot see: the whole set minus the board and the player's own rack
+void countUnseenTiles(const Game* game, PlayerTurn viewer, TileCounts* unseen);
+
+// --------------------
+// Probability Functions
+// --------------------
+
+// Returns the number of ways of choosing k items out of n
+double binomial(int n, int k);
+
+// Returns the chance that 'draws' tiles taken from the pool include every tile of 'wanted'
+double drawProbability(const TileCounts* pool, int draws, const TileCounts* wanted);
+
+// Returns the chance that 'draws' tiles taken from the pool include at least 'atLeast' of the given letter codes
+double letterClassProbability(const TileCounts* pool, int draws, const char* letters, int atLeast);
+
+// Returns the chance that the opponent of 'viewer' holds every letter code of 'letters'
+double opponentHoldsProbability(const Game* game, PlayerTurn viewer, const char* letters);
+
+// --------------------
+// Bingo Functions
+// --------------------
+
+// Builds the anagram keys of the lexicon's seven-letter words
+BingoIndex* buildBingoIndex(const Lexicon* lexicon);
+
+// Frees a bingo index
+void freeBingoIndex(BingoIndex* index);
+
+// Clears a cache and its counters
+void initInferenceCache(InferenceCache* cache);
+
+// Returns the chance that refilling the kept tiles from the unseen pool makes a seven-letter word;
+// 'bagRemaining' limits the draw. Kept blanks play as any letter; a blank drawn is not counted as
+// helping, so while blanks are unseen the chance is a lower bound. Memoized in 'cache' when it is not NULL
+double bingoDrawProbability(const BingoIndex* index, InferenceCache* cache, const TileCounts* unseen,
+                            int bagRemaining, const TileCounts* kept);
+
+#endif // INFERENCE_H
@@ -2,7 +2,9 @@
 
 #include "scrabble.h"
 #include "graphic.h"
+#include "record.h"
 #include <time.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 // --------------------
@@ -15,15 +17,30 @@ int main() {
     // Initialization
     // --------------------
 
-    // Seed the random number generator with the current time to ensure randomness
-    srand(time(NULL));
+    // Use the premium squares of layout.txt when there is one, the standard ones otherwise (a 21 x 21 build
+    // has none and needs the file)
+    FILE* layout = fopen("layout.txt", "r");
+    if (layout)
+    {
+        fclose(layout);
+        loadBoardLayout("layout.txt");
+    }
+
+    // Load the dictionary once; games only keep a read-only reference to it
+    Lexicon* lexicon = loadValidWords("palabras.txt");
 
-    // Initialize the game state
+    // Initialize the game state, seeding its letter bag with the current time to ensure randomness
+    unsigned long long seed = (unsigned long long)time(NULL);
     Game game;
-    initGame(&game);
+    initGame(&game, lexicon, seed);
+
+    // Append the game to the record of every game played (it still runs if the log cannot be opened)
+    RecordWriter* recorder = openRecordWriter("games.rec");
+    recordGameStart(recorder, seed, &game);
 
-    // Initialize the graphical user interface
+    // Initialize the graphical user interface and the session that plays this game in it
     initGraphics();
+    GuiSession* session = createSession(&game, recorder);
 
     // Flag to control the main game loop
     bool running = true;
@@ -31,10 +48,11 @@ int main() {
     // --------------------
     // Main Game Loop
     // --------------------
-    while (running && !isGameOver(&game)) {
+    while (running) {
         // Handle user input, update game state, and render the game
-        // 'drawGame' returns false if the game window should close
-        running = drawGame(&game);
+        // 'drawGame' returns false if the game window should close or the tiles ran out
+        // While nothing changes it blocks on input events instead of polling
+        running = drawGame(session);
 
         // Note: All drawing and input handling is managed inside 'drawGame'
     }
@@ -44,7 +62,11 @@ int main() {
     // --------------------
 
     // Free allocated resources and clean up the game state
+    destroySession(session);
+    recordGameEnd(recorder, &game);
+    closeRecordWriter(recorder);
     freeGame(&game);
+    freeLexicon(lexicon);
 
     // Close the graphical interface and release associated resources
     closeGraphics();
@@ -0,0 +1,346 @@
+// movecache.c
+
+#include "movecache.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Seed of the Zobrist keys
+#define ZOBRIST_SEED 0x5A0B1D7C3E29F461ull
+
+// --------------------
+// Keys
+// --------------------
+
+// Returns the Zobrist key of a tile on a square; keys are derived rather than tabled, so none is shared
+// between squares or tiles
+static unsigned long long zobristKey(int square, char tile)
+{
+    return mixBits(((unsigned long long)square << 8 | (unsigned char)tile) + ZOBRIST_SEED);
+}
+
+// Returns the tile on a square as the cache keeps it
+static char squareTile(const Piece* piece)
+{
+    return piece->is_placed ? (char)(piece->letter | (piece->is_blank ? BLANK_TILE : 0)) : '\0';
+}
+
+// Returns the Zobrist hash of the tiles on a board, blanks apart from the letters they play as
+unsigned long long hashPosition(const Game* game)
+{
+    unsigned long long hash = 0;
+    for (int y = 0; y < LENGTH; y++)
+    {
+        for (int x = 0; x < LENGTH; x++)
+        {
+            char tile = squareTile(&game->board[y][x]);
+            if (tile != '\0')
+            {
+                hash ^= zobristKey(y * LENGTH + x, tile);
+            }
+        }
+    }
+    return hash;
+}
+
+// Copies a rack in sorted order with its empty slots last, so racks holding the same tiles compare equal
+static void sortRack(const char rack[MAX_LETTERS], char sorted[MAX_LETTERS])
+{
+    int length = 0;
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        if (rack[i] == '\0')
+        {
+            continue;
+        }
+        int j = length++;
+        for (; j > 0 && sorted[j - 1] > rack[i]; j--)
+        {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = rack[i];
+    }
+    memset(sorted + length, 0, MAX_LETTERS - length);
+}
+
+// Represents the full key of a lookup
+typedef struct
+{
+    unsigned long long key;
+    char board[LENGTH * LENGTH];
+    char rack[MAX_LETTERS];
+} CacheKey;
+
+// Builds the key of a position and rack
+static void makeKey(const Game* game, const char rack[MAX_LETTERS], CacheKey* key)
+{
+    for (int y = 0; y < LENGTH; y++)
+    {
+        for (int x = 0; x < LENGTH; x++)
+        {
+            key->board[y * LENGTH + x] = squareTile(&game->board[y][x]);
+        }
+    }
+    sortRack(rack, key->rack);
+
+    unsigned long long rackBits = 0;
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        rackBits = rackBits << 8 | (unsigned char)key->rack[i];
+    }
+    key->key = hashPosition(game) ^ mixBits(rackBits);
+}
+
+// Returns the shard a key belongs to
+static MoveCacheShard* shardOf(MoveCache* cache, unsigned long long key)
+{
+    return &cache->shards[key % MOVE_CACHE_SHARDS];
+}
+
+// Returns the chain a key belongs to within its shard
+static MoveCacheEntry** chainOf(MoveCacheShard* shard, unsigned long long key)
+{
+    return &shard->chains[(key / MOVE_CACHE_SHARDS) % MOVE_CACHE_CHAINS];
+}
+
+// --------------------
+// Recency List
+// --------------------
+
+// Takes an entry out of the recency list
+static void unlinkRecency(MoveCacheShard* shard, MoveCacheEntry* entry)
+{
+    if (entry->newer)
+    {
+        entry->newer->older = entry->older;
+    }
+    else
+    {
+        shard->newest = entry->older;
+    }
+    if (entry->older)
+    {
+        entry->older->newer = entry->newer;
+    }
+    else
+    {
+        shard->oldest = entry->newer;
+    }
+    entry->newer = entry->older = NULL;
+}
+
+// Puts an entry at the front of the recency list
+static void linkNewest(MoveCacheShard* shard, MoveCacheEntry* entry)
+{
+    entry->newer = NULL;
+    entry->older = shard->newest;
+    if (shard->newest)
+    {
+        shard->newest->newer = entry;
+    }
+    shard->newest = entry;
+    if (!shard->oldest)
+    {
+        shard->oldest = entry;
+    }
+}
+
+// Removes an entry from its chain and the recency list and frees it
+static void removeEntry(MoveCacheShard* shard, MoveCacheEntry* entry)
+{
+    MoveCacheEntry** link = chainOf(shard, entry->key);
+    while (*link != entry)
+    {
+        link = &(*link)->nextInChain;
+    }
+    *link = entry->nextInChain;
+    unlinkRecency(shard, entry);
+    shard->bytes -= entry->bytes;
+    shard->entries--;
+    free(entry->moves);
+    free(entry);
+}
+
+// Finds the entry of a key in its shard, or NULL
+static MoveCacheEntry* findEntry(MoveCacheShard* shard, const CacheKey* key)
+{
+    for (MoveCacheEntry* entry = *chainOf(shard, key->key); entry; entry = entry->nextInChain)
+    {
+        if (entry->key == key->key && memcmp(entry->rack, key->rack, MAX_LETTERS) == 0 &&
+            memcmp(entry->board, key->board, sizeof(entry->board)) == 0)
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// --------------------
+// Cache Functions
+// --------------------
+
+// Creates an empty cache holding at most about 'budget' bytes of move lists
+MoveCache* createMoveCache(size_t budget)
+{
+    MoveCache* cache = calloc(1, sizeof(MoveCache));
+    if (!cache)
+    {
+        perror("Error allocating move cache");
+        exit(EXIT_FAILURE);
+    }
+    cache->shardBudget = budget / MOVE_CACHE_SHARDS;
+    for (int i = 0; i < MOVE_CACHE_SHARDS; i++)
+    {
+        pthread_mutex_init(&cache->shards[i].mutex, NULL);
+    }
+    return cache;
+}
+
+// Frees a cache and every list in it
+void freeMoveCache(MoveCache* cache)
+{
+    if (!cache)
+    {
+        return;
+    }
+    for (int i = 0; i < MOVE_CACHE_SHARDS; i++)
+    {
+        MoveCacheShard* shard = &cache->shards[i];
+        while (shard->oldest)
+        {
+            removeEntry(shard, shard->oldest);
+        }
+        pthread_mutex_destroy(&shard->mutex);
+    }
+    free(cache);
+}
+
+// Replaces the list's moves with the cached placements of the rack in the position
+bool findCachedMoves(MoveCache* cache, const Game* game, const char rack[MAX_LETTERS], MoveList* list)
+{
+    CacheKey key;
+    makeKey(game, rack, &key);
+    MoveCacheShard* shard = shardOf(cache, key.key);
+
+    pthread_mutex_lock(&shard->mutex);
+    MoveCacheEntry* entry = findEntry(shard, &key);
+    if (entry == NULL)
+    {
+        shard->misses++;
+        pthread_mutex_unlock(&shard->mutex);
+        return false;
+    }
+    shard->hits++;
+    unlinkRecency(shard, entry);
+    linkNewest(shard, entry);
+
+    // Copied under the lock: another thread may evict the entry as soon as it is released
+    if (list->capacity < entry->count)
+    {
+        Move* moves = realloc(list->moves, entry->count * sizeof(Move));
+        if (!moves)
+        {
+            perror("Error allocating move list");
+            exit(EXIT_FAILURE);
+        }
+        list->moves = moves;
+        list->capacity = entry->count;
+    }
+    memcpy(list->moves, entry->moves, entry->count * sizeof(Move));
+    list->count = entry->count;
+    pthread_mutex_unlock(&shard->mutex);
+    return true;
+}
+
+// Keeps a copy of the placements of a rack in a position, sorted from the highest score down
+void cacheMoves(MoveCache* cache, const Game* game, const char rack[MAX_LETTERS], const MoveList* list)
+{
+    size_t bytes = sizeof(MoveCacheEntry) + list->count * sizeof(Move);
+    if (bytes > cache->shardBudget)
+    {
+        return; // Would push every other list out
+    }
+
+    MoveCacheEntry* entry = calloc(1, sizeof(MoveCacheEntry));
+    Move* moves = malloc((list->count > 0 ? list->count : 1) * sizeof(Move));
+    if (!entry || !moves)
+    {
+        perror("Error allocating move cache");
+        exit(EXIT_FAILURE);
+    }
+    CacheKey key;
+    makeKey(game, rack, &key);
+    entry->key = key.key;
+    memcpy(entry->board, key.board, sizeof(entry->board));
+    memcpy(entry->rack, key.rack, MAX_LETTERS);
+    memcpy(moves, list->moves, list->count * sizeof(Move));
+    entry->moves = moves;
+    entry->count = list->count;
+    entry->bytes = bytes;
+
+    // Sorting outside the lock keeps other threads waiting only for the bookkeeping
+    MoveList sorted = {moves, list->count, list->count};
+    sortMovesByScore(&sorted);
+
+    MoveCacheShard* shard = shardOf(cache, key.key);
+    pthread_mutex_lock(&shard->mutex);
+    MoveCacheEntry* existing = findEntry(shard, &key);
+    if (existing)
+    {
+        removeEntry(shard, existing); // Another thread searched the same position meanwhile
+    }
+    while (shard->bytes + bytes > cache->shardBudget && shard->oldest)
+    {
+        removeEntry(shard, shard->oldest);
+        shard->evictions++;
+    }
+    MoveCacheEntry** chain = chainOf(shard, key.key);
+    entry->nextInChain = *chain;
+    *chain = entry;
+    linkNewest(shard, entry);
+    shard->bytes += bytes;
+    shard->entries++;
+    pthread_mutex_unlock(&shard->mutex);
+}
+
+// Fills the list with every placement of the rack sorted from the highest score down
+int generateSortedMoves(MoveCache* cache, const Game* game, const char rack[MAX_LETTERS], MoveList* list,
+                        MoveGenProgress progress, void* user)
+{
+    if (cache != NULL && findCachedMoves(cache, game, rack, list))
+    {
+        return list->count;
+    }
+
+    clearMoveList(list);
+    int generated = generateMoves(game, rack, list, progress, user);
+    if (generated < 0)
+    {
+        return -1; // A cancelled search is incomplete and is not cached
+    }
+    sortMovesByScore(list);
+    if (cache != NULL)
+    {
+        cacheMoves(cache, game, rack, list);
+    }
+    return generated;
+}
+
+// Sums the counters of every shard
+void getMoveCacheStats(MoveCache* cache, MoveCacheStats* stats)
+{
+    memset(stats, 0, sizeof(MoveCacheStats));
+    stats->budget = cache->shardBudget * MOVE_CACHE_SHARDS;
+    for (int i = 0; i < MOVE_CACHE_SHARDS; i++)
+    {
+        MoveCacheShard* shard = &cache->shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        stats->hits += shard->hits;
+        stats->misses += shard->misses;
+        stats->evictions += shard->evictions;
+        stats->entries += shard->entries;
+        stats->bytes += shard->bytes;
+        pthread_mutex_unlock(&shard->mutex);
+    }
+}
@@ -0,0 +1,105 @@
+// movecache.h
+
+#ifndef MOVECACHE_H
+#define MOVECACHE_H
+
+#include "movegen.h"
+#include <pthread.h>
+#include <stddef.h>
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Number of independently locked parts of a cache; positions are spread over them by hash
+#define MOVE_CACHE_SHARDS 16
+
+// Number of hash chains per shard
+#define MOVE_CACHE_CHAINS 1024
+
+// A move cache maps a position and a rack to the full list of placements the rack has there, sorted from
+// the highest score down, so a search already made is answered by one hash lookup and a copy. Positions
+// are keyed by a Zobrist hash of the board, combined with the rack's letters in sorted order; the entry
+// keeps the board and the rack to confirm a match. Each shard evicts its least recently used lists once
+// the bytes they take pass its share of the budget.
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents one cached move list
+typedef struct MoveCacheEntry
+{
+    unsigned long long key;                  // Position hash combined with the rack
+    char board[LENGTH * LENGTH];             // Tile on each square, BLANK_TILE set for a blank, 0 when empty
+    char rack[MAX_LETTERS];                  // Rack in sorted order, empty slots last
+    Move* moves;                             // Placements, highest score first
+    int count;
+    size_t bytes;                            // Memory the entry accounts for
+    struct MoveCacheEntry* nextInChain;
+    struct MoveCacheEntry* newer;            // Neighbours in the shard's recency list
+    struct MoveCacheEntry* older;
+} MoveCacheEntry;
+
+// Represents one independently locked part of the cache
+typedef struct
+{
+    pthread_mutex_t mutex;                   // Protects every field below
+    MoveCacheEntry* chains[MOVE_CACHE_CHAINS];
+    MoveCacheEntry* newest;                  // Recency list, from the last used entry to the least recent
+    MoveCacheEntry* oldest;
+    size_t bytes;                            // Memory taken by the shard's entries
+    int entries;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+} MoveCacheShard;
+
+// Represents a bounded cache of move lists shared by any number of threads
+typedef struct
+{
+    MoveCacheShard shards[MOVE_CACHE_SHARDS];
+    size_t shardBudget;                      // Bytes each shard may hold
+} MoveCache;
+
+// Represents the counters of a cache, summed over its shards
+typedef struct
+{
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+    int entries;
+    size_t bytes;                            // Memory taken by the cached lists
+    size_t budget;                           // Memory the cache may take
+} MoveCacheStats;
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Creates an empty cache holding at most about 'budget' bytes of move lists
+MoveCache* createMoveCache(size_t budget);
+
+// Frees a cache and every list in it
+void freeMoveCache(MoveCache* cache);
+
+// Returns the Zobrist hash of the tiles on a board, blanks apart from the letters they play as
+unsigned long long hashPosition(const Game* game);
+
+// Replaces the list's moves with the cached placements of the rack in the position; returns false if
+// they are not cached
+bool findCachedMoves(MoveCache* cache, const Game* game, const char rack[MAX_LETTERS], MoveList* list);
+
+// Keeps a copy of the placements of a rack in a position, sorted from the highest score down
+void cacheMoves(MoveCache* cache, const Game* game, const char rack[MAX_LETTERS], const MoveList* list);
+
+// Fills the list with every placement of the rack sorted from the highest score down, from the cache when
+// it holds them and else generated and cached; the cache may be NULL. Returns the number of moves, or -1
+// if the progress callback cancelled the search
+int generateSortedMoves(MoveCache* cache, const Game* game, const char rack[MAX_LETTERS], MoveList* list,
+                        MoveGenProgress progress, void* user);
+
+// Sums the counters of every shard
+void getMoveCacheStats(MoveCache* cache, MoveCacheStats* stats);
+
+#endif // MOVECACHE_H
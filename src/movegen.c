@@ -0,0 +1,457 @@
+// movegen.c
+
+#include "movegen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Cross-check cache states
+#define CROSS_UNKNOWN 0
+#define CROSS_ALLOWED 1
+#define CROSS_REJECTED 2
+
+// --------------------
+// Generator State
+// --------------------
+
+// Working state shared by the recursive search
+typedef struct
+{
+    Game scratch;                          // Private copy of the position; tiles are laid on it while searching
+    int rackCounts[ALPHABET_SIZE];         // Remaining count of each rack letter, indexed by letter code - 1
+    int blanks;                            // Remaining blanks, kept apart from the letters
+    int tilesLeft;                         // Number of tiles still in the rack
+    bool boardEmpty;                       // True before the opening move
+    unsigned int anchors[2][LENGTH];       // Empty squares where a placement connects to the board, as bitmasks
+                                           // of each row (0) and each column (1)
+    char crossChecks[2][LENGTH][LENGTH][ALPHABET_SIZE]; // Cached perpendicular word checks per direction
+
+    bool horizontal;                       // Direction of the line being searched
+    int line;                              // Row (horizontal) or column (vertical) being searched
+    unsigned int lineAnchors;              // Anchors of the line being searched
+    int nextAnchor[LENGTH + 1];            // Position of the first anchor at or after each square of the line
+    int emptyBefore[LENGTH + 1];           // Number of empty squares before each position of the line
+
+    char word[LENGTH + 1];                 // Main word built so far, in letter codes
+    Move current;                          // Tiles laid so far on the current line
+    MoveList* list;                        // Output list
+} GenState;
+
+// --------------------
+// Move List Functions
+// --------------------
+
+// Initializes an empty move list
+void initMoveList(MoveList* list)
+{
+    list->moves = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+// Removes every move from the list, keeping its storage
+void clearMoveList(MoveList* list)
+{
+    list->count = 0;
+}
+
+// Frees the storage used by the list
+void freeMoveList(MoveList* list)
+{
+    free(list->moves);
+    initMoveList(list);
+}
+
+// Appends a move to the list, growing the storage when needed
+static void appendMove(MoveList* list, const Move* move)
+{
+    if (list->count == list->capacity)
+    {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        Move* moves = realloc(list->moves, capacity * sizeof(Move));
+        if (!moves)
+        {
+            perror("Error allocating move list");
+            exit(EXIT_FAILURE);
+        }
+        list->moves = moves;
+        list->capacity = capacity;
+    }
+    list->moves[list->count++] = *move;
+}
+
+// Orders moves by descending score; ties are broken on the placement so the order is deterministic
+static int compareMoves(const void* a, const void* b)
+{
+    const Move* first = a;
+    const Move* second = b;
+
+    if (first->score != second->score)
+    {
+        return second->score - first->score;
+    }
+    if (first->numLetters != second->numLetters)
+    {
+        return second->numLetters - first->numLetters;
+    }
+    int squares = memcmp(first->squares, second->squares, first->numLetters * sizeof(Coordinate));
+    if (squares != 0)
+    {
+        return squares;
+    }
+    return memcmp(first->letters, second->letters, first->numLetters);
+}
+
+// Sorts the moves from highest to lowest score
+void sortMovesByScore(MoveList* list)
+{
+    if (list->count > 1)
+    {
+        qsort(list->moves, list->count, sizeof(Move), compareMoves);
+    }
+}
+
+// --------------------
+// Board Helpers
+// --------------------
+
+// Returns the square at a position of the line being searched
+static Piece* lineSquare(GenState* state, int pos)
+{
+    return state->horizontal ? &state->scratch.board[state->line][pos] : &state->scratch.board[pos][state->line];
+}
+
+// Returns the empty squares of a line next to a letter, given the occupied squares of the line and of
+// the lines on either side
+static unsigned int anchorsOfLine(unsigned int line, unsigned int before, unsigned int after)
+{
+    return ~line & LINE_BITS & (line << 1 | line >> 1 | before | after);
+}
+
+// Marks the squares where a placement can connect to the existing letters
+static void findAnchors(GenState* state)
+{
+    const Game* game = &state->scratch;
+
+    state->boardEmpty = !game->board[LENGTH / 2][LENGTH / 2].is_placed;
+    memset(state->anchors, 0, sizeof(state->anchors));
+
+    if (state->boardEmpty)
+    {
+        // The opening move has to cover the center square
+        state->anchors[0][LENGTH / 2] = 1u << (LENGTH / 2);
+        state->anchors[1][LENGTH / 2] = 1u << (LENGTH / 2);
+        return;
+    }
+
+    for (int line = 0; line < LENGTH; line++)
+    {
+        state->anchors[0][line] = anchorsOfLine(occupiedRow(game, line), occupiedRow(game, line - 1),
+                                              occupiedRow(game, line + 1));
+        state->anchors[1][line] = anchorsOfLine(occupiedColumn(game, line), occupiedColumn(game, line - 1),
+                                              occupiedColumn(game, line + 1));
+    }
+}
+
+// Prepares the anchor and empty square tables of the current line
+static void prepareLine(GenState* state)
+{
+    unsigned int occupied = state->horizontal ? occupiedRow(&state->scratch, state->line)
+                                              : occupiedColumn(&state->scratch, state->line);
+    state->lineAnchors = state->anchors[state->horizontal ? 0 : 1][state->line];
+
+    state->emptyBefore[0] = 0;
+    for (int pos = 0; pos <= LENGTH; pos++)
+    {
+        if (pos < LENGTH)
+        {
+            state->emptyBefore[pos + 1] = state->emptyBefore[pos] + (int)(~occupied >> pos & 1);
+        }
+        unsigned int ahead = state->lineAnchors >> pos;
+        state->nextAnchor[pos] = ahead ? pos + __builtin_ctz(ahead) : LENGTH;
+    }
+}
+
+// Checks whether a letter (code - 1) on an empty square forms a valid word across the line
+static bool crossAllowed(GenState* state, int pos, int letter)
+{
+    int x = state->horizontal ? pos : state->line;
+    int y = state->horizontal ? state->line : pos;
+    char* cached = &state->crossChecks[state->horizontal ? 0 : 1][y][x][letter];
+
+    if (*cached != CROSS_UNKNOWN)
+    {
+        return *cached == CROSS_ALLOWED;
+    }
+
+    // The perpendicular word is the run of occupied squares through the square once the letter is on it
+    const unsigned char* cross = state->horizontal ? state->scratch.columns[x] : state->scratch.rows[y];
+    int crossPos = state->horizontal ? y : x;
+    int start, end;
+    findRun(lineMask(cross) | 1u << crossPos, crossPos, &start, &end);
+    int length = end - start + 1;
+    char crossWord[LINE_STRIDE + 1];
+    copyLineWord(cross, start, end, crossWord);
+    crossWord[crossPos - start] = (char)(letter + 1);
+
+    bool allowed = length == 1 || isValidWord(state->scratch.lexicon, crossWord);
+    *cached = allowed ? CROSS_ALLOWED : CROSS_REJECTED;
+    return allowed;
+}
+
+// --------------------
+// Recursive Search
+// --------------------
+
+// Scores the tiles laid so far and stores them as a move
+static void recordMove(GenState* state)
+{
+    Move* move = &state->current;
+
+    // A single tile forms words in both directions; keep it only from the horizontal search
+    if (!state->horizontal && move->numLetters == 1)
+    {
+        const Piece* square = &state->scratch.board[move->squares[0].y][move->squares[0].x];
+        if ((square->left != NULL && square->left->is_placed) || (square->right != NULL && square->right->is_placed))
+        {
+            return;
+        }
+    }
+
+    if (!isValidWord(state->scratch.lexicon, state->word))
+    {
+        return;
+    }
+
+    move->score = validateAndScoreWords(&state->scratch, move->squares, move->numLetters);
+    if (move->score >= 0)
+    {
+        appendMove(state->list, move);
+    }
+}
+
+static void extendWord(GenState* state, int pos, int length, bool connected);
+
+// Lays a rack tile or a blank playing as 'letter' (code - 1), searches deeper, then takes it back
+static void layTile(GenState* state, int x, int y, int letter, bool blank, int pos, int length, bool reachesAnchor)
+{
+    Move* move = &state->current;
+    char tile = (char)((letter + 1) | (blank ? BLANK_TILE : 0));
+    setSquare(&state->scratch, x, y, tile);
+    move->squares[move->numLetters] = (Coordinate){x, y};
+    move->letters[move->numLetters] = tile;
+    move->numLetters++;
+    int* count = blank ? &state->blanks : &state->rackCounts[letter];
+    (*count)--;
+    state->tilesLeft--;
+
+    extendWord(state, pos + 1, length + 1, reachesAnchor);
+
+    state->tilesLeft++;
+    (*count)++;
+    move->numLetters--;
+    setSquare(&state->scratch, x, y, '\0');
+}
+
+// Extends the main word one square to the right (or down), laying rack tiles on empty squares
+static void extendWord(GenState* state, int pos, int length, bool connected)
+{
+    Piece* square = (pos < LENGTH) ? lineSquare(state, pos) : NULL;
+
+    // Letters already on the board become part of the word as they are
+    if (square != NULL && square->is_placed)
+    {
+        state->word[length] = square->letter;
+        state->word[length + 1] = '\0';
+        if (isValidPrefix(state->scratch.lexicon, state->word))
+        {
+            extendWord(state, pos + 1, length + 1, connected);
+        }
+        return;
+    }
+
+    // The word may end here, before an empty square or the edge of the board
+    state->word[length] = '\0';
+    if (connected && state->current.numLetters > 0 && length > 1)
+    {
+        recordMove(state);
+    }
+
+    if (square == NULL || state->tilesLeft == 0)
+    {
+        return;
+    }
+
+    // Stop when the rack cannot reach the next anchor
+    if (!connected)
+    {
+        int anchor = state->nextAnchor[pos];
+        if (anchor == LENGTH || state->emptyBefore[anchor + 1] - state->emptyBefore[pos] > state->tilesLeft)
+        {
+            return;
+        }
+    }
+
+    int x = state->horizontal ? pos : state->line;
+    int y = state->horizontal ? state->line : pos;
+    bool reachesAnchor = connected || (state->lineAnchors >> pos & 1);
+
+    // With a blank left, ask the lexicon which letters continue the word rather than trying every one;
+    // those letters need no further prefix check
+    unsigned int continuations = 0;
+    if (state->blanks > 0)
+    {
+        continuations = nextLetters(state->scratch.lexicon, state->word);
+    }
+
+    for (int letter = 0; letter < ALPHABET_SIZE; letter++)
+    {
+        bool continues = (continuations & (1u << letter)) != 0;
+        if ((state->rackCounts[letter] == 0 && !continues) || !crossAllowed(state, pos, letter))
+        {
+            continue;
+        }
+
+        state->word[length] = (char)(letter + 1);
+        state->word[length + 1] = '\0';
+        if (state->blanks > 0 ? !continues : !isValidPrefix(state->scratch.lexicon, state->word))
+        {
+            continue;
+        }
+
+        // The letter's own tile and a blank playing as it score differently and leave different racks
+        if (state->rackCounts[letter] > 0)
+        {
+            layTile(state, x, y, letter, false, pos, length, reachesAnchor);
+        }
+        if (state->blanks > 0)
+        {
+            layTile(state, x, y, letter, true, pos, length, reachesAnchor);
+        }
+    }
+}
+
+// Searches every word that starts on some square of the current line
+static void searchLine(GenState* state)
+{
+    prepareLine(state);
+
+    for (int start = 0; start < LENGTH; start++)
+    {
+        // A word cannot start right after a letter
+        if (start > 0 && lineSquare(state, start - 1)->is_placed)
+        {
+            continue;
+        }
+        if (state->nextAnchor[start] == LENGTH)
+        {
+            break;
+        }
+
+        state->current.numLetters = 0;
+        state->word[0] = '\0';
+        extendWord(state, start, 0, false);
+    }
+}
+
+// --------------------
+// Generation Functions
+// --------------------
+
+// Allocates the search state of a rack on a position, appending to the list
+static GenState* startSearch(const Game* game, const char rack[MAX_LETTERS], MoveList* list)
+{
+    GenState* state = malloc(sizeof(GenState));
+    if (!state)
+    {
+        perror("Error allocating move generator");
+        exit(EXIT_FAILURE);
+    }
+
+    cloneGame(game, &state->scratch);
+    memset(state->crossChecks, CROSS_UNKNOWN, sizeof(state->crossChecks));
+    memset(state->rackCounts, 0, sizeof(state->rackCounts));
+    state->blanks = 0;
+    state->tilesLeft = 0;
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        if (isLetterCode(rack[i]))
+        {
+            state->rackCounts[rack[i] - 1]++;
+            state->tilesLeft++;
+        }
+        else if (rack[i] == BLANK_TILE)
+        {
+            state->blanks++;
+            state->tilesLeft++;
+        }
+    }
+    state->list = list;
+    findAnchors(state);
+    return state;
+}
+
+// Appends every legal placement of the given rack on the game board to the list
+int generateMoves(const Game* game, const char rack[MAX_LETTERS], MoveList* list,
+                  MoveGenProgress progress, void* user)
+{
+    GenState* state = startSearch(game, rack, list);
+    int generatedBefore = list->count;
+    int totalLines = 2 * LENGTH;
+    int linesDone = 0;
+    bool cancelled = false;
+
+    for (int direction = 0; direction < 2 && !cancelled; direction++)
+    {
+        state->horizontal = (direction == 0);
+        for (int line = 0; line < LENGTH; line++)
+        {
+            state->line = line;
+            searchLine(state);
+            linesDone++;
+
+            if (progress != NULL && !progress(user, linesDone, totalLines))
+            {
+                cancelled = true;
+                break;
+            }
+        }
+    }
+
+    free(state);
+    return cancelled ? -1 : list->count - generatedBefore;
+}
+
+// Appends the placements of the given rack whose main word lies on some of the board's lines
+int generateLineMoves(const Game* game, const char rack[MAX_LETTERS], MoveList* list, int firstLine, int numLines)
+{
+    GenState* state = startSearch(game, rack, list);
+    int generatedBefore = list->count;
+    for (int line = firstLine; line < firstLine + numLines && line < 2 * LENGTH; line++)
+    {
+        state->horizontal = line < LENGTH;
+        state->line = line % LENGTH;
+        searchLine(state);
+    }
+
+    free(state);
+    return list->count - generatedBefore;
+}
+
+// Finds the highest scoring placement for the given rack
+bool findBestMove(const Game* game, const char rack[MAX_LETTERS], Move* best,
+                  MoveGenProgress progress, void* user)
+{
+    MoveList list;
+    initMoveList(&list);
+
+    bool found = generateMoves(game, rack, &list, progress, user) > 0;
+    if (found)
+    {
+        sortMovesByScore(&list);
+        *best = list.moves[0];
+    }
+
+    freeMoveList(&list);
+    return found;
+}
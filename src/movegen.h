@@ -0,0 +1,68 @@
+// movegen.h
+
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include "scrabble.h"
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents a complete placement: the tiles laid in one turn and what they score
+typedef struct
+{
+    Coordinate squares[MAX_LETTERS]; // Board coordinates of each placed tile
+    char letters[MAX_LETTERS];       // Letter laid on each square, parallel to 'squares'; BLANK_TILE | letter for a blank
+    int numLetters;                  // Number of tiles laid
+    int score;                       // Score as computed by validateAndScoreWords
+} Move;
+
+// Growable list of generated moves
+typedef struct
+{
+    Move* moves;                     // Array of moves
+    int count;                       // Number of moves stored
+    int capacity;                    // Number of moves the array can hold
+} MoveList;
+
+// Progress callback invoked after each board line is searched
+// Receives the number of lines searched and the total; returning false cancels the search
+typedef bool (*MoveGenProgress)(void* user, int done, int total);
+
+// --------------------
+// Move List Functions
+// --------------------
+
+// Initializes an empty move list
+void initMoveList(MoveList* list);
+
+// Removes every move from the list, keeping its storage
+void clearMoveList(MoveList* list);
+
+// Frees the storage used by the list
+void freeMoveList(MoveList* list);
+
+// Sorts the moves from highest to lowest score
+void sortMovesByScore(MoveList* list);
+
+// --------------------
+// Generation Functions
+// --------------------
+
+// Appends every legal placement of the given rack on the game board to the list
+// Returns the number of moves generated, or -1 if the progress callback cancelled the search
+int generateMoves(const Game* game, const char rack[MAX_LETTERS], MoveList* list,
+                  MoveGenProgress progress, void* user);
+
+// Appends the placements of the given rack whose main word lies on lines firstLine to firstLine + numLines - 1,
+// counting the rows from 0 and then the columns from LENGTH, so disjoint ranges can be searched in parallel
+// Returns the number of moves generated
+int generateLineMoves(const Game* game, const char rack[MAX_LETTERS], MoveList* list, int firstLine, int numLines);
+
+// Finds the highest scoring placement for the given rack
+// Returns false if there is no legal placement or the search was cancelled
+bool findBestMove(const Game* game, const char rack[MAX_LETTERS], Move* best,
+                  MoveGenProgress progress, void* user);
+
+#endif // MOVEGEN_H
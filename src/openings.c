@@ -0,0 +1,713 @@
+// openings.c
+
+#include "openings.h"
+#include "wordhash.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Racks searched by one build task
+#define RACKS_PER_TASK 1024
+
+// --------------------
+// Rack Ranking
+// --------------------
+
+// Returns how many tiles of a kind a full bag holds
+static int kindCount(int kind)
+{
+    return kind == BLANK_KIND ? BLANK_COUNT : getLetterCount((char)(kind + 1));
+}
+
+// Counts, for every kind and size, the racks of that size drawn from that kind and the ones after it
+static void countRacks(unsigned int racks[TILE_KINDS + 1][MAX_LETTERS + 1])
+{
+    memset(racks, 0, sizeof(unsigned int) * (TILE_KINDS + 1) * (MAX_LETTERS + 1));
+    racks[TILE_KINDS][0] = 1;
+    for (int kind = TILE_KINDS - 1; kind >= 0; kind--)
+    {
+        for (int size = 0; size <= MAX_LETTERS; size++)
+        {
+            for (int c = 0; c <= kindCount(kind) && c <= size; c++)
+            {
+                racks[kind][size] += racks[kind + 1][size - c];
+            }
+        }
+    }
+}
+
+// Returns the index of a full rack: racks are ordered by their count of the first kind, then of the
+// second, and so on
+static unsigned int rankRack(const unsigned int racks[TILE_KINDS + 1][MAX_LETTERS + 1], const TileCounts* rack)
+{
+    unsigned int index = 0;
+    int size = MAX_LETTERS;
+    for (int kind = 0; kind < TILE_KINDS; kind++)
+    {
+        for (int c = 0; c < rack->counts[kind]; c++)
+        {
+            index += racks[kind + 1][size - c];
+        }
+        size -= rack->counts[kind];
+    }
+    return index;
+}
+
+// Returns the full rack of an index
+static void unrankRack(const unsigned int racks[TILE_KINDS + 1][MAX_LETTERS + 1], unsigned int index,
+                       TileCounts* rack)
+{
+    int size = MAX_LETTERS;
+    for (int kind = 0; kind < TILE_KINDS; kind++)
+    {
+        int c = 0;
+        while (index >= racks[kind + 1][size - c])
+        {
+            index -= racks[kind + 1][size - c];
+            c++;
+        }
+        rack->counts[kind] = (unsigned char)c;
+        size -= c;
+    }
+    rack->total = MAX_LETTERS;
+}
+
+// Returns the FNV-1a checksum of everything an opening's score depends on besides the words
+static unsigned long long rulesChecksum(void)
+{
+    Board board;
+    initBoard(board);
+
+    int values[2 * TILE_KINDS + 2 * LENGTH + 2];
+    int count = 0;
+    values[count++] = LENGTH;
+    values[count++] = MAX_LETTERS;
+    for (int kind = 0; kind < TILE_KINDS; kind++)
+    {
+        values[count++] = kindCount(kind);
+        values[count++] = kind == BLANK_KIND ? 0 : getLetterScore((char)(kind + 1));
+    }
+    for (int i = 0; i < LENGTH; i++)
+    {
+        values[count++] = board[LENGTH / 2][i].multiplier;
+        values[count++] = board[i][LENGTH / 2].multiplier;
+    }
+
+    unsigned long long hash = 14695981039346656037ull;
+    const unsigned char* bytes = (const unsigned char*)values;
+    for (size_t i = 0; i < count * sizeof(int); i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Returns whether the center column has the premiums of the center row, so a table of placements along
+// the row also answers for the column
+static bool centerLinesMatch(void)
+{
+    Board board;
+    initBoard(board);
+    for (int i = 0; i < LENGTH; i++)
+    {
+        if (board[LENGTH / 2][i].multiplier != board[i][LENGTH / 2].multiplier)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// --------------------
+// Anagram Index
+// --------------------
+
+// Represents the words sharing one sorted set of letters
+typedef struct
+{
+    unsigned long long key;        // Sorted letter codes, five bits each, the first in the lowest bits; 0 when unused
+    int first;                     // First of the words in the index's word order
+    int count;
+} AnagramGroup;
+
+// Represents the playable words of a list grouped by their letters
+typedef struct
+{
+    int* words;                    // Indices of the words in the list, grouped by key
+    AnagramGroup* groups;          // Open addressing table of the keys
+    unsigned int mask;             // Number of groups minus one
+    char* const* text;             // Words of the list
+} AnagramIndex;
+
+// Represents a word waiting to be grouped
+typedef struct
+{
+    unsigned long long key;
+    int word;
+} KeyedWord;
+
+// Packs sorted letter codes into a key
+static unsigned long long packLetters(const char* letters, int length)
+{
+    unsigned long long key = 0;
+    for (int i = 0; i < length; i++)
+    {
+        key |= (unsigned long long)letters[i] << (5 * i);
+    }
+    return key;
+}
+
+// Compares two keyed words by key, then by word
+static int compareKeyedWords(const void* a, const void* b)
+{
+    const KeyedWord* x = a;
+    const KeyedWord* y = b;
+    if (x->key != y->key)
+    {
+        return x->key < y->key ? -1 : 1;
+    }
+    return x->word - y->word;
+}
+
+// Groups the words an opening can lay, two to seven letters long, by their sorted letters
+static void buildAnagramIndex(const WordList* list, AnagramIndex* index)
+{
+    KeyedWord* keyed = malloc((list->count > 0 ? list->count : 1) * sizeof(KeyedWord));
+    if (!keyed)
+    {
+        perror("Error allocating anagram index");
+        exit(EXIT_FAILURE);
+    }
+    int count = 0;
+    for (int i = 0; i < list->count; i++)
+    {
+        int length = (int)strlen(list->words[i]);
+        if (length < 2 || length > MAX_LETTERS)
+        {
+            continue;
+        }
+        char sorted[MAX_LETTERS];
+        for (int j = 0; j < length; j++)
+        {
+            int k = j;
+            for (; k > 0 && sorted[k - 1] > list->words[i][j]; k--)
+            {
+                sorted[k] = sorted[k - 1];
+            }
+            sorted[k] = list->words[i][j];
+        }
+        keyed[count].key = packLetters(sorted, length);
+        keyed[count].word = i;
+        count++;
+    }
+    qsort(keyed, count, sizeof(KeyedWord), compareKeyedWords);
+
+    unsigned int size = 1;
+    while (size < 2u * (unsigned int)count + 1)
+    {
+        size *= 2;
+    }
+    index->words = malloc((count > 0 ? count : 1) * sizeof(int));
+    index->groups = calloc(size, sizeof(AnagramGroup));
+    if (!index->words || !index->groups)
+    {
+        perror("Error allocating anagram index");
+        exit(EXIT_FAILURE);
+    }
+    index->mask = size - 1;
+    index->text = list->words;
+
+    for (int i = 0; i < count;)
+    {
+        int end = i;
+        while (end < count && keyed[end].key == keyed[i].key)
+        {
+            index->words[end] = keyed[end].word;
+            end++;
+        }
+        unsigned int slot = (unsigned int)mixBits(keyed[i].key) & index->mask;
+        while (index->groups[slot].key != 0)
+        {
+            slot = (slot + 1) & index->mask;
+        }
+        index->groups[slot] = (AnagramGroup){keyed[i].key, i, end - i};
+        i = end;
+    }
+    free(keyed);
+}
+
+// Frees an anagram index
+static void freeAnagramIndex(AnagramIndex* index)
+{
+    free(index->words);
+    free(index->groups);
+}
+
+// Returns the group of the words with the given letters, or NULL
+static const AnagramGroup* findAnagrams(const AnagramIndex* index, unsigned long long key)
+{
+    unsigned int slot = (unsigned int)mixBits(key) & index->mask;
+    while (index->groups[slot].key != 0)
+    {
+        if (index->groups[slot].key == key)
+        {
+            return &index->groups[slot];
+        }
+        slot = (slot + 1) & index->mask;
+    }
+    return NULL;
+}
+
+// --------------------
+// Construction
+// --------------------
+
+// Represents what the build tasks share
+typedef struct
+{
+    OpeningTable* table;
+    AnagramIndex index;
+    int letterMultiplier[LENGTH];  // Premiums of the center row
+    int wordMultiplier[LENGTH];
+} OpeningBuild;
+
+// Represents one build task: a run of consecutive racks
+typedef struct
+{
+    OpeningBuild* build;
+    unsigned int first;
+    unsigned int count;
+} OpeningTask;
+
+// Represents the search of one rack's openings
+typedef struct
+{
+    const OpeningBuild* build;
+    int topMoves;
+    unsigned char counts[ALPHABET_SIZE];     // Letters of the rack not in 'chosen'
+    int blanks;
+    char chosen[MAX_LETTERS];                // Letters of the rack picked so far, sorted
+    int numChosen;
+    OpeningMove* best;                       // Row of the table, highest score first
+    int found;
+} RackSearch;
+
+// Keeps a placement if it is among the best of its rack so far; among equal scores the first stays ahead
+static void offerOpening(RackSearch* search, const char* word, int length, unsigned int blankMask, int column,
+                         int score)
+{
+    if (search->found == search->topMoves && score <= search->best[search->topMoves - 1].score)
+    {
+        return;
+    }
+    int i = search->found < search->topMoves ? search->found++ : search->topMoves - 1;
+    for (; i > 0 && search->best[i - 1].score < score; i--)
+    {
+        search->best[i] = search->best[i - 1];
+    }
+
+    OpeningMove* move = &search->best[i];
+    memset(move->letters, 0, MAX_LETTERS);
+    for (int j = 0; j < length; j++)
+    {
+        move->letters[j] = (char)(word[j] | ((blankMask >> j & 1) ? BLANK_TILE : 0));
+    }
+    move->column = (unsigned char)column;
+    move->score = (unsigned short)score;
+}
+
+// Offers every placement of a word through the center square with blanks on the given positions
+static void placeWord(RackSearch* search, const char* word, int length, unsigned int blankMask)
+{
+    const OpeningBuild* build = search->build;
+    int first = LENGTH / 2 - length + 1;
+    for (int column = first < 0 ? 0 : first; column <= LENGTH / 2 && column + length <= LENGTH; column++)
+    {
+        int sum = 0;
+        int multiplier = 1;
+        for (int j = 0; j < length; j++)
+        {
+            if (!(blankMask >> j & 1))
+            {
+                sum += getLetterScore(word[j]) * build->letterMultiplier[column + j];
+            }
+            multiplier *= build->wordMultiplier[column + j];
+        }
+        offerOpening(search, word, length, blankMask, column, sum * multiplier);
+    }
+}
+
+// Offers the words made of the chosen letters plus blanks playing as 'extra', in every way the blanks can
+// stand for those letters
+static void placeAnagrams(RackSearch* search, const char* extra, int numExtra)
+{
+    char letters[MAX_LETTERS];
+    int length = 0;
+    int e = 0;
+    for (int i = 0; i < search->numChosen; i++)
+    {
+        while (e < numExtra && extra[e] < search->chosen[i])
+        {
+            letters[length++] = extra[e++];
+        }
+        letters[length++] = search->chosen[i];
+    }
+    while (e < numExtra)
+    {
+        letters[length++] = extra[e++];
+    }
+
+    const AnagramGroup* group = findAnagrams(&search->build->index, packLetters(letters, length));
+    if (group == NULL)
+    {
+        return;
+    }
+    for (int w = 0; w < group->count; w++)
+    {
+        const char* word = search->build->index.text[search->build->index.words[group->first + w]];
+        if (numExtra == 0)
+        {
+            placeWord(search, word, length, 0);
+            continue;
+        }
+        for (int i = 0; i < length; i++)
+        {
+            if (numExtra == 1)
+            {
+                if (word[i] == extra[0])
+                {
+                    placeWord(search, word, length, 1u << i);
+                }
+                continue;
+            }
+            for (int j = i + 1; j < length; j++)
+            {
+                if ((word[i] == extra[0] && word[j] == extra[1]) || (word[i] == extra[1] && word[j] == extra[0]))
+                {
+                    placeWord(search, word, length, 1u << i | 1u << j);
+                }
+            }
+        }
+    }
+}
+
+// Tries the chosen letters with no blank, then with each letter and pair of letters a blank could play as
+static void placeChosen(RackSearch* search)
+{
+    if (search->numChosen >= 2)
+    {
+        placeAnagrams(search, NULL, 0);
+    }
+    if (search->blanks >= 1 && search->numChosen + 1 >= 2)
+    {
+        for (char x = 1; x <= ALPHABET_SIZE; x++)
+        {
+            placeAnagrams(search, &x, 1);
+        }
+    }
+    if (search->blanks >= 2)
+    {
+        for (char x = 1; x <= ALPHABET_SIZE; x++)
+        {
+            for (char y = x; y <= ALPHABET_SIZE; y++)
+            {
+                char pair[2] = {x, y};
+                placeAnagrams(search, pair, 2);
+            }
+        }
+    }
+}
+
+// Picks every sub-multiset of the rack's letters, from the given letter on
+static void chooseLetters(RackSearch* search, int letter)
+{
+    while (letter < ALPHABET_SIZE && search->counts[letter] == 0)
+    {
+        letter++;
+    }
+    if (letter == ALPHABET_SIZE)
+    {
+        placeChosen(search);
+        return;
+    }
+
+    int available = search->counts[letter];
+    int before = search->numChosen;
+    chooseLetters(search, letter + 1);
+    for (int c = 1; c <= available; c++)
+    {
+        search->chosen[search->numChosen++] = (char)(letter + 1);
+        chooseLetters(search, letter + 1);
+    }
+    search->numChosen = before;
+}
+
+// Fills the rows of a run of racks
+static void buildRacks(void* arg)
+{
+    OpeningTask* task = arg;
+    OpeningTable* table = task->build->table;
+    int topMoves = (int)table->header->topMoves;
+    RackSearch search;
+    search.build = task->build;
+    search.topMoves = topMoves;
+
+    for (unsigned int index = task->first; index < task->first + task->count; index++)
+    {
+        TileCounts rack;
+        unrankRack((const unsigned int (*)[MAX_LETTERS + 1])table->racks, index, &rack);
+        memcpy(search.counts, rack.counts, ALPHABET_SIZE);
+        search.blanks = rack.counts[BLANK_KIND];
+        search.numChosen = 0;
+        search.best = (OpeningMove*)table->moves + (size_t)index * topMoves;
+        search.found = 0;
+        chooseLetters(&search, 0);
+    }
+}
+
+// Builds the table of a word list, keeping 'topMoves' placements per rack, on the pool's threads, for a
+// layout whose center column has the premiums of its center row
+OpeningTable* buildOpeningTable(const WordList* list, int topMoves, ThreadPool* pool)
+{
+    if (!centerLinesMatch())
+    {
+        fprintf(stderr, "Error building opening table: the center row and column have different premiums\n");
+        return NULL;
+    }
+
+    OpeningTable* table = malloc(sizeof(OpeningTable));
+    if (!table)
+    {
+        perror("Error allocating opening table");
+        exit(EXIT_FAILURE);
+    }
+    countRacks(table->racks);
+    unsigned int numRacks = table->racks[0][MAX_LETTERS];
+    table->blockSize = sizeof(OpeningTableHeader) + (size_t)numRacks * topMoves * sizeof(OpeningMove);
+    table->block = calloc(1, table->blockSize);
+    if (!table->block)
+    {
+        perror("Error allocating opening table");
+        exit(EXIT_FAILURE);
+    }
+    table->mapped = false;
+
+    OpeningTableHeader* header = table->block;
+    memcpy(header->magic, "OPNT", 4);
+    header->version = OPENING_TABLE_VERSION;
+    header->numRacks = numRacks;
+    header->topMoves = (unsigned int)topMoves;
+    header->checksum = wordListChecksum(list->words, list->count);
+    header->rules = rulesChecksum();
+    table->header = header;
+    table->moves = (const OpeningMove*)(header + 1);
+
+    OpeningBuild build;
+    build.table = table;
+    buildAnagramIndex(list, &build.index);
+    Board board;
+    initBoard(board);
+    for (int x = 0; x < LENGTH; x++)
+    {
+        Multiplier multiplier = board[LENGTH / 2][x].multiplier;
+        build.letterMultiplier[x] = multiplier == Double_Letter ? 2 : multiplier == Triple_Letter ? 3
+                                  : multiplier == Quadruple_Letter ? 4 : 1;
+        build.wordMultiplier[x] = multiplier == Double_Word ? 2 : multiplier == Triple_Word ? 3
+                                : multiplier == Quadruple_Word ? 4 : 1;
+    }
+
+    unsigned int numTasks = (numRacks + RACKS_PER_TASK - 1) / RACKS_PER_TASK;
+    OpeningTask* tasks = malloc((numTasks > 0 ? numTasks : 1) * sizeof(OpeningTask));
+    if (!tasks)
+    {
+        perror("Error allocating opening table");
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned int t = 0; t < numTasks; t++)
+    {
+        tasks[t].build = &build;
+        tasks[t].first = t * RACKS_PER_TASK;
+        tasks[t].count = (numRacks - tasks[t].first < RACKS_PER_TASK) ? numRacks - tasks[t].first : RACKS_PER_TASK;
+        submitTask(pool, buildRacks, &tasks[t]);
+    }
+    waitForTasks(pool);
+
+    free(tasks);
+    freeAnagramIndex(&build.index);
+    return table;
+}
+
+// --------------------
+// Files
+// --------------------
+
+// Writes a table to a file, replacing the previous one atomically
+bool saveOpeningTable(const OpeningTable* table, const char* filename)
+{
+    // Write beside the old file and rename over it, so a reader never maps half a table
+    char temporary[1024];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", filename);
+    FILE* file = fopen(temporary, "wb");
+    if (!file)
+    {
+        perror("Error creating opening table file");
+        return false;
+    }
+    bool written = fwrite(table->block, 1, table->blockSize, file) == table->blockSize;
+    written = (fclose(file) == 0) && written;
+    if (!written || rename(temporary, filename) != 0)
+    {
+        perror("Error writing opening table file");
+        remove(temporary);
+        return false;
+    }
+    return true;
+}
+
+// Maps a table file read-only; returns NULL if it is missing or does not fit the lexicon and tile set
+OpeningTable* mapOpeningTable(const char* filename, const Lexicon* lexicon)
+{
+    int fd = open(filename, O_RDONLY);
+    struct stat info;
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(OpeningTableHeader))
+    {
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)info.st_size;
+    void* block = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (block == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    OpeningTable* table = malloc(sizeof(OpeningTable));
+    if (!table)
+    {
+        perror("Error allocating opening table");
+        exit(EXIT_FAILURE);
+    }
+    countRacks(table->racks);
+
+    // The rows must cover every rack of this tile set and the whole file
+    const OpeningTableHeader* header = block;
+    unsigned long long expected = sizeof(OpeningTableHeader) +
+                                  (unsigned long long)header->numRacks * header->topMoves * sizeof(OpeningMove);
+    if (memcmp(header->magic, "OPNT", 4) != 0 || header->version != OPENING_TABLE_VERSION || expected != size ||
+        header->topMoves == 0 || header->topMoves > MAX_OPENING_TOP_MOVES ||
+        header->numRacks != table->racks[0][MAX_LETTERS] || header->checksum != lexicon->checksum ||
+        header->rules != rulesChecksum() || !centerLinesMatch())
+    {
+        munmap(block, size);
+        free(table);
+        return NULL;
+    }
+
+    table->block = block;
+    table->blockSize = size;
+    table->mapped = true;
+    table->header = header;
+    table->moves = (const OpeningMove*)(header + 1);
+    return table;
+}
+
+// Frees or unmaps a table
+void freeOpeningTable(OpeningTable* table)
+{
+    if (!table)
+    {
+        return;
+    }
+    if (table->mapped)
+    {
+        munmap(table->block, table->blockSize);
+    }
+    else
+    {
+        free(table->block);
+    }
+    free(table);
+}
+
+// --------------------
+// Lookup
+// --------------------
+
+// Appends a move to a list, growing the storage when needed
+static void appendOpening(MoveList* list, const Move* move)
+{
+    if (list->count == list->capacity)
+    {
+        int capacity = list->capacity ? list->capacity * 2 : 2 * MAX_OPENING_TOP_MOVES;
+        Move* moves = realloc(list->moves, capacity * sizeof(Move));
+        if (!moves)
+        {
+            perror("Error allocating move list");
+            exit(EXIT_FAILURE);
+        }
+        list->moves = moves;
+        list->capacity = capacity;
+    }
+    list->moves[list->count++] = *move;
+}
+
+// Replaces the list's moves with the best openings of the rack, both ways through the center
+bool findOpeningMoves(const OpeningTable* table, const Game* game, const char rack[MAX_LETTERS], MoveList* list)
+{
+    if (table == NULL || game->board[LENGTH / 2][LENGTH / 2].is_placed)
+    {
+        return false;
+    }
+    TileCounts counts;
+    countTiles(rack, MAX_LETTERS, &counts);
+    if (counts.total != MAX_LETTERS)
+    {
+        return false;
+    }
+    for (int kind = 0; kind < TILE_KINDS; kind++)
+    {
+        if (counts.counts[kind] > kindCount(kind))
+        {
+            return false; // More of a tile than the bag holds: not a dealt rack
+        }
+    }
+
+    unsigned int topMoves = table->header->topMoves;
+    const OpeningMove* row = table->moves + (size_t)rankRack(table->racks, &counts) * topMoves;
+    if (row[0].letters[0] == '\0')
+    {
+        return false; // No opening: left to the move generator, which finds none either
+    }
+    clearMoveList(list);
+    for (unsigned int i = 0; i < topMoves && row[i].letters[0] != '\0'; i++)
+    {
+        Move across;
+        Move down;
+        across.numLetters = 0;
+        for (int j = 0; j < MAX_LETTERS && row[i].letters[j] != '\0'; j++)
+        {
+            across.squares[j] = (Coordinate){row[i].column + j, LENGTH / 2};
+            across.letters[j] = row[i].letters[j];
+            across.numLetters++;
+        }
+        across.score = row[i].score;
+        down = across;
+        for (int j = 0; j < down.numLetters; j++)
+        {
+            down.squares[j] = (Coordinate){LENGTH / 2, row[i].column + j};
+        }
+        appendOpening(list, &across);
+        appendOpening(list, &down);
+    }
+    return true;
+}
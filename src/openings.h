@@ -0,0 +1,96 @@
+// openings.h
+
+#ifndef OPENINGS_H
+#define OPENINGS_H
+
+#include "movegen.h"
+#include "inference.h"
+#include "wordlist.h"
+#include <stddef.h>
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Version written in new opening tables and the only one mapOpeningTable accepts
+#define OPENING_TABLE_VERSION 1
+
+// Placements kept per rack unless the builder is asked for another number
+#define OPENING_TOP_MOVES 4
+
+// Most placements a table may keep per rack
+#define MAX_OPENING_TOP_MOVES 16
+
+// The opening move must cross the center square of an empty board, so its best placements depend on
+// the rack alone. An opening table holds them for every rack a full bag can deal: the seven tiles are
+// counted as a multiset, which is ranked to a dense index, and the index picks a fixed row of the
+// highest scoring placements. Only placements along the center row are kept; each also stands for the
+// same word down the center column, so no table is built or mapped for a layout whose center column has
+// other premiums than its center row.
+//
+// The table lives in one block laid out as its file, so a saved table is mapped and used in place:
+//
+//   header          OpeningTableHeader
+//   moves           numRacks rows of topMoves OpeningMove, highest score first
+//
+// A table depends on the word list it was built from, the tile values and counts and the premium
+// squares; a table built for other ones is not mapped.
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents the start of a table block
+typedef struct
+{
+    char magic[4];                 // "OPNT"
+    unsigned int version;
+    unsigned int numRacks;         // Number of distinct seven-tile racks, and of rows
+    unsigned int topMoves;         // Placements per row
+    unsigned long long checksum;   // FNV-1a of the word list the table was built from
+    unsigned long long rules;      // FNV-1a of the tile set and the center row and column premiums
+} OpeningTableHeader;
+
+// Represents one placement along the center row
+typedef struct
+{
+    char letters[MAX_LETTERS];     // Tiles from left to right, BLANK_TILE | letter for a blank; '\0' after the last
+    unsigned char column;          // Column of the first tile
+    unsigned short score;
+} OpeningMove;
+
+// Represents the opening placements of every rack, built in memory or mapped from a file
+typedef struct OpeningTable
+{
+    const OpeningTableHeader* header;
+    const OpeningMove* moves;
+    unsigned int racks[TILE_KINDS + 1][MAX_LETTERS + 1]; // Racks of each size drawn from the kinds from each one on
+    void* block;                   // Whole table as laid out in its file
+    size_t blockSize;
+    bool mapped;                   // The block is a mapping of a file rather than heap memory
+} OpeningTable;
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Builds the table of a word list, keeping 'topMoves' placements per rack, on the pool's threads; returns
+// NULL if the board layout has other premiums down the center column than along the center row
+OpeningTable* buildOpeningTable(const WordList* list, int topMoves, ThreadPool* pool);
+
+// Writes a table to a file, replacing the previous one atomically; returns false on failure
+bool saveOpeningTable(const OpeningTable* table, const char* filename);
+
+// Maps a table file read-only; returns NULL if it is missing, truncated, of another version or built
+// for another lexicon or tile set
+OpeningTable* mapOpeningTable(const char* filename, const Lexicon* lexicon);
+
+// Frees or unmaps a table
+void freeOpeningTable(OpeningTable* table);
+
+// Replaces the list's moves with the best openings of the rack, both ways through the center, highest
+// score first; returns false if the table is NULL, the board is not empty, the rack is not full or it has
+// no opening, so a true answer always lists at least one move
+bool findOpeningMoves(const OpeningTable* table, const Game* game, const char rack[MAX_LETTERS], MoveList* list);
+
+#endif // OPENINGS_H
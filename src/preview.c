@@ -0,0 +1,163 @@
+// preview.c
+
+#include "preview.h"
+#include <string.h>
+
+// --------------------
+// Word Helpers
+// --------------------
+
+// Finds the word running through a square in one direction and returns its length
+static int findWordSpan(const Game* game, int x, int y, bool horizontal, int* xStart, int* yStart)
+{
+    int dx = horizontal ? 1 : 0;
+    int dy = horizontal ? 0 : 1;
+
+    // Move to the first letter of the word
+    while (x - dx >= 0 && y - dy >= 0 && game->board[y - dy][x - dx].is_placed)
+    {
+        x -= dx;
+        y -= dy;
+    }
+    *xStart = x;
+    *yStart = y;
+
+    // Count letters up to the last one
+    int length = 0;
+    while (x < LENGTH && y < LENGTH && game->board[y][x].is_placed)
+    {
+        length++;
+        x += dx;
+        y += dy;
+    }
+    return length;
+}
+
+// Checks if two cached words cover the same squares
+static bool sameSpan(const PreviewWord* a, int xStart, int yStart, int length, bool horizontal)
+{
+    return a->xStart == xStart && a->yStart == yStart && a->length == length && a->horizontal == horizontal;
+}
+
+// Checks if a cached word covers a square
+static bool coversSquare(const PreviewWord* word, Coordinate square)
+{
+    if (word->horizontal)
+    {
+        return square.y == word->yStart && square.x >= word->xStart && square.x < word->xStart + word->length;
+    }
+    return square.x == word->xStart && square.y >= word->yStart && square.y < word->yStart + word->length;
+}
+
+// Reads, validates and scores a word that was not cached
+static void evaluateWord(ScorePreview* preview, PreviewWord* entry, const Game* game)
+{
+    for (int i = 0; i < entry->length; i++)
+    {
+        int xi = entry->horizontal ? entry->xStart + i : entry->xStart;
+        int yi = entry->horizontal ? entry->yStart : entry->yStart + i;
+        entry->word[i] = game->board[yi][xi].letter;
+    }
+    entry->word[entry->length] = '\0';
+
+    entry->valid = isValidWord(game->lexicon, entry->word);
+    entry->score = calculateWordScore(game, entry->word, entry->xStart, entry->yStart, entry->horizontal);
+    preview->lookups++;
+}
+
+// --------------------
+// Preview Functions
+// --------------------
+
+// Clears the preview, as when no tile is placed
+void resetScorePreview(ScorePreview* preview)
+{
+    preview->numWords = 0;
+    preview->valid = false;
+    preview->score = -1;
+    preview->lookups = 0;
+}
+
+// Recomputes the preview after the tile at 'changed' was placed or removed
+void updateScorePreview(ScorePreview* preview, const Game* game, const Coordinate placedLetters[],
+                        int numPlacedLetters, Coordinate changed)
+{
+    ScorePreview previous = *preview;
+    resetScorePreview(preview);
+
+    if (numPlacedLetters <= 0)
+    {
+        return;
+    }
+
+    // Collect the words in the order validateAndScoreWords visits them
+    for (int i = 0; i < numPlacedLetters; i++)
+    {
+        for (int direction = 0; direction < 2; direction++)
+        {
+            bool horizontal = (direction == 0);
+            int xStart, yStart;
+            int length = findWordSpan(game, placedLetters[i].x, placedLetters[i].y, horizontal, &xStart, &yStart);
+            if (length <= 1)
+            {
+                continue;
+            }
+
+            // Several tiles on the same line share their main word
+            bool seen = false;
+            for (int w = 0; w < preview->numWords && !seen; w++)
+            {
+                seen = sameSpan(&preview->words[w], xStart, yStart, length, horizontal);
+            }
+            if (seen || preview->numWords == MAX_PREVIEW_WORDS)
+            {
+                continue;
+            }
+
+            PreviewWord* entry = &preview->words[preview->numWords++];
+
+            // Reuse the previous result when the changed tile is not part of this word
+            bool cached = false;
+            for (int w = 0; w < previous.numWords && !cached; w++)
+            {
+                if (sameSpan(&previous.words[w], xStart, yStart, length, horizontal) &&
+                    !coversSquare(&previous.words[w], changed))
+                {
+                    *entry = previous.words[w];
+                    cached = true;
+                }
+            }
+
+            if (!cached)
+            {
+                entry->xStart = xStart;
+                entry->yStart = yStart;
+                entry->length = length;
+                entry->horizontal = horizontal;
+                evaluateWord(preview, entry, game);
+            }
+        }
+    }
+
+    // Add up the words like validateAndScoreWords does, counting repeated words once
+    int total = 0;
+    bool valid = true;
+    for (int w = 0; w < preview->numWords; w++)
+    {
+        const PreviewWord* entry = &preview->words[w];
+        valid = valid && entry->valid;
+
+        bool repeated = false;
+        for (int s = 0; s < w && !repeated; s++)
+        {
+            repeated = strcmp(preview->words[s].word, entry->word) == 0;
+        }
+        if (!repeated)
+        {
+            total += entry->score;
+        }
+    }
+
+    preview->valid = valid;
+    preview->score = valid ? total : -1;
+}
@@ -0,0 +1,49 @@
+// preview.h
+
+#ifndef PREVIEW_H
+#define PREVIEW_H
+
+#include "scrabble.h"
+
+// Maximum number of words a move can form: one along the line plus one across each tile
+#define MAX_PREVIEW_WORDS (2 * MAX_LETTERS)
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents one word formed by the tentative tiles, cached between updates
+typedef struct
+{
+    int xStart;                    // Column of the first letter
+    int yStart;                    // Row of the first letter
+    int length;                    // Number of letters
+    bool horizontal;               // Direction of the word
+    char word[LENGTH + 1];         // Letters of the word as they appear on the board
+    bool valid;                    // Indicates if the word is in the dictionary
+    int score;                     // Score of the word as computed by calculateWordScore
+} PreviewWord;
+
+// Represents the running validation and score of the tiles placed this turn
+typedef struct
+{
+    PreviewWord words[MAX_PREVIEW_WORDS]; // Words formed by the tentative tiles
+    int numWords;                  // Number of cached words
+    bool valid;                    // Indicates if every word is valid
+    int score;                     // Score the move would earn, or -1 if it is invalid
+    int lookups;                   // Dictionary lookups done by the last update
+} ScorePreview;
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Clears the preview, as when no tile is placed
+void resetScorePreview(ScorePreview* preview);
+
+// Recomputes the preview after the tile at 'changed' was placed or removed
+// Words that do not cross the changed square are reused from the previous update
+void updateScorePreview(ScorePreview* preview, const Game* game, const Coordinate placedLetters[],
+                        int numPlacedLetters, Coordinate changed);
+
+#endif // PREVIEW_H
@@ -0,0 +1,135 @@
+// profiler.c
+
+#include "profiler.h"
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+// --------------------
+// Sample Storage
+// --------------------
+
+// Represents the rolling window of one metric
+typedef struct
+{
+    double samples[PROFILER_WINDOW]; // Ring buffer of samples
+    int next;                        // Slot the next sample goes to
+    int count;                       // Number of valid samples
+    unsigned long total;             // Samples recorded since start, including overwritten ones
+} MetricWindow;
+
+static MetricWindow windows[Metric_Count];
+static pthread_mutex_t profilerMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const char* metricNames[Metric_Count] = {
+    "frame",
+    "drawBoard",
+    "drawPanel",
+    "cloneGame",
+    "input",
+    "validateAndScoreWords",
+    "scorePreview",
+    "hintSearch",
+    "lookupsPerMove",
+};
+
+// --------------------
+// Profiler Functions
+// --------------------
+
+// Returns a monotonic timestamp in microseconds
+double profilerNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+// Adds a sample to a metric; safe to call from any thread
+void recordMetric(Metric metric, double value)
+{
+    pthread_mutex_lock(&profilerMutex);
+    MetricWindow* window = &windows[metric];
+    window->samples[window->next] = value;
+    window->next = (window->next + 1) % PROFILER_WINDOW;
+    if (window->count < PROFILER_WINDOW)
+    {
+        window->count++;
+    }
+    window->total++;
+    pthread_mutex_unlock(&profilerMutex);
+}
+
+// Finds the power-of-two bucket of a sample
+static int bucketOf(double value)
+{
+    int bucket = 0;
+    while (bucket < PROFILER_BUCKETS - 1 && value >= (double)(2UL << bucket))
+    {
+        bucket++;
+    }
+    return bucket;
+}
+
+// Summarizes the recent samples of a metric
+void getMetricStats(Metric metric, MetricStats* stats)
+{
+    *stats = (MetricStats){0};
+
+    pthread_mutex_lock(&profilerMutex);
+    const MetricWindow* window = &windows[metric];
+    double sum = 0.0;
+    for (int i = 0; i < window->count; i++)
+    {
+        double value = window->samples[i];
+        sum += value;
+        if (value > stats->max)
+        {
+            stats->max = value;
+        }
+        stats->histogram[bucketOf(value)]++;
+    }
+    stats->samples = window->count;
+    if (window->count > 0)
+    {
+        stats->last = window->samples[(window->next + PROFILER_WINDOW - 1) % PROFILER_WINDOW];
+        stats->average = sum / window->count;
+    }
+    pthread_mutex_unlock(&profilerMutex);
+}
+
+// Returns the display name of a metric
+const char* metricName(Metric metric)
+{
+    return metricNames[metric];
+}
+
+// Writes every sample in the window of each metric to a CSV file, oldest first
+bool dumpMetricsCsv(const char* filename)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+    {
+        perror("Error creating metrics file");
+        return false;
+    }
+
+    fprintf(file, "metric,sample,value\n");
+
+    pthread_mutex_lock(&profilerMutex);
+    for (int metric = 0; metric < Metric_Count; metric++)
+    {
+        const MetricWindow* window = &windows[metric];
+        unsigned long first = window->total - window->count;
+        int start = (window->next + PROFILER_WINDOW - window->count) % PROFILER_WINDOW;
+        for (int i = 0; i < window->count; i++)
+        {
+            fprintf(file, "%s,%lu,%.3f\n", metricNames[metric], first + i,
+                    window->samples[(start + i) % PROFILER_WINDOW]);
+        }
+    }
+    pthread_mutex_unlock(&profilerMutex);
+
+    fclose(file);
+    return true;
+}
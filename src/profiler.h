@@ -0,0 +1,70 @@
+// profiler.h
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Number of recent samples kept per metric
+#define PROFILER_WINDOW 1024
+
+// Number of power-of-two buckets in each histogram
+#define PROFILER_BUCKETS 16
+
+// --------------------
+// Enumerations
+// --------------------
+
+// Represents each quantity tracked by the profiler
+typedef enum
+{
+    Metric_Frame,                  // CPU time of a whole frame, in microseconds
+    Metric_DrawBoard,              // Time spent drawing the board, in microseconds
+    Metric_DrawPanel,              // Time spent drawing the control panel and its buttons, in microseconds
+    Metric_CloneGame,              // Time spent refreshing the working copy of the game, in microseconds
+    Metric_Input,                  // Time spent resolving clicks on the board, in microseconds
+    Metric_Validate,               // Latency of validateAndScoreWords for a submitted move, in microseconds
+    Metric_Preview,                // Latency of the live score preview update, in microseconds
+    Metric_HintSearch,             // Duration of a background hint search, in microseconds
+    Metric_Lookups,                // Dictionary lookups done to validate a submitted move
+    Metric_Count,
+} Metric;
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents a summary of the recent samples of one metric
+typedef struct
+{
+    int samples;                   // Number of samples in the window
+    double last;                   // Most recent sample
+    double average;                // Mean of the window
+    double max;                    // Largest sample of the window
+    int histogram[PROFILER_BUCKETS]; // Bucket b counts samples in [2^b, 2^(b+1)), bucket 0 also counts smaller ones
+} MetricStats;
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Returns a monotonic timestamp in microseconds
+double profilerNow(void);
+
+// Adds a sample to a metric; safe to call from any thread
+void recordMetric(Metric metric, double value);
+
+// Summarizes the recent samples of a metric
+void getMetricStats(Metric metric, MetricStats* stats);
+
+// Returns the display name of a metric
+const char* metricName(Metric metric);
+
+// Writes every sample in the window of each metric to a CSV file
+bool dumpMetricsCsv(const char* filename);
+
+#endif // PROFILER_H
@@ -0,0 +1,635 @@
+// record.c
+
+#include "record.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Bytes every record file starts with
+static const unsigned char recordMagic[4] = {'S', 'C', 'R', 'B'};
+
+// --------------------
+// Letter Helpers
+// --------------------
+
+// Returns the rack counter a tile goes to: its letter code, RECORD_BLANK_SLOT for a blank, 0 for none
+static int tileSlot(char tile)
+{
+    if (isBlankTile(tile))
+    {
+        return RECORD_BLANK_SLOT;
+    }
+    return isLetterCode(tile) ? tile : 0;
+}
+
+// Returns the rack tile a counter holds
+static char slotTile(int slot)
+{
+    return (slot == RECORD_BLANK_SLOT) ? BLANK_TILE : (char)slot;
+}
+
+// Counts the letters of a rack by code
+static void countRack(const char rack[MAX_LETTERS], int counts[RECORD_RACK_SLOTS])
+{
+    memset(counts, 0, RECORD_RACK_SLOTS * sizeof(int));
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        counts[tileSlot(rack[i])]++;
+    }
+    counts[0] = 0;
+}
+
+// Returns a player's rack
+static const char* rackOf(const Game* game, PlayerTurn player)
+{
+    return (player == Player1) ? game->player1.letters : game->player2.letters;
+}
+
+// --------------------
+// Writer Functions
+// --------------------
+
+// Writes the buffered events to the file
+void flushRecordWriter(RecordWriter* writer)
+{
+    if (writer == NULL || writer->used == 0)
+    {
+        return;
+    }
+    if (fwrite(writer->buffer, 1, writer->used, writer->file) != writer->used)
+    {
+        perror("Error writing game record");
+    }
+    writer->used = 0;
+}
+
+// Appends a byte to the buffer
+static void putByte(RecordWriter* writer, unsigned char byte)
+{
+    if (writer->used == RECORD_BUFFER_SIZE)
+    {
+        flushRecordWriter(writer);
+    }
+    writer->buffer[writer->used++] = byte;
+}
+
+// Appends an unsigned LEB128 varint
+static void putVarint(RecordWriter* writer, unsigned long long value)
+{
+    while (value >= 0x80)
+    {
+        putByte(writer, (unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    putByte(writer, (unsigned char)value);
+}
+
+// Appends the tiles a player holds now and did not hold before, then remembers the new rack
+static void putDrawn(RecordWriter* writer, PlayerTurn player, const char rack[MAX_LETTERS])
+{
+    int counts[RECORD_RACK_SLOTS];
+    countRack(rack, counts);
+
+    int numDrawn = 0;
+    for (int slot = 1; slot < RECORD_RACK_SLOTS; slot++)
+    {
+        int drawn = counts[slot] - writer->rackCounts[player][slot];
+        numDrawn += drawn > 0 ? drawn : 0;
+    }
+    putByte(writer, (unsigned char)numDrawn);
+    for (int slot = 1; slot < RECORD_RACK_SLOTS; slot++)
+    {
+        for (int drawn = counts[slot] - writer->rackCounts[player][slot]; drawn > 0; drawn--)
+        {
+            putByte(writer, (unsigned char)slot);
+        }
+    }
+    memcpy(writer->rackCounts[player], counts, sizeof(counts));
+}
+
+// Opens a record file for appending, writing the header if it is new; returns NULL on failure
+RecordWriter* openRecordWriter(const char* filename)
+{
+    FILE* file = fopen(filename, "ab");
+    if (!file)
+    {
+        perror("Error opening game record");
+        return NULL;
+    }
+
+    RecordWriter* writer = malloc(sizeof(RecordWriter));
+    if (!writer)
+    {
+        perror("Error allocating record writer");
+        exit(EXIT_FAILURE);
+    }
+    writer->file = file;
+    writer->used = 0;
+    memset(writer->rackCounts, 0, sizeof(writer->rackCounts));
+
+    fseek(file, 0, SEEK_END);
+    if (ftell(file) == 0)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            putByte(writer, recordMagic[i]);
+        }
+        putByte(writer, RECORD_VERSION);
+        putByte(writer, LENGTH);
+    }
+    return writer;
+}
+
+// Flushes the buffered events and closes the file
+void closeRecordWriter(RecordWriter* writer)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+    flushRecordWriter(writer);
+    fclose(writer->file);
+    free(writer);
+}
+
+// Records a newly dealt game and its starting racks
+void recordGameStart(RecordWriter* writer, unsigned long long seed, const Game* game)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+    putByte(writer, Record_GameStart);
+    putVarint(writer, seed);
+
+    memset(writer->rackCounts, 0, sizeof(writer->rackCounts));
+    putDrawn(writer, Player1, game->player1.letters);
+    putDrawn(writer, Player2, game->player2.letters);
+}
+
+// Records tiles laid by a player; 'game' is the state after the play, with the rack refilled
+void recordPlay(RecordWriter* writer, const Game* game, PlayerTurn player,
+                const Coordinate squares[], const char letters[], int numLetters, int score)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+
+    // Sort the tiles in board order so the squares can be stored as small deltas
+    int order[MAX_LETTERS];
+    for (int i = 0; i < numLetters; i++)
+    {
+        int j = i;
+        while (j > 0 && squares[order[j - 1]].y * LENGTH + squares[order[j - 1]].x > squares[i].y * LENGTH + squares[i].x)
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    putByte(writer, (unsigned char)(Record_Play | (player << 4)));
+    putByte(writer, (unsigned char)numLetters);
+    int previous = 0;
+    for (int i = 0; i < numLetters; i++)
+    {
+        int index = squares[order[i]].y * LENGTH + squares[order[i]].x;
+        putVarint(writer, (unsigned long long)(index - previous));
+        previous = index;
+    }
+
+    // The letters played leave the rack before the new ones are counted
+    for (int i = 0; i < numLetters; i++)
+    {
+        putByte(writer, (unsigned char)letters[order[i]]);
+        writer->rackCounts[player][tileSlot(letters[order[i]])]--;
+    }
+    putVarint(writer, (unsigned long long)score);
+    putDrawn(writer, player, rackOf(game, player));
+}
+
+// Records a player swapping the whole rack; 'game' is the state after the swap
+void recordReroll(RecordWriter* writer, const Game* game, PlayerTurn player)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+    putByte(writer, (unsigned char)(Record_Reroll | (player << 4)));
+    memset(writer->rackCounts[player], 0, sizeof(writer->rackCounts[player]));
+    putDrawn(writer, player, rackOf(game, player));
+}
+
+// Records a player swapping some of the rack's tiles; 'game' is the state after the exchange
+void recordExchange(RecordWriter* writer, const Game* game, PlayerTurn player, const char returned[],
+                    int numReturned)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+    putByte(writer, (unsigned char)(Record_Exchange | (player << 4)));
+    putByte(writer, (unsigned char)numReturned);
+    for (int i = 0; i < numReturned; i++)
+    {
+        putByte(writer, (unsigned char)tileSlot(returned[i]));
+        writer->rackCounts[player][tileSlot(returned[i])]--;
+    }
+    putDrawn(writer, player, rackOf(game, player));
+}
+
+// Records a player asking to end the game
+void recordEnd(RecordWriter* writer, PlayerTurn player)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+    putByte(writer, (unsigned char)(Record_End | (player << 4)));
+}
+
+// Closes the record of a game with its final scores
+void recordGameEnd(RecordWriter* writer, const Game* game)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+    putByte(writer, Record_GameEnd);
+    putVarint(writer, (unsigned long long)game->player1.score);
+    putVarint(writer, (unsigned long long)game->player2.score);
+}
+
+// --------------------
+// Reader Functions
+// --------------------
+
+// Returns the next byte of the file, or -1 at its end
+static int getByte(RecordReader* reader)
+{
+    if (reader->position == reader->length)
+    {
+        reader->length = fread(reader->buffer, 1, RECORD_BUFFER_SIZE, reader->file);
+        reader->position = 0;
+        if (reader->length == 0)
+        {
+            return -1;
+        }
+    }
+    return reader->buffer[reader->position++];
+}
+
+// Reads an unsigned LEB128 varint; returns false if the file ends inside it
+static bool getVarint(RecordReader* reader, unsigned long long* value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int byte = getByte(reader);
+        if (byte < 0)
+        {
+            return false;
+        }
+        *value |= (unsigned long long)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reads a list of drawn tiles and adds them to the player's rack
+static bool getDrawn(RecordReader* reader, GameEvent* event, PlayerTurn player)
+{
+    int count = getByte(reader);
+    if (count < 0 || count > MAX_LETTERS)
+    {
+        return false;
+    }
+    event->numDrawn = count;
+    for (int i = 0; i < count; i++)
+    {
+        int slot = getByte(reader);
+        if (slot < 1 || slot >= RECORD_RACK_SLOTS)
+        {
+            return false;
+        }
+        event->drawn[i] = slotTile(slot);
+        reader->rackCounts[player][slot]++;
+    }
+    return true;
+}
+
+// Writes the tracked racks into the event
+static void fillRacks(const RecordReader* reader, GameEvent* event)
+{
+    for (int player = 0; player < 2; player++)
+    {
+        int slot = 0;
+        memset(event->racks[player], '\0', MAX_LETTERS);
+        for (int counter = 1; counter < RECORD_RACK_SLOTS; counter++)
+        {
+            for (int n = 0; n < reader->rackCounts[player][counter] && slot < MAX_LETTERS; n++)
+            {
+                event->racks[player][slot++] = slotTile(counter);
+            }
+        }
+    }
+}
+
+// Opens a record file for reading and checks its header; returns NULL on failure
+RecordReader* openRecordReader(const char* filename)
+{
+    FILE* file = fopen(filename, "rb");
+    if (!file)
+    {
+        perror("Error opening game record");
+        return NULL;
+    }
+
+    RecordReader* reader = malloc(sizeof(RecordReader));
+    if (!reader)
+    {
+        perror("Error allocating record reader");
+        exit(EXIT_FAILURE);
+    }
+    reader->file = file;
+    reader->length = 0;
+    reader->position = 0;
+    memset(reader->rackCounts, 0, sizeof(reader->rackCounts));
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (getByte(reader) != recordMagic[i])
+        {
+            fprintf(stderr, "%s is not a game record\n", filename);
+            closeRecordReader(reader);
+            return NULL;
+        }
+    }
+    int version = getByte(reader);
+    if (version != RECORD_VERSION && version != RECORD_VERSION_UNSIZED)
+    {
+        fprintf(stderr, "%s has an unsupported record version\n", filename);
+        closeRecordReader(reader);
+        return NULL;
+    }
+    int size = (version == RECORD_VERSION) ? getByte(reader) : 15;
+    if (size != LENGTH)
+    {
+        fprintf(stderr, "%s records games on a %d x %d board\n", filename, size, size);
+        closeRecordReader(reader);
+        return NULL;
+    }
+    return reader;
+}
+
+// Closes the reader
+void closeRecordReader(RecordReader* reader)
+{
+    if (reader != NULL)
+    {
+        fclose(reader->file);
+        free(reader);
+    }
+}
+
+// Reads the next event; returns false at the end of the file or on a malformed record
+bool readGameEvent(RecordReader* reader, GameEvent* event)
+{
+    int tag = getByte(reader);
+    if (tag < 0)
+    {
+        return false;
+    }
+
+    event->type = (RecordType)(tag & 0x0f);
+    event->player = (tag & 0x10) ? Player2 : Player1;
+    event->numLetters = 0;
+    event->numDrawn = 0;
+    event->score = 0;
+
+    unsigned long long value;
+    switch (event->type)
+    {
+    case Record_GameStart:
+        if (!getVarint(reader, &event->seed))
+        {
+            return false;
+        }
+        memset(reader->rackCounts, 0, sizeof(reader->rackCounts));
+        if (!getDrawn(reader, event, Player1) || !getDrawn(reader, event, Player2))
+        {
+            return false;
+        }
+        event->numDrawn = 0;
+        break;
+
+    case Record_Play:
+    {
+        int count = getByte(reader);
+        if (count < 1 || count > MAX_LETTERS)
+        {
+            return false;
+        }
+        event->numLetters = count;
+        unsigned long long index = 0;
+        for (int i = 0; i < count; i++)
+        {
+            if (!getVarint(reader, &value))
+            {
+                return false;
+            }
+            index += value;
+            if (index >= LENGTH * LENGTH)
+            {
+                return false;
+            }
+            event->squares[i] = (Coordinate){(int)(index % LENGTH), (int)(index / LENGTH)};
+        }
+        for (int i = 0; i < count; i++)
+        {
+            int letter = getByte(reader);
+            if (letter < 0 || !isLetterCode(tileLetter((char)letter)))
+            {
+                return false;
+            }
+            event->letters[i] = (char)letter;
+            reader->rackCounts[event->player][tileSlot((char)letter)]--;
+        }
+        if (!getVarint(reader, &value) || !getDrawn(reader, event, event->player))
+        {
+            return false;
+        }
+        event->score = (int)value;
+        break;
+    }
+
+    case Record_Reroll:
+        memset(reader->rackCounts[event->player], 0, sizeof(reader->rackCounts[event->player]));
+        if (!getDrawn(reader, event, event->player))
+        {
+            return false;
+        }
+        break;
+
+    case Record_Exchange:
+    {
+        int count = getByte(reader);
+        if (count < 1 || count > MAX_LETTERS)
+        {
+            return false;
+        }
+        event->numLetters = count;
+        for (int i = 0; i < count; i++)
+        {
+            int slot = getByte(reader);
+            if (slot < 1 || slot >= RECORD_RACK_SLOTS)
+            {
+                return false;
+            }
+            event->letters[i] = slotTile(slot);
+            reader->rackCounts[event->player][slot]--;
+        }
+        if (!getDrawn(reader, event, event->player))
+        {
+            return false;
+        }
+        break;
+    }
+
+    case Record_End:
+        break;
+
+    case Record_GameEnd:
+        for (int player = 0; player < 2; player++)
+        {
+            if (!getVarint(reader, &value))
+            {
+                return false;
+            }
+            event->finalScores[player] = (int)value;
+        }
+        break;
+
+    default:
+        return false;
+    }
+
+    fillRacks(reader, event);
+    return true;
+}
+
+// --------------------
+// Replay
+// --------------------
+
+// Takes one tile of the given letter out of the bag
+static void takeFromBag(LetterBag* bag, char letter)
+{
+    for (int i = 0; i < bag->remaining; i++)
+    {
+        if (bag->letters[i] == letter)
+        {
+            bag->letters[i] = bag->letters[bag->remaining - 1];
+            bag->remaining--;
+            return;
+        }
+    }
+}
+
+// Applies an event to a game, drawing the recorded tiles instead of random ones
+void applyGameEvent(Game* game, const Lexicon* lexicon, const GameEvent* event)
+{
+    Player* player = (event->player == Player1) ? &game->player1 : &game->player2;
+
+    switch (event->type)
+    {
+    case Record_GameStart:
+        resetBoard(game);
+        initLetterBag(&game->bag, event->seed);
+        game->turn = Player1;
+        game->player1.score = 0;
+        game->player2.score = 0;
+        game->gameOver = false;
+        game->player1WantsToEnd = false;
+        game->player2WantsToEnd = false;
+        game->lexicon = lexicon;
+        memcpy(game->player1.letters, event->racks[Player1], MAX_LETTERS);
+        memcpy(game->player2.letters, event->racks[Player2], MAX_LETTERS);
+        for (int i = 0; i < MAX_LETTERS; i++)
+        {
+            if (game->player1.letters[i] != '\0')
+            {
+                takeFromBag(&game->bag, game->player1.letters[i]);
+            }
+            if (game->player2.letters[i] != '\0')
+            {
+                takeFromBag(&game->bag, game->player2.letters[i]);
+            }
+        }
+        break;
+
+    case Record_Play:
+        for (int i = 0; i < event->numLetters; i++)
+        {
+            setSquare(game, event->squares[i].x, event->squares[i].y, event->letters[i]);
+        }
+        player->score += event->score;
+        for (int i = 0; i < event->numDrawn; i++)
+        {
+            takeFromBag(&game->bag, event->drawn[i]);
+        }
+        memcpy(player->letters, event->racks[event->player], MAX_LETTERS);
+        game->turn = (event->player == Player1) ? Player2 : Player1;
+        break;
+
+    case Record_Reroll:
+        for (int i = 0; i < MAX_LETTERS; i++)
+        {
+            if (player->letters[i] != '\0')
+            {
+                game->bag.letters[game->bag.remaining++] = player->letters[i];
+            }
+        }
+        for (int i = 0; i < event->numDrawn; i++)
+        {
+            takeFromBag(&game->bag, event->drawn[i]);
+        }
+        memcpy(player->letters, event->racks[event->player], MAX_LETTERS);
+        game->turn = (event->player == Player1) ? Player2 : Player1;
+        break;
+
+    case Record_Exchange:
+        // The replacements were drawn before the swapped tiles went back
+        for (int i = 0; i < event->numDrawn; i++)
+        {
+            takeFromBag(&game->bag, event->drawn[i]);
+        }
+        for (int i = 0; i < event->numLetters; i++)
+        {
+            game->bag.letters[game->bag.remaining++] = event->letters[i];
+        }
+        memcpy(player->letters, event->racks[event->player], MAX_LETTERS);
+        game->turn = (event->player == Player1) ? Player2 : Player1;
+        break;
+
+    case Record_End:
+        if (event->player == Player1)
+        {
+            game->player1WantsToEnd = true;
+        }
+        else
+        {
+            game->player2WantsToEnd = true;
+        }
+        game->turn = (event->player == Player1) ? Player2 : Player1;
+        game->gameOver = game->player1WantsToEnd && game->player2WantsToEnd;
+        break;
+
+    case Record_GameEnd:
+        // Only marks where the game's events stop; an abandoned game is left as it was
+        break;
+    }
+}
@@ -0,0 +1,147 @@
+// record.h
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#include "scrabble.h"
+#include <stdio.h>
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Version written in the header of new record files
+#define RECORD_VERSION 4
+
+// Last version without the board size byte; record readers still open it as a 15 x 15 record
+#define RECORD_VERSION_UNSIZED 3
+
+// Size of the writer and reader buffers
+#define RECORD_BUFFER_SIZE 65536
+
+// Rack counters kept per player: one per letter code, then one for blanks (counter 0 is unused)
+#define RECORD_BLANK_SLOT (ALPHABET_SIZE + 1)
+#define RECORD_RACK_SLOTS (ALPHABET_SIZE + 2)
+
+// A record file is the 4 bytes "SCRB", a version byte and a board size byte (LENGTH), followed by games
+// laid back to back; a record of another board size is not opened.
+// Each event is a tag byte (type in the low 4 bits, player in bit 4) and its fields; numbers are
+// unsigned LEB128 varints and letters are one byte each: a tile drawn is its rack counter (its letter
+// code, or RECORD_BLANK_SLOT for a blank) and a tile played its letter code, BLANK_TILE set for a blank.
+//
+//   GameStart  seed, then each player's rack as a count and letters
+//   Play       count, squares (y * LENGTH + x ascending: the first one, then deltas),
+//              letters in the same order, score, drawn count and letters
+//   Reroll     drawn count and letters (the whole new rack; the old one went back to the bag)
+//   Exchange   count and rack counters of the tiles swapped, drawn count and letters
+//   End        nothing
+//   GameEnd    both final scores
+//
+// Only the tiles drawn are stored; the racks are tracked by the writer and the reader alike,
+// so a game can be replayed without running the bag's random generator.
+// The recording functions do nothing when given a NULL writer, so recording can be left off.
+
+// --------------------
+// Enumerations
+// --------------------
+
+// Represents the kinds of events a record holds
+typedef enum
+{
+    Record_GameStart = 1,          // A new game was dealt
+    Record_Play,                   // A player laid tiles
+    Record_Reroll,                 // A player swapped the whole rack
+    Record_End,                    // A player asked to end the game
+    Record_GameEnd,                // The game's record is over, finished or abandoned
+    Record_Exchange,               // A player swapped some of the rack's tiles
+} RecordType;
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents one event read back from a record, with the racks as they are after it
+typedef struct
+{
+    RecordType type;
+    PlayerTurn player;                       // Player who acted (Play, Reroll, End, Exchange)
+    unsigned long long seed;                 // Seed the game was dealt from (GameStart)
+    Coordinate squares[MAX_LETTERS];         // Squares covered, in board order (Play)
+    char letters[MAX_LETTERS];               // Letter laid on each square (Play), tiles swapped (Exchange)
+    int numLetters;
+    int score;                               // Points the play scored (Play)
+    char drawn[MAX_LETTERS];                 // Tiles drawn from the bag (Play, Reroll, Exchange)
+    int numDrawn;
+    char racks[2][MAX_LETTERS];              // Both racks after the event, '\0' for empty slots
+    int finalScores[2];                      // Scores when the record ended (GameEnd)
+} GameEvent;
+
+// Represents a buffered writer appending games to a record file
+typedef struct
+{
+    FILE* file;
+    unsigned char buffer[RECORD_BUFFER_SIZE];
+    size_t used;
+    int rackCounts[2][RECORD_RACK_SLOTS];                   // Racks as last recorded, by rack counter
+} RecordWriter;
+
+// Represents a streaming reader of a record file
+typedef struct
+{
+    FILE* file;
+    unsigned char buffer[RECORD_BUFFER_SIZE];
+    size_t length;
+    size_t position;
+    int rackCounts[2][RECORD_RACK_SLOTS];                   // Racks as of the last event read, by rack counter
+} RecordReader;
+
+// --------------------
+// Writer Functions
+// --------------------
+
+// Opens a record file for appending, writing the header if it is new; returns NULL on failure
+RecordWriter* openRecordWriter(const char* filename);
+
+// Flushes the buffered events and closes the file
+void closeRecordWriter(RecordWriter* writer);
+
+// Writes the buffered events to the file
+void flushRecordWriter(RecordWriter* writer);
+
+// Records a newly dealt game and its starting racks
+void recordGameStart(RecordWriter* writer, unsigned long long seed, const Game* game);
+
+// Records tiles laid by a player; 'game' is the state after the play, with the rack refilled
+void recordPlay(RecordWriter* writer, const Game* game, PlayerTurn player,
+                const Coordinate squares[], const char letters[], int numLetters, int score);
+
+// Records a player swapping the whole rack; 'game' is the state after the swap
+void recordReroll(RecordWriter* writer, const Game* game, PlayerTurn player);
+
+// Records a player swapping some of the rack's tiles; 'game' is the state after the exchange
+void recordExchange(RecordWriter* writer, const Game* game, PlayerTurn player, const char returned[],
+                    int numReturned);
+
+// Records a player asking to end the game
+void recordEnd(RecordWriter* writer, PlayerTurn player);
+
+// Closes the record of a game with its final scores
+void recordGameEnd(RecordWriter* writer, const Game* game);
+
+// --------------------
+// Reader Functions
+// --------------------
+
+// Opens a record file for reading and checks its header; returns NULL on failure
+RecordReader* openRecordReader(const char* filename);
+
+// Closes the reader
+void closeRecordReader(RecordReader* reader);
+
+// Reads the next event; returns false at the end of the file or on a malformed record
+bool readGameEvent(RecordReader* reader, GameEvent* event);
+
+// Applies an event to a game, drawing the recorded tiles instead of random ones
+void applyGameEvent(Game* game, const Lexicon* lexicon, const GameEvent* event);
+
+#endif // RECORD_H
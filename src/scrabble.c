@@ -2,52 +2,106 @@
 
 #include "scrabble.h"
 #include "arbol_diccionario.h"
+#include "wordlist.h"
+#include "wordhash.h"
+#include "util.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-// Root node of the dictionary BST
-Node* dictionaryRoot = NULL;
+// Dictionary lookups made by the calling thread, for instrumentation
+static __thread unsigned long dictionaryLookups = 0;
 
 // --------------------
 // Dictionary Functions
 // --------------------
 
-// Loads valid words from a file into the Binary Search Tree (BST)
-void loadValidWords(const char* filename)
+// Loads valid words from a file into a new lexicon backed by a balanced Binary Search Tree (BST),
+// reading and building it on one thread per core
+Lexicon* loadValidWords(const char* filename)
 {
-    FILE* file = fopen(filename, "r");
-    if (!file)
+    return loadLexicon(filename, 0);
+}
+
+// Frees a lexicon once no game uses it anymore
+void freeLexicon(Lexicon* lexicon)
+{
+    if (lexicon)
     {
-        perror("Error opening dictionary file");
-        exit(EXIT_FAILURE);
+        free(lexicon->nodes);
+        freeWordHash(lexicon->hash);
+        free(lexicon);
     }
-    char word[MAX_WORD_LENGTH_LOCAL];
-    while (fscanf(file, "%s", word) != EOF)
+}
+
+// Checks if a word is valid, in the lexicon's perfect hash when it has one and else in the BST
+bool isValidWord(const Lexicon* lexicon, const char* word)
+{
+    dictionaryLookups++;
+    if (lexicon->hash != NULL)
     {
-        // Convert the word to lowercase
-        for (int i = 0; word[i]; i++)
+        return lookupWordHash(lexicon->hash, word);
+    }
+    return search(lexicon->root, word);
+}
+
+// Checks if at least one word in the BST starts with the given prefix
+bool isValidPrefix(const Lexicon* lexicon, const char* prefix)
+{
+    dictionaryLookups++;
+    return searchPrefix(lexicon->root, prefix);
+}
+
+// Returns a bit (code - 1) for each letter that continues the prefix towards some word
+unsigned int nextLetters(const Lexicon* lexicon, const char* prefix)
+{
+    size_t length = strlen(prefix);
+    char probe[MAX_WORD_LENGTH_LOCAL + 1];
+    if (length + 1 >= sizeof(probe))
+    {
+        return 0;
+    }
+    memcpy(probe, prefix, length);
+    probe[length + 1] = '\0';
+
+    // The first word at or after prefix + letter either shares the prefix, and its next letter is the
+    // next continuation, or no continuation is left
+    unsigned int letters = 0;
+    for (int letter = 1; letter <= ALPHABET_SIZE;)
+    {
+        probe[length] = (char)letter;
+        dictionaryLookups++;
+        const Node* node = lowerBound(lexicon->root, probe);
+        if (node == NULL || strncmp(node->word, prefix, length) != 0 || !isLetterCode(node->word[length]))
         {
-            word[i] = tolower(word[i]);
+            break;
         }
-        // Insert the word into the BST
-        dictionaryRoot = insert(dictionaryRoot, word);
+        letters |= 1u << (node->word[length] - 1);
+        letter = node->word[length] + 1;
     }
-    fclose(file);
+    return letters;
+}
+
+// Calls 'visit' with every word of the lexicon, in alphabetical order
+void forEachWord(const Lexicon* lexicon, void (*visit)(const char* word, void* user), void* user)
+{
+    visitInOrder(lexicon->root, visit, user);
 }
 
-// Checks if a word is valid by searching in the BST
-bool isValidWord(const char* word)
+// Returns the number of dictionary lookups made so far by the calling thread
+unsigned long getDictionaryLookups(void)
 {
-    return search(dictionaryRoot, word);
+    return dictionaryLookups;
 }
 
-// Frees the memory allocated for the game, including the BST
+// Frees the memory allocated for the game
 void freeGame(Game* game)
 {
-    // Free other resources if necessary
-    freeTree(dictionaryRoot);
+    // The game owns no heap memory; the lexicon is shared and freed with freeLexicon
+    (void)game;
 }
 
 // --------------------
@@ -69,106 +123,248 @@ void linkPieces(Board board)
     }
 }
 
+// Premium squares of the board, one row of layout symbols per board row (see scrabble.h). The 21 x 21 rows
+// are a placeholder, not checked against the published Super Scrabble board, and boards are not
+// initialized from them until loadBoardLayout has read a layout
+static char boardLayout[LENGTH][LENGTH + 1] = {
+#if LENGTH == 15
+    "T..d.t.T.t.d..T",
+    ".D...........D.",
+    "..D...d.d...D..",
+    "d..D...d...D..d",
+    "....D.....D....",
+    "t....t...t....t",
+    "..d...d.d...d..",
+    "T..d...*...d..T",
+    "..d...d.d...d..",
+    "t....t...t....t",
+    "....D.....D....",
+    "d..D...d...D..d",
+    "..D...d.d...D..",
+    ".D...........D.",
+    "T..d.t.T.t.d..T",
+#else
+    "Q..d...T..d..T...d..Q",
+    ".D..t....D.D....t..D.",
+    "..D..q....D....q..D..",
+    "d..T..d.......d..T..d",
+    ".t..D...t...t...D..t.",
+    "..q..D...d.d...D..q..",
+    "...d..D...d...D..d...",
+    "T......D.....D......T",
+    "....t...D...D...t....",
+    ".D...d...t.t...d...D.",
+    "d.D...d...*...d...D.d",
+    ".D...d...t.t...d...D.",
+    "....t...D...D...t....",
+    "T......D.....D......T",
+    "...d..D...d...D..d...",
+    "..q..D...d.d...D..q..",
+    ".t..D...t...t...D..t.",
+    "d..T..d.......d..T..d",
+    "..D..q....D....q..D..",
+    ".D..t....D.D....t..D.",
+    "Q..d...T..d..T...d..Q",
+#endif
+};
+
+// Whether boardLayout holds a layout boards may be initialized from
+static bool boardLayoutSet = (LENGTH == 15);
+
+// Symbols of a layout, by Multiplier
+static const char layoutSymbols[] = ".*DTdtQq";
+
+// Returns the multiplier of a layout symbol, or -1 if it is not one
+static int layoutMultiplier(char symbol)
+{
+    const char* found = (symbol != '\0') ? strchr(layoutSymbols, symbol) : NULL;
+    return found ? (int)(found - layoutSymbols) : -1;
+}
+
 // Initializes the game board with default settings and multipliers
 void initBoard(Board board)
 {
-    // Initialize all tiles on the board
+    if (!boardLayoutSet)
+    {
+        fprintf(stderr, "Error initializing board: the %d x %d board has no standard layout; read one with --layout "
+                "FILE (layout.txt for the game)\n", LENGTH, LENGTH);
+        exit(EXIT_FAILURE);
+    }
     for (int i = 0; i < LENGTH; i++)
     {
         for (int j = 0; j < LENGTH; j++)
         {
             board[i][j].is_placed = false;
-            board[i][j].multiplier = None;
+            board[i][j].multiplier = (Multiplier)layoutMultiplier(boardLayout[i][j]);
             board[i][j].letter = '\0';
+            board[i][j].is_blank = false;
         }
     }
 
     // Link each tile to its neighbors
     linkPieces(board);
+}
+
+// Reads the premium squares of the board from a layout file: LENGTH rows of LENGTH symbols, blank lines
+// and lines starting with '#' skipped, and the center square, the only '*', in the middle
+bool loadBoardLayout(const char* filename)
+{
+    FILE* file = fopen(filename, "r");
+    if (!file)
+    {
+        perror("Error opening board layout");
+        return false;
+    }
+
+    char layout[LENGTH][LENGTH + 1];
+    char line[LINE_STRIDE * 4];
+    int rows = 0;
+    int centers = 0;
+    bool valid = true;
+    while (valid && fgets(line, sizeof(line), file))
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#')
+        {
+            continue;
+        }
+        valid = rows < LENGTH && strlen(line) == LENGTH;
+        for (int x = 0; valid && x < LENGTH; x++)
+        {
+            valid = layoutMultiplier(line[x]) >= 0;
+            centers += (line[x] == '*') ? 1 : 0;
+        }
+        if (valid)
+        {
+            memcpy(layout[rows++], line, LENGTH + 1);
+        }
+    }
+    fclose(file);
+
+    if (!valid || rows != LENGTH || centers != 1 || layout[LENGTH / 2][LENGTH / 2] != '*')
+    {
+        fprintf(stderr, "Error reading board layout %s: expected %d rows of %d symbols from \"%s\"\n", filename,
+                LENGTH, LENGTH, layoutSymbols);
+        return false;
+    }
+    memcpy(boardLayout, layout, sizeof(boardLayout));
+    boardLayoutSet = true;
+    return true;
+}
+
+// Empties a game's board and its byte views and sets the multipliers
+void resetBoard(Game* game)
+{
+    initBoard(game->board);
+    memset(game->rows, 0, sizeof(game->rows));
+    memset(game->columns, 0, sizeof(game->columns));
+}
+
+// Lays a tile on a square (BLANK_TILE | letter for a blank), or empties it when the tile is 0
+void setSquare(Game* game, int x, int y, char tile)
+{
+    Piece* piece = &game->board[y][x];
+    piece->is_placed = tile != '\0';
+    piece->letter = tileLetter(tile);
+    piece->is_blank = isBlankTile(tile);
+    unsigned char square = (unsigned char)(piece->is_placed ? piece->letter | (piece->is_blank ? BLANK_TILE : 0) : 0);
+    game->rows[y][x] = square;
+    game->columns[x][y] = square;
+}
+
+// --------------------
+// Line Scanning
+// --------------------
 
-    // Set the center tile multiplier
-    board[7][7].multiplier = Center;
-
-    // Define and set multipliers based on official Scrabble positions
-
-    // 1. Triple Word (TW) positions
-    int tripleWordPositions[][2] = {
-        {0, 0}, {0, 7}, {0, 14},
-        {7, 0}, {7, 14},
-        {14, 0}, {14, 7}, {14, 14}
-    };
-    for (int i = 0; i < 8; i++)
-    {
-        int x = tripleWordPositions[i][0];
-        int y = tripleWordPositions[i][1];
-        board[x][y].multiplier = Triple_Word;
-    }
-
-    // 2. Double Word (DW) positions
-    int doubleWordPositions[][2] = {
-        {1, 1}, {1, 13},
-        {2, 2}, {2, 12},
-        {3, 3}, {3, 11},
-        {4, 4}, {4, 10},
-        {10, 4}, {10, 10},
-        {11, 3}, {11, 11},
-        {12, 2}, {12, 12},
-        {13, 1}, {13, 13}
-    };
-    for (int i = 0; i < 16; i++)
-    {
-        int x = doubleWordPositions[i][0];
-        int y = doubleWordPositions[i][1];
-        board[x][y].multiplier = Double_Word;
-    }
-
-    // 3. Triple Letter (TL) positions
-    int tripleLetterPositions[][2] = {
-        {0, 5}, {0, 9},
-        {5, 0}, {5, 5}, {5, 9}, {5, 14},
-        {9, 0}, {9, 5}, {9, 9}, {9, 14},
-        {14, 5}, {14, 9}
-    };
-    for (int i = 0; i < 12; i++)
-    {
-        int x = tripleLetterPositions[i][0];
-        int y = tripleLetterPositions[i][1];
-        board[x][y].multiplier = Triple_Letter;
-    }
-
-    // 4. Double Letter (DL) positions
-    int doubleLetterPositions[][2] = {
-        {0, 3}, {0, 11},
-        {2, 6}, {2, 8},
-        {3, 0}, {3, 7}, {3, 14},
-        {6, 2}, {6, 6}, {6, 8}, {6, 12},
-        {7, 3}, {7, 11},
-        {8, 2}, {8, 6}, {8, 8}, {8, 12},
-        {11, 0}, {11, 7}, {11, 14},
-        {12, 6}, {12, 8},
-        {14, 3}, {14, 11}
-    };
-    for (int i = 0; i < 24; i++)
-    {
-        int x = doubleLetterPositions[i][0];
-        int y = doubleLetterPositions[i][1];
-        board[x][y].multiplier = Double_Letter;
+// Returns the bitmask of the occupied squares of a line of a byte view: one compare of 16 bytes against
+// zero and one movemask per vector of the line where SSE2 is available
+unsigned int lineMask(const unsigned char line[LINE_STRIDE])
+{
+#if defined(__SSE2__)
+    unsigned int empty = 0;
+    for (int chunk = 0; chunk < LINE_STRIDE; chunk += 16)
+    {
+        __m128i squares = _mm_loadu_si128((const __m128i*)(line + chunk));
+        empty |= (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(squares, _mm_setzero_si128())) << chunk;
     }
+    return ~empty & LINE_BITS;
+#else
+    unsigned int mask = 0;
+    for (int i = 0; i < LENGTH; i++)
+    {
+        mask |= (line[i] != 0 ? 1u : 0u) << i;
+    }
+    return mask;
+#endif
+}
+
+// Returns the bitmask of the occupied squares of a row, 0 outside the board
+unsigned int occupiedRow(const Game* game, int y)
+{
+    return (y >= 0 && y < LENGTH) ? lineMask(game->rows[y]) : 0;
+}
+
+// Returns the bitmask of the occupied squares of a column, 0 outside the board
+unsigned int occupiedColumn(const Game* game, int x)
+{
+    return (x >= 0 && x < LENGTH) ? lineMask(game->columns[x]) : 0;
+}
+
+// Finds the run of set bits holding the bit 'pos' of a mask: it starts after the highest clear bit below
+// 'pos' and ends before the lowest clear bit above it
+void findRun(unsigned int mask, int pos, int* start, int* end)
+{
+    unsigned int emptyBelow = ~mask & ((1u << pos) - 1);
+    *start = emptyBelow ? 32 - __builtin_clz(emptyBelow) : 0;
+    *end = pos + __builtin_ctz(~mask >> pos) - 1;
+}
+
+// Copies the letter codes of the squares 'start' to 'end' of a line, without blank bits, as a string
+void copyLineWord(const unsigned char line[LINE_STRIDE], int start, int end, char* word)
+{
+    unsigned char letters[LINE_STRIDE];
+#if defined(__SSE2__)
+    for (int chunk = 0; chunk < LINE_STRIDE; chunk += 16)
+    {
+        __m128i squares = _mm_loadu_si128((const __m128i*)(line + chunk));
+        _mm_storeu_si128((__m128i*)(letters + chunk), _mm_andnot_si128(_mm_set1_epi8(BLANK_TILE), squares));
+    }
+#else
+    for (int i = 0; i < LINE_STRIDE; i++)
+    {
+        letters[i] = (unsigned char)(line[i] & ~BLANK_TILE);
+    }
+#endif
+    memcpy(word, letters + start, end - start + 1);
+    word[end - start + 1] = '\0';
 }
 
 // --------------------
 // Letter Bag Functions
 // --------------------
 
-// Initializes the letter bag with all available letters
-void initLetterBag(LetterBag* bag)
+// Initializes the letter bag with all available letters and seeds its random generator
+void initLetterBag(LetterBag* bag, unsigned long long seed)
+{
+    bag->remaining = 0;
+    for (char letter = 1; letter <= ALPHABET_SIZE; letter++)
+    {
+        for (int i = 0; i < getLetterCount(letter); i++)
+        {
+            bag->letters[bag->remaining++] = letter;
+        }
+    }
+    for (int i = 0; i < BLANK_COUNT; i++)
+    {
+        bag->letters[bag->remaining++] = BLANK_TILE;
+    }
+    bag->rngState = seed;
+}
+
+// Draws the next number from the bag's random generator (SplitMix64)
+static unsigned long long nextRandom(LetterBag* bag)
 {
-    strcpy(bag->letters,
-           "EEEEEEEEEEEEAAAAAAAAAIIIIIIIII"
-           "OOOOOOOOONNNNNNRRRRRR"
-           "TTTTTTLLLLSSSSUUUUDDDD"
-           "GGGGBBCCMMPPFFHHVVWWYYKJXQZ");
-    bag->remaining = strlen(bag->letters);
+    return nextSplitMix(&bag->rngState);
 }
 
 // Refills a player's letters from the letter bag
@@ -180,7 +376,7 @@ void refillPlayerLetters(LetterBag* bag, Player* player)
         {
             if (bag->remaining > 0)
             {
-                int index = rand() % bag->remaining;
+                int index = (int)(nextRandom(bag) % (unsigned long long)bag->remaining);
                 player->letters[i] = bag->letters[index];
                 // Remove the selected letter from the bag
                 bag->letters[index] = bag->letters[bag->remaining - 1];
@@ -213,13 +409,13 @@ int countPlayerLetters(const Player* player)
 // --------------------
 
 // Initializes the entire game
-void initGame(Game* game)
+void initGame(Game* game, const Lexicon* lexicon, unsigned long long seed)
 {
     // Initialize the game board
-    initBoard(game->board);
+    resetBoard(game);
 
     // Initialize the letter bag
-    initLetterBag(&game->bag);
+    initLetterBag(&game->bag, seed);
 
     // Set the initial turn to Player 1
     game->turn = Player1;
@@ -239,8 +435,8 @@ void initGame(Game* game)
     game->player1WantsToEnd = false;
     game->player2WantsToEnd = false;
 
-    // Load valid words into the dictionary BST
-    loadValidWords("palabras.txt");
+    // Words are validated against the shared lexicon, loaded once by the caller
+    game->lexicon = lexicon;
 }
 
 // Switches the turn to the next player
@@ -308,7 +504,7 @@ void removeLettersFromPlayer(Player* player, const char* word)
     {
         for (int j = 0; j < MAX_LETTERS; j++)
         {
-            if (player->letters[j] == word[i])
+            if (player->letters[j] == rackTile(word[i]))
             {
                 player->letters[j] = '\0';
                 break;
@@ -318,7 +514,7 @@ void removeLettersFromPlayer(Player* player, const char* word)
 }
 
 // Determines the score of a single word placement
-int calculateWordScore(Game* game, const char* word, int x, int y, bool horizontal)
+int calculateWordScore(const Game* game, const char* word, int x, int y, bool horizontal)
 {
     int wordScore = 0;
     int wordMultiplier = 1;
@@ -329,8 +525,9 @@ int calculateWordScore(Game* game, const char* word, int x, int y, bool horizont
         int xi = horizontal ? x + i : x;
         int yi = horizontal ? y : y + i;
 
-        char letter = game->board[yi][xi].letter;
-        int letterScore = getLetterScore(letter);
+        // Blanks score nothing, whatever letter they play as
+        const Piece* piece = &game->board[yi][xi];
+        int letterScore = piece->is_blank ? 0 : getLetterScore(piece->letter);
 
         Multiplier multiplier = game->board[yi][xi].multiplier;
 
@@ -349,6 +546,12 @@ int calculateWordScore(Game* game, const char* word, int x, int y, bool horizont
         case Triple_Word:
             wordMultiplier *= 3;
             break;
+        case Quadruple_Letter:
+            letterScore *= 4;
+            break;
+        case Quadruple_Word:
+            wordMultiplier *= 4;
+            break;
         case Center:
         default:
             break;
@@ -366,11 +569,11 @@ int calculateWordScore(Game* game, const char* word, int x, int y, bool horizont
 int validateAndScoreWords(Game* game, Coordinate placedLetters[], int numPlacedLetters)
 {
     int totalScore = 0;
-    Piece (*board)[15] = game->board;
-    bool validMove = true;
 
-    // Keep track of words already scored to avoid duplicates
+    // Keep track of words already scored to avoid duplicates, and of the runs they were read from: the
+    // word along the placement is the same run for every tile
     char scoredWords[100][MAX_WORD_LENGTH_LOCAL];
+    int scoredRuns[100];
     int scoredWordCount = 0;
 
     for (int i = 0; i < numPlacedLetters; i++)
@@ -378,30 +581,28 @@ int validateAndScoreWords(Game* game, Coordinate placedLetters[], int numPlacedL
         int x = placedLetters[i].x;
         int y = placedLetters[i].y;
 
-        // Check horizontally
-        int xStart = x, xEnd = x;
-
-        // Move to the leftmost character
-        while (xStart > 0 && board[y][xStart - 1].is_placed)
-        {
-            xStart--;
-        }
-        // Move to the rightmost character
-        while (xEnd < LENGTH - 1 && board[y][xEnd + 1].is_placed)
+        // The words through the tile are the runs of occupied squares around it, across then down
+        for (int direction = 0; direction < 2; direction++)
         {
-            xEnd++;
-        }
-
-        int wordLength = xEnd - xStart + 1;
-        if (wordLength > 1)
-        {
-            // Extract the word
-            char word[MAX_WORD_LENGTH_LOCAL];
-            for (int xi = xStart, idx = 0; xi <= xEnd; xi++, idx++)
+            bool horizontal = (direction == 0);
+            const unsigned char* line = horizontal ? game->rows[y] : game->columns[x];
+            int pos = horizontal ? x : y;
+            int start, end;
+            findRun(lineMask(line) | 1u << pos, pos, &start, &end);
+            int run = (direction * LENGTH + (horizontal ? y : x)) * LENGTH + start;
+            bool runScored = start == end;
+            for (int s = 0; s < scoredWordCount && !runScored; s++)
+            {
+                runScored = scoredRuns[s] == run;
+            }
+            if (runScored)
             {
-                word[idx] = board[y][xi].letter;
+                continue;
             }
-            word[wordLength] = '\0';
+
+            // Extract the word
+            char word[LINE_STRIDE + 1];
+            copyLineWord(line, start, end, word);
 
             // Check if the word has already been scored
             bool alreadyScored = false;
@@ -413,146 +614,221 @@ int validateAndScoreWords(Game* game, Coordinate placedLetters[], int numPlacedL
                     break;
                 }
             }
+            if (alreadyScored)
+            {
+                continue;
+            }
 
-            if (!alreadyScored)
+            // Validate the word
+            if (!isValidWord(game->lexicon, word))
             {
-                // Convert word to lowercase for dictionary lookup
-                char lowerWord[MAX_WORD_LENGTH_LOCAL];
-                for (int k = 0; k < wordLength; k++)
-                {
-                    lowerWord[k] = tolower(word[k]);
-                }
-                lowerWord[wordLength] = '\0';
+                return -1; // Indicate that the move is invalid
+            }
 
-                // Validate the word
-                if (!isValidWord(lowerWord))
-                {
-                    validMove = false;
-                    break;
-                }
+            // Calculate the score and remember the word
+            totalScore += horizontal ? calculateWordScore(game, word, start, y, true)
+                                     : calculateWordScore(game, word, x, start, false);
+            scoredRuns[scoredWordCount] = run;
+            strcpy(scoredWords[scoredWordCount++], word);
+        }
+    }
 
-                // Calculate the score
-                int wordScore = calculateWordScore(game, word, xStart, y, true);
-                totalScore += wordScore;
+    return totalScore;
+}
 
-                // Add the word to the scoredWords array
-                strcpy(scoredWords[scoredWordCount++], word);
-            }
+// --------------------
+// Move Functions
+// --------------------
+
+// Checks that the squares form one unbroken line of new tiles connected to the letters on the board
+bool isPlacementLegal(const Game* game, const Coordinate squares[], int numSquares)
+{
+    if (numSquares < 1 || numSquares > MAX_LETTERS)
+    {
+        return false;
+    }
+
+    bool sameRow = true;
+    bool sameColumn = true;
+    for (int i = 0; i < numSquares; i++)
+    {
+        int x = squares[i].x;
+        int y = squares[i].y;
+        if (x < 0 || x >= LENGTH || y < 0 || y >= LENGTH || game->board[y][x].is_placed)
+        {
+            return false;
         }
+        sameRow = sameRow && y == squares[0].y;
+        sameColumn = sameColumn && x == squares[0].x;
+    }
+    if (!sameRow && !sameColumn)
+    {
+        return false;
+    }
 
-        // Check vertically
-        int yStart = y, yEnd = y;
-        // Move to the topmost character
-        while (yStart > 0 && board[yStart - 1][x].is_placed)
+    // The new tiles as a bitmask of their line; a square given twice is not a placement
+    bool horizontal = sameRow;
+    int line = horizontal ? squares[0].y : squares[0].x;
+    unsigned int placed = 0;
+    for (int i = 0; i < numSquares; i++)
+    {
+        unsigned int bit = 1u << (horizontal ? squares[i].x : squares[i].y);
+        if (placed & bit)
         {
-            yStart--;
+            return false;
         }
-        // Move to the bottommost character
-        while (yEnd < LENGTH - 1 && board[yEnd + 1][x].is_placed)
+        placed |= bit;
+    }
+
+    // Every square between the first and the last tile must be covered, by a new tile or a letter on the board
+    unsigned int occupied = horizontal ? occupiedRow(game, line) : occupiedColumn(game, line);
+    int first = __builtin_ctz(placed);
+    int last = 31 - __builtin_clz(placed);
+    unsigned int span = (2u << last) - (1u << first);
+    if (((occupied | placed) & span) != span)
+    {
+        return false;
+    }
+
+    // The opening move has to cover the center square and form a word; later moves have to touch a letter
+    if (!game->board[LENGTH / 2][LENGTH / 2].is_placed)
+    {
+        return line == LENGTH / 2 && (placed >> (LENGTH / 2) & 1) && numSquares > 1;
+    }
+    unsigned int beside = horizontal ? occupiedRow(game, line - 1) | occupiedRow(game, line + 1)
+                                     : occupiedColumn(game, line - 1) | occupiedColumn(game, line + 1);
+    return (occupied & (placed << 1 | placed >> 1)) != 0 || (beside & placed) != 0;
+}
+
+// Plays tiles from the current player's rack; returns the score or -1 if the move is not legal
+int playMove(Game* game, const Coordinate squares[], const char letters[], int numLetters)
+{
+    if (game->gameOver || !isPlacementLegal(game, squares, numLetters))
+    {
+        return -1;
+    }
+
+    // A blank leaves the rack as BLANK_TILE, whatever letter it is given
+    Player* player = (game->turn == Player1) ? &game->player1 : &game->player2;
+    char word[MAX_LETTERS + 1];
+    for (int i = 0; i < numLetters; i++)
+    {
+        if (!isLetterCode(tileLetter(letters[i])))
         {
-            yEnd++;
+            return -1;
         }
+        word[i] = rackTile(letters[i]);
+    }
+    word[numLetters] = '\0';
+    if (!playerHasLetters(player, word))
+    {
+        return -1;
+    }
 
-        wordLength = yEnd - yStart + 1;
-        if (wordLength > 1)
+    // Lay the tiles and score every word they form
+    Coordinate placed[MAX_LETTERS];
+    for (int i = 0; i < numLetters; i++)
+    {
+        placed[i] = squares[i];
+        setSquare(game, squares[i].x, squares[i].y, letters[i]);
+    }
+
+    int score = validateAndScoreWords(game, placed, numLetters);
+    if (score < 0)
+    {
+        // Take the tiles back
+        for (int i = 0; i < numLetters; i++)
         {
-            // Extract the word
-            char word[MAX_WORD_LENGTH_LOCAL];
-            for (int yi = yStart, idx = 0; yi <= yEnd; yi++, idx++)
-            {
-                word[idx] = board[yi][x].letter;
-            }
-            word[wordLength] = '\0';
+            setSquare(game, squares[i].x, squares[i].y, '\0');
+        }
+        return -1;
+    }
 
-            // Check if the word has already been scored
-            bool alreadyScored = false;
-            for (int s = 0; s < scoredWordCount; s++)
-            {
-                if (strcmp(scoredWords[s], word) == 0)
-                {
-                    alreadyScored = true;
-                    break;
-                }
-            }
+    player->score += score;
+    removeLettersFromPlayer(player, word);
+    refillPlayerLetters(&game->bag, player);
+    switchTurn(game);
+    return score;
+}
 
-            if (!alreadyScored)
-            {
-                // Convert word to lowercase for dictionary lookup
-                char lowerWord[MAX_WORD_LENGTH_LOCAL];
-                for (int k = 0; k < wordLength; k++)
-                {
-                    lowerWord[k] = tolower((unsigned char)word[k]);
-                }
-                lowerWord[wordLength] = '\0';
+// Returns the current player's letters to the bag, draws a new rack and passes the turn
+void rerollPlayerLetters(Game* game)
+{
+    Player* currentPlayer = (game->turn == Player1) ? &game->player1 : &game->player2;
 
-                // Validate the word
-                if (!isValidWord(lowerWord))
-                {
-                    validMove = false;
-                    break;
-                }
+    // Return letters to the bag
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        if (currentPlayer->letters[i] != '\0')
+        {
+            game->bag.letters[game->bag.remaining++] = currentPlayer->letters[i];
+            currentPlayer->letters[i] = '\0';
+        }
+    }
 
-                // Calculate the score
-                int wordScore = calculateWordScore(game, word, x, yStart, false);
-                totalScore += wordScore;
+    // Refill the player's letters
+    refillPlayerLetters(&game->bag, currentPlayer);
 
-                // Add the word to the scoredWords array
-                strcpy(scoredWords[scoredWordCount++], word);
-            }
+    // Switch turn to the next player
+    switchTurn(game);
+}
+
+// Swaps the tiles of the current player's rack slots set in 'slots' (bit i for slot i) for tiles drawn
+// from the bag and passes the turn; returns false, changing nothing, if a chosen slot is empty, none is
+// chosen or the bag holds fewer tiles than chosen
+bool exchangePlayerLetters(Game* game, unsigned int slots)
+{
+    Player* currentPlayer = (game->turn == Player1) ? &game->player1 : &game->player2;
+
+    char returned[MAX_LETTERS];
+    int numReturned = 0;
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        if (slots & (1u << i))
+        {
+            returned[numReturned++] = currentPlayer->letters[i];
         }
     }
+    if (numReturned == 0 || (slots >> MAX_LETTERS) != 0 || numReturned > game->bag.remaining ||
+        memchr(returned, '\0', numReturned) != NULL)
+    {
+        return false;
+    }
 
-    if (!validMove)
+    // The replacements are drawn before the swapped tiles go back, so none of those can be drawn again
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        if (slots & (1u << i))
+        {
+            currentPlayer->letters[i] = '\0';
+        }
+    }
+    refillPlayerLetters(&game->bag, currentPlayer);
+    for (int i = 0; i < numReturned; i++)
     {
-        return -1; // Indicate that the move is invalid
+        game->bag.letters[game->bag.remaining++] = returned[i];
     }
 
-    return totalScore;
+    switchTurn(game);
+    return true;
 }
 
-// --------------------
-// Letter Scoring
-// --------------------
+// Records that the current player wants to end the game and passes the turn
+void requestEndGame(Game* game)
+{
+    if (game->turn == Player1)
+    {
+        game->player1WantsToEnd = true;
+    }
+    else
+    {
+        game->player2WantsToEnd = true;
+    }
+    switchTurn(game);
 
-// Helper function to get the score of a letter
-int getLetterScore(char letter)
-{
-    switch (toupper(letter))
-    {
-    case 'A':
-    case 'E':
-    case 'I':
-    case 'O':
-    case 'U':
-    case 'L':
-    case 'N':
-    case 'S':
-    case 'T':
-    case 'R':
-        return 1;
-    case 'D':
-    case 'G':
-        return 2;
-    case 'B':
-    case 'C':
-    case 'M':
-    case 'P':
-        return 3;
-    case 'F':
-    case 'H':
-    case 'V':
-    case 'W':
-    case 'Y':
-        return 4;
-    case 'K':
-        return 5;
-    case 'J':
-    case 'X':
-        return 8;
-    case 'Q':
-    case 'Z':
-        return 10;
-    default:
-        return 0;
+    // If both players want to end, set the game as over
+    if (game->player1WantsToEnd && game->player2WantsToEnd)
+    {
+        game->gameOver = true;
     }
 }
@@ -3,6 +3,7 @@
 #ifndef SCRABBLE_H
 #define SCRABBLE_H
 
+#include "alphabet.h"
 #include <stdbool.h>
 
 // --------------------
@@ -15,12 +16,45 @@
 // Maximum length of a single word
 #define MAX_WORD_LENGTH_LOCAL 30
 
-// The size of the game board (15 x 15)
-#define LENGTH 15
+// Side of the game board, chosen at build time: 15 for the standard board, 21 for the super board
+#ifndef BOARD_SIZE
+#define BOARD_SIZE 15
+#endif
+#if BOARD_SIZE != 15 && BOARD_SIZE != 21
+#error "BOARD_SIZE must be 15 or 21"
+#endif
+
+// The size of the game board (LENGTH x LENGTH)
+#define LENGTH BOARD_SIZE
 
 // Maximum number of letters a player can hold
 #define MAX_LETTERS 7
 
+// Bytes per line of the byte views of the board: one per square, padded to whole 16-byte vectors
+#define LINE_STRIDE (LENGTH <= 16 ? 16 : 32)
+
+// Bit per square of a line, the first square in the lowest bit
+#define LINE_BITS ((1u << LENGTH) - 1)
+
+// Tiles in a full bag
+#define BAG_SIZE (100 * TILE_SETS)
+
+// Besides its linked pieces, a game keeps every square as one byte (the letter code, BLANK_TILE set for
+// a blank, 0 when empty), row by row and again column by column. A whole line then loads as one vector
+// and compares to a bitmask of its occupied squares, so word boundaries, anchors and gaps are found with
+// bit operations instead of walks from piece to piece. Tiles are laid and lifted through setSquare,
+// which keeps the pieces and both views in step.
+//
+// The board size is a constant of the build, so every loop over a line or the board has fixed bounds
+// the compiler unrolls, and a 21 x 21 build pays nothing on 15 x 15 code it does not have. The premium
+// squares come from a layout of LENGTH rows of LENGTH symbols, the standard one on the 15 x 15 board unless
+// loadBoardLayout reads another before the games start. The 21 x 21 board has no standard layout built
+// in, so those builds stop at the first board initialized unless a layout was read:
+//
+//   .  plain square      d  double letter     D  double word
+//   *  center (start)    t  triple letter     T  triple word
+//                        q  quadruple letter  Q  quadruple word
+
 // --------------------
 // Enumerations
 // --------------------
@@ -34,6 +68,8 @@ typedef enum
     Triple_Word,
     Double_Letter,
     Triple_Letter,
+    Quadruple_Word,
+    Quadruple_Letter,
 } Multiplier;
 
 // Represents the direction of a word placement
@@ -60,7 +96,8 @@ typedef struct Piece
 {
     bool is_placed;               // Indicates if a letter has been placed on this tile
     Multiplier multiplier;        // The multiplier type of this tile
-    char letter;                  // The letter placed on this tile
+    char letter;                  // Letter code placed on this tile, 0 when empty
+    bool is_blank;                // Indicates if the letter was laid by a blank, which scores nothing
 
     struct Piece* up;             // Pointer to the tile above
     struct Piece* down;           // Pointer to the tile below
@@ -72,7 +109,7 @@ typedef struct Piece
 typedef struct
 {
     int score;                     // Player's current score
-    char letters[MAX_LETTERS];     // Letters currently held by the player
+    char letters[MAX_LETTERS];     // Letter codes currently held by the player, BLANK_TILE for a blank, 0 for an empty slot
 } Player;
 
 // Represents the game board as a 2D array of Pieces
@@ -81,10 +118,20 @@ typedef Piece Board[LENGTH][LENGTH];
 // Represents the bag containing all available letters
 typedef struct
 {
-    char letters[100];             // Array of letters in the bag
+    char letters[BAG_SIZE];        // Letter codes left in the bag
     int remaining;                 // Number of letters remaining in the bag
+    unsigned long long rngState;   // State of the bag's own random generator, so games draw independently
 } LetterBag;
 
+// Represents a dictionary of valid words, loaded once and shared read-only by any number of games
+typedef struct
+{
+    struct Node* root;             // Root node of the dictionary BST
+    struct Node* nodes;            // Every node of the tree in one block, freed at once
+    struct WordHash* hash;         // Perfect hash answering isValidWord, or NULL to search the tree
+    unsigned long long checksum;   // FNV-1a of the normalized word list, which files built from it record
+} Lexicon;
+
 // Represents the overall game state
 typedef struct
 {
@@ -96,6 +143,9 @@ typedef struct
     bool gameOver;                 // Flag to indicate if the game is over
     bool player1WantsToEnd;        // Indicates if Player 1 wants to end the game
     bool player2WantsToEnd;        // Indicates if Player 2 wants to end the game
+    const Lexicon* lexicon;        // Dictionary used to validate words (shared, not owned by the game)
+    unsigned char rows[LENGTH][LINE_STRIDE];    // Byte per square, row by row
+    unsigned char columns[LENGTH][LINE_STRIDE]; // The same bytes column by column
 } Game;
 
 // Represents a coordinate on the game board
@@ -116,15 +166,44 @@ typedef struct
 // Initializes the game board with default settings and multipliers
 void initBoard(Board board);
 
+// Reads the premium squares of the board from a layout file, for every board initialized after; returns
+// false, keeping the current layout, if the file cannot be read or is not a valid layout
+bool loadBoardLayout(const char* filename);
+
 // Links each piece on the board to its neighboring pieces
 void linkPieces(Board board);
 
+// Empties a game's board and its byte views and sets the multipliers
+void resetBoard(Game* game);
+
+// Lays a tile on a square (BLANK_TILE | letter for a blank), or empties it when the tile is 0
+void setSquare(Game* game, int x, int y, char tile);
+
+// --------------------
+// Line Scanning Functions
+// --------------------
+
+// Returns the bitmask of the occupied squares of a line of a byte view
+unsigned int lineMask(const unsigned char line[LINE_STRIDE]);
+
+// Returns the bitmask of the occupied squares of a row, 0 outside the board
+unsigned int occupiedRow(const Game* game, int y);
+
+// Returns the bitmask of the occupied squares of a column, 0 outside the board
+unsigned int occupiedColumn(const Game* game, int x);
+
+// Finds the run of set bits holding the bit 'pos' of a mask, which must be set
+void findRun(unsigned int mask, int pos, int* start, int* end);
+
+// Copies the letter codes of the squares 'start' to 'end' of a line, without blank bits, as a string
+void copyLineWord(const unsigned char line[LINE_STRIDE], int start, int end, char* word);
+
 // --------------------
 // Letter Bag Functions
 // --------------------
 
-// Initializes the letter bag with all available letters
-void initLetterBag(LetterBag* bag);
+// Initializes the letter bag with all available letters and seeds its random generator
+void initLetterBag(LetterBag* bag, unsigned long long seed);
 
 // Refills a player's letters from the letter bag
 void refillPlayerLetters(LetterBag* bag, Player* player);
@@ -136,8 +215,8 @@ int countPlayerLetters(const Player* player);
 // Game State Functions
 // --------------------
 
-// Initializes the entire game state
-void initGame(Game* game);
+// Initializes the entire game state, validating words against the given lexicon
+void initGame(Game* game, const Lexicon* lexicon, unsigned long long seed);
 
 // Switches the turn to the next player
 void switchTurn(Game* game);
@@ -148,18 +227,35 @@ bool isGameOver(const Game* game);
 // Clones the current game state to another game instance
 void cloneGame(const Game* original, Game* clone);
 
-// Frees resources used by the game, including the dictionary BST
+// Frees resources used by the game; the shared lexicon is left untouched
 void freeGame(Game* game);
 
 // --------------------
 // Dictionary Functions
 // --------------------
 
-// Loads valid words from a file into the Binary Search Tree (BST)
-void loadValidWords(const char* filename);
+// Loads valid words from a file into a new lexicon backed by a balanced Binary Search Tree (BST),
+// reading and building it on one thread per core
+Lexicon* loadValidWords(const char* filename);
+
+// Frees a lexicon once no game uses it anymore
+void freeLexicon(Lexicon* lexicon);
 
-// Checks if a word is valid by searching in the BST
-bool isValidWord(const char* word);
+// Checks if a word is valid, in the lexicon's perfect hash when it has one and else in the BST
+bool isValidWord(const Lexicon* lexicon, const char* word);
+
+// Checks if at least one word in the BST starts with the given prefix
+bool isValidPrefix(const Lexicon* lexicon, const char* prefix);
+
+// Returns a bit (code - 1) for each letter that continues the prefix towards some word, found by jumping
+// from one continuation to the next in the BST: one lookup per continuation plus one, not per letter
+unsigned int nextLetters(const Lexicon* lexicon, const char* prefix);
+
+// Calls 'visit' with every word of the lexicon, in alphabetical order
+void forEachWord(const Lexicon* lexicon, void (*visit)(const char* word, void* user), void* user);
+
+// Returns the number of dictionary lookups made so far by the calling thread
+unsigned long getDictionaryLookups(void);
 
 // --------------------
 // Word Validation and Scoring Functions
@@ -169,7 +265,29 @@ bool isValidWord(const char* word);
 int validateAndScoreWords(Game* game, Coordinate placedLetters[], int numPlacedLetters);
 
 // Calculates the score for a single word placement
-int calculateScore(Game* game, const char* word, int x, int y, bool horizontal);
+int calculateWordScore(const Game* game, const char* word, int x, int y, bool horizontal);
+
+// --------------------
+// Move Functions
+// --------------------
+
+// Checks that the squares form one unbroken line of new tiles connected to the letters on the board
+bool isPlacementLegal(const Game* game, const Coordinate squares[], int numSquares);
+
+// Plays tiles from the current player's rack, a blank given as BLANK_TILE | letter; returns the score
+// or -1 if the move is not legal
+int playMove(Game* game, const Coordinate squares[], const char letters[], int numLetters);
+
+// Returns the current player's letters to the bag, draws a new rack and passes the turn
+void rerollPlayerLetters(Game* game);
+
+// Swaps the tiles of the current player's rack slots set in 'slots' (bit i for slot i) for tiles drawn
+// from the bag and passes the turn; returns false, changing nothing, if a chosen slot is empty, none is
+// chosen or the bag holds fewer tiles than chosen
+bool exchangePlayerLetters(Game* game, unsigned int slots);
+
+// Records that the current player wants to end the game and passes the turn
+void requestEndGame(Game* game);
 
 // --------------------
 // Player Functions
@@ -181,11 +299,4 @@ void removeLettersFromPlayer(Player* player, const char* word);
 // Checks if a player has the necessary letters to form a word
 bool playerHasLetters(const Player* player, const char* word);
 
-// --------------------
-// Helper Functions
-// --------------------
-
-// Retrieves the score of a given letter based on Scrabble rules
-int getLetterScore(char letter);
-
 #endif // SCRABBLE_H
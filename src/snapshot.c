@@ -0,0 +1,296 @@
+// snapshot.c
+
+#include "snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bytes of the board occupancy bitmap
+#define OCCUPANCY_BYTES ((LENGTH * LENGTH + 7) / 8)
+
+// --------------------
+// Encoding Helpers
+// --------------------
+
+// Represents a bounded output buffer; 'overflow' is set instead of writing past the end
+typedef struct
+{
+    unsigned char* data;
+    size_t size;
+    size_t used;
+    bool overflow;
+} SnapshotWriter;
+
+// Represents a bounded input buffer; 'bad' is set instead of reading past the end
+typedef struct
+{
+    const unsigned char* data;
+    size_t length;
+    size_t position;
+    bool bad;
+} SnapshotReader;
+
+// Returns the FNV-1a hash of a byte range
+static unsigned int checksum(const unsigned char* data, size_t length)
+{
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Appends raw bytes
+static void putBytes(SnapshotWriter* writer, const void* bytes, size_t count)
+{
+    if (writer->used + count > writer->size)
+    {
+        writer->overflow = true;
+        return;
+    }
+    memcpy(writer->data + writer->used, bytes, count);
+    writer->used += count;
+}
+
+// Appends one byte
+static void putByte(SnapshotWriter* writer, unsigned char byte)
+{
+    putBytes(writer, &byte, 1);
+}
+
+// Appends an unsigned LEB128 varint
+static void putVarint(SnapshotWriter* writer, unsigned long long value)
+{
+    do
+    {
+        unsigned char byte = value & 0x7f;
+        value >>= 7;
+        putByte(writer, byte | (value ? 0x80 : 0));
+    } while (value);
+}
+
+// Appends a little endian number of the given width
+static void putFixed(SnapshotWriter* writer, unsigned long long value, int width)
+{
+    for (int i = 0; i < width; i++)
+    {
+        putByte(writer, (unsigned char)(value >> (8 * i)));
+    }
+}
+
+// Reads raw bytes
+static void getBytes(SnapshotReader* reader, void* bytes, size_t count)
+{
+    if (reader->position + count > reader->length)
+    {
+        reader->bad = true;
+        memset(bytes, 0, count);
+        return;
+    }
+    memcpy(bytes, reader->data + reader->position, count);
+    reader->position += count;
+}
+
+// Reads one byte
+static unsigned char getByte(SnapshotReader* reader)
+{
+    unsigned char byte;
+    getBytes(reader, &byte, 1);
+    return byte;
+}
+
+// Reads an unsigned LEB128 varint
+static unsigned long long getVarint(SnapshotReader* reader)
+{
+    unsigned long long value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        unsigned char byte = getByte(reader);
+        value |= (unsigned long long)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            return value;
+        }
+    }
+    reader->bad = true;
+    return 0;
+}
+
+// Reads a little endian number of the given width
+static unsigned long long getFixed(SnapshotReader* reader, int width)
+{
+    unsigned long long value = 0;
+    for (int i = 0; i < width; i++)
+    {
+        value |= (unsigned long long)getByte(reader) << (8 * i);
+    }
+    return value;
+}
+
+// Maps a signed number to an unsigned one with small magnitudes kept small
+static unsigned long long zigzag(int value)
+{
+    return ((unsigned long long)(long long)value << 1) ^ (unsigned long long)((long long)value >> 63);
+}
+
+// Reverses zigzag
+static int unzigzag(unsigned long long value)
+{
+    return (int)((long long)(value >> 1) ^ -(long long)(value & 1));
+}
+
+// --------------------
+// Snapshot Functions
+// --------------------
+
+// Encodes a game into the buffer; returns the number of bytes written, or 0 if the buffer is too small
+size_t saveSnapshot(const Game* game, unsigned char* buffer, size_t size)
+{
+    SnapshotWriter writer = {buffer, size, 0, false};
+
+    putBytes(&writer, "SNAP", 4);
+    putByte(&writer, SNAPSHOT_VERSION);
+    putByte(&writer, LENGTH);
+    putByte(&writer, (game->turn == Player2 ? 1 : 0) | (game->gameOver ? 2 : 0) |
+                     (game->player1WantsToEnd ? 4 : 0) | (game->player2WantsToEnd ? 8 : 0));
+    putVarint(&writer, zigzag(game->player1.score));
+    putVarint(&writer, zigzag(game->player2.score));
+
+    putFixed(&writer, game->bag.rngState, 8);
+    putVarint(&writer, (unsigned long long)game->bag.remaining);
+    putBytes(&writer, game->bag.letters, game->bag.remaining);
+
+    putBytes(&writer, game->player1.letters, MAX_LETTERS);
+    putBytes(&writer, game->player2.letters, MAX_LETTERS);
+
+    unsigned char occupancy[OCCUPANCY_BYTES] = {0};
+    char letters[LENGTH * LENGTH];
+    int numLetters = 0;
+    for (int i = 0; i < LENGTH * LENGTH; i++)
+    {
+        const Piece* piece = &game->board[i / LENGTH][i % LENGTH];
+        if (piece->is_placed)
+        {
+            occupancy[i / 8] |= 1 << (i % 8);
+            letters[numLetters++] = (char)(piece->letter | (piece->is_blank ? BLANK_TILE : 0));
+        }
+    }
+    putBytes(&writer, occupancy, OCCUPANCY_BYTES);
+    putBytes(&writer, letters, numLetters);
+
+    if (writer.overflow)
+    {
+        return 0;
+    }
+    putFixed(&writer, checksum(buffer, writer.used), 4);
+    return writer.overflow ? 0 : writer.used;
+}
+
+// Decodes a snapshot into a game validating words against the lexicon; returns false on a
+// malformed, corrupted or unknown-version snapshot, leaving the game untouched
+bool loadSnapshot(Game* game, const Lexicon* lexicon, const unsigned char* data, size_t length)
+{
+    if (length < 9 || memcmp(data, "SNAP", 4) != 0)
+    {
+        return false;
+    }
+
+    // The checksum covers everything before it, so a torn or damaged file is rejected
+    SnapshotReader trailer = {data, length, length - 4, false};
+    if ((unsigned int)getFixed(&trailer, 4) != checksum(data, length - 4))
+    {
+        return false;
+    }
+
+    SnapshotReader reader = {data, length - 4, 4, false};
+    int version = getByte(&reader);
+    int size = (version == SNAPSHOT_VERSION) ? getByte(&reader) : 15;
+    if ((version != SNAPSHOT_VERSION && version != SNAPSHOT_VERSION_UNSIZED) || size != LENGTH)
+    {
+        return false;
+    }
+
+    // Decode into a scratch game so a bad snapshot leaves the caller's game as it was
+    Game restored;
+    resetBoard(&restored);
+    restored.lexicon = lexicon;
+
+    unsigned char flags = getByte(&reader);
+    restored.turn = (flags & 1) ? Player2 : Player1;
+    restored.gameOver = (flags & 2) != 0;
+    restored.player1WantsToEnd = (flags & 4) != 0;
+    restored.player2WantsToEnd = (flags & 8) != 0;
+    restored.player1.score = unzigzag(getVarint(&reader));
+    restored.player2.score = unzigzag(getVarint(&reader));
+
+    restored.bag.rngState = getFixed(&reader, 8);
+    unsigned long long remaining = getVarint(&reader);
+    if (remaining > sizeof(restored.bag.letters))
+    {
+        return false;
+    }
+    restored.bag.remaining = (int)remaining;
+    memset(restored.bag.letters, '\0', sizeof(restored.bag.letters));
+    getBytes(&reader, restored.bag.letters, restored.bag.remaining);
+
+    getBytes(&reader, restored.player1.letters, MAX_LETTERS);
+    getBytes(&reader, restored.player2.letters, MAX_LETTERS);
+
+    unsigned char occupancy[OCCUPANCY_BYTES];
+    getBytes(&reader, occupancy, OCCUPANCY_BYTES);
+    for (int i = 0; i < LENGTH * LENGTH && !reader.bad; i++)
+    {
+        if (occupancy[i / 8] & (1 << (i % 8)))
+        {
+            setSquare(&restored, i % LENGTH, i / LENGTH, (char)getByte(&reader));
+        }
+    }
+
+    if (reader.bad || reader.position != reader.length)
+    {
+        return false;
+    }
+    cloneGame(&restored, game);
+    return true;
+}
+
+// Writes a snapshot file, replacing the previous one atomically
+bool writeSnapshotFile(const char* filename, const Game* game)
+{
+    unsigned char buffer[SNAPSHOT_MAX_SIZE];
+    size_t length = saveSnapshot(game, buffer, sizeof(buffer));
+
+    // Write beside the old file and rename over it, so a crash never leaves half a snapshot
+    char temporary[1024];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", filename);
+    FILE* file = fopen(temporary, "wb");
+    if (!file)
+    {
+        perror("Error creating snapshot file");
+        return false;
+    }
+    bool written = length > 0 && fwrite(buffer, 1, length, file) == length;
+    written = (fclose(file) == 0) && written;
+    if (!written || rename(temporary, filename) != 0)
+    {
+        perror("Error writing snapshot file");
+        remove(temporary);
+        return false;
+    }
+    return true;
+}
+
+// Reads a snapshot file; returns false if it is missing or invalid
+bool readSnapshotFile(const char* filename, Game* game, const Lexicon* lexicon)
+{
+    FILE* file = fopen(filename, "rb");
+    if (!file)
+    {
+        return false;
+    }
+    unsigned char buffer[SNAPSHOT_MAX_SIZE];
+    size_t length = fread(buffer, 1, sizeof(buffer), file);
+    fclose(file);
+    return loadSnapshot(game, lexicon, buffer, length);
+}
@@ -0,0 +1,55 @@
+// snapshot.h
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "scrabble.h"
+#include <stddef.h>
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Version written in new snapshots
+#define SNAPSHOT_VERSION 4
+
+// Last version without the board size byte; loadSnapshot still reads it as a 15 x 15 board
+#define SNAPSHOT_VERSION_UNSIZED 3
+
+// Largest encoded snapshot, for callers sizing a buffer
+#define SNAPSHOT_MAX_SIZE 512
+
+// A snapshot is the complete state of a game, without pointers, so it can be restored in another
+// process. All numbers are little endian; varints are unsigned LEB128, scores zigzag encoded.
+//
+//   "SNAP", version byte, board size byte (LENGTH)
+//   flags byte      bit 0 turn (Player2), bit 1 game over, bits 2-3 players who asked to end
+//   scores          two varints
+//   bag             8-byte random generator state, remaining count varint, the remaining letter codes in
+//                   bag order (the order decides the next draws)
+//   racks           MAX_LETTERS bytes per player, 0 for empty slots
+//   board           LENGTH * LENGTH bits of occupancy, row by row, then the placed letters in that order,
+//                   BLANK_TILE set on those laid by a blank
+//   checksum        4-byte FNV-1a of every byte before it
+//
+// The board's multipliers are not stored; they come from the layout in use. A snapshot of another board
+// size is rejected.
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Encodes a game into the buffer; returns the number of bytes written, or 0 if the buffer is too small
+size_t saveSnapshot(const Game* game, unsigned char* buffer, size_t size);
+
+// Decodes a snapshot into a game validating words against the lexicon; returns false on a
+// malformed, corrupted or unknown-version snapshot, leaving the game untouched
+bool loadSnapshot(Game* game, const Lexicon* lexicon, const unsigned char* data, size_t length);
+
+// Writes a snapshot file, replacing the previous one atomically; returns false on failure
+bool writeSnapshotFile(const char* filename, const Game* game);
+
+// Reads a snapshot file; returns false if it is missing or invalid
+bool readSnapshotFile(const char* filename, Game* game, const Lexicon* lexicon);
+
+#endif // SNAPSHOT_H
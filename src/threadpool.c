@@ -0,0 +1,171 @@
+// threadpool.c
+
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// --------------------
+// Pool Threads
+// --------------------
+
+// Runs queued tasks until the pool stops
+static void* poolLoop(void* arg)
+{
+    ThreadPool* pool = arg;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (true)
+    {
+        if (pool->head == NULL)
+        {
+            if (pool->quit)
+            {
+                break;
+            }
+            pthread_cond_wait(&pool->wake, &pool->mutex);
+            continue;
+        }
+
+        // Take the oldest task and run it without holding the lock
+        Task* task = pool->head;
+        pool->head = task->next;
+        if (pool->head == NULL)
+        {
+            pool->tail = NULL;
+        }
+        TaskFunction function = task->function;
+        void* taskArg = task->arg;
+        task->next = pool->freeTasks;
+        pool->freeTasks = task;
+        pthread_mutex_unlock(&pool->mutex);
+
+        function(taskArg);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->outstanding == 0)
+        {
+            pthread_cond_broadcast(&pool->idle);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+// --------------------
+// Pool Control
+// --------------------
+
+// Returns the number of cores available to the process
+int availableCores(void)
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+}
+
+// Starts a pool with the given number of threads (0 uses one per core)
+void startThreadPool(ThreadPool* pool, int numThreads)
+{
+    if (numThreads <= 0)
+    {
+        numThreads = availableCores();
+    }
+    if (numThreads > MAX_POOL_THREADS)
+    {
+        numThreads = MAX_POOL_THREADS;
+    }
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+    pool->head = NULL;
+    pool->tail = NULL;
+    pool->freeTasks = NULL;
+    pool->outstanding = 0;
+    pool->quit = false;
+    pool->numThreads = numThreads;
+
+    for (int i = 0; i < numThreads; i++)
+    {
+        if (pthread_create(&pool->threads[i], NULL, poolLoop, pool) != 0)
+        {
+            perror("Error starting pool thread");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// Waits for the queued tasks to finish and joins the threads
+void stopThreadPool(ThreadPool* pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < pool->numThreads; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    while (pool->freeTasks != NULL)
+    {
+        Task* task = pool->freeTasks;
+        pool->freeTasks = task->next;
+        free(task);
+    }
+    pthread_cond_destroy(&pool->idle);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->mutex);
+}
+
+// Queues a task; it runs on the first free thread
+void submitTask(ThreadPool* pool, TaskFunction function, void* arg)
+{
+    pthread_mutex_lock(&pool->mutex);
+
+    // Reuse a finished node when there is one, so a busy pool does not allocate per task
+    Task* task = pool->freeTasks;
+    if (task != NULL)
+    {
+        pool->freeTasks = task->next;
+    }
+    else
+    {
+        task = malloc(sizeof(Task));
+        if (!task)
+        {
+            perror("Error allocating task");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    task->function = function;
+    task->arg = arg;
+    task->next = NULL;
+    if (pool->tail != NULL)
+    {
+        pool->tail->next = task;
+    }
+    else
+    {
+        pool->head = task;
+    }
+    pool->tail = task;
+    pool->outstanding++;
+
+    pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+// Blocks until every task submitted so far has finished
+void waitForTasks(ThreadPool* pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->outstanding > 0)
+    {
+        pthread_cond_wait(&pool->idle, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
@@ -0,0 +1,66 @@
+// threadpool.h
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <stdbool.h>
+#include <pthread.h>
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Largest number of threads a pool can run
+#define MAX_POOL_THREADS 64
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents a function queued to run on one of the pool's threads
+typedef void (*TaskFunction)(void* arg);
+
+// Represents a queued task
+typedef struct Task
+{
+    TaskFunction function;         // Function to run
+    void* arg;                     // Argument passed to the function
+    struct Task* next;             // Next task in the queue
+} Task;
+
+// Represents a fixed set of threads that run queued tasks in submission order
+typedef struct
+{
+    pthread_t threads[MAX_POOL_THREADS];
+    int numThreads;
+
+    pthread_mutex_t mutex;         // Protects every field below
+    pthread_cond_t wake;           // Signalled when a task is queued or the pool stops
+    pthread_cond_t idle;           // Signalled when the last outstanding task finishes
+    Task* head;                    // Oldest queued task
+    Task* tail;                    // Newest queued task
+    Task* freeTasks;               // Finished task nodes kept for reuse
+    int outstanding;               // Tasks queued or running
+    bool quit;                     // Set to stop the threads
+} ThreadPool;
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Returns the number of cores available to the process
+int availableCores(void);
+
+// Starts a pool with the given number of threads (0 uses one per core)
+void startThreadPool(ThreadPool* pool, int numThreads);
+
+// Waits for the queued tasks to finish and joins the threads
+void stopThreadPool(ThreadPool* pool);
+
+// Queues a task; it runs on the first free thread
+void submitTask(ThreadPool* pool, TaskFunction function, void* arg);
+
+// Blocks until every task submitted so far has finished
+void waitForTasks(ThreadPool* pool);
+
+#endif // THREADPOOL_H
@@ -0,0 +1,16 @@
+// util.c
+
+#include "util.h"
+#include <time.h>
+
+// --------------------
+// Time Functions
+// --------------------
+
+// Returns a monotonic timestamp in seconds
+double nowSeconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -0,0 +1,37 @@
+// util.h
+
+#ifndef UTIL_H
+#define UTIL_H
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Increment of a splitmix64 sequence, the golden ratio as a 64-bit fraction
+#define SPLITMIX_INCREMENT 0x9E3779B97F4A7C15ull
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Scrambles the bits of a 64-bit value (the splitmix64 finalizer). Inline, since the hashes of the word
+// lookups and move caches call it for every key
+static inline unsigned long long mixBits(unsigned long long x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Returns the next number of a splitmix64 sequence, advancing its state
+static inline unsigned long long nextSplitMix(unsigned long long* state)
+{
+    return mixBits(*state += SPLITMIX_INCREMENT);
+}
+
+// Returns a monotonic timestamp in seconds
+double nowSeconds(void);
+
+#endif // UTIL_H
@@ -0,0 +1,411 @@
+// wordhash.c
+
+#include "wordhash.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Seeds tried before the build gives up; a seed fails only when two words hash alike
+#define MAX_SEEDS 8
+
+// Most words one bucket may hold; a seed that crowds more into one is dropped
+#define MAX_BUCKET_WORDS 64
+
+// Rounds of displacements, each a shift through every slot, tried on a bucket before the seed is dropped
+#define DISPLACEMENT_ROUNDS 64
+
+// --------------------
+// Hashing
+// --------------------
+
+// Represents the hashes of one word
+typedef struct
+{
+    unsigned long long primary;    // Picks the bucket and gives the fingerprint
+    unsigned long long secondary;  // Picks the first slot and the step of the displacements
+    int length;
+} WordKey;
+
+// Hashes a word with a seed
+static WordKey hashWord(const char* word, unsigned long long seed)
+{
+    unsigned long long hash = 14695981039346656037ull ^ seed;
+    int length = 0;
+    for (; word[length] != '\0'; length++)
+    {
+        hash = (hash ^ (unsigned char)word[length]) * 1099511628211ull;
+    }
+    WordKey key;
+    key.primary = mixBits(hash);
+    key.secondary = mixBits(key.primary + 0x9E3779B97F4A7C15ull);
+    key.length = length;
+    return key;
+}
+
+// Returns the slot a word goes to under a displacement: the displacement counts rounds of steps and a
+// shift within the round
+static unsigned int slotOf(const WordKey* key, unsigned int displacement, unsigned int count)
+{
+    unsigned long long first = (key->secondary & 0xFFFFFFFFull) % count;
+    unsigned long long step = (key->secondary >> 32) % count;
+    unsigned long long round = displacement / count;
+    unsigned long long shift = displacement % count;
+    return (unsigned int)((first + round * step + shift) % count);
+}
+
+// Returns the bucket of a word
+static unsigned int bucketOf(const WordKey* key, unsigned int numBuckets)
+{
+    return (unsigned int)(key->primary % numBuckets);
+}
+
+// Returns the fingerprint a slot keeps of its word
+static unsigned short fingerprintOf(const WordKey* key)
+{
+    return (unsigned short)(key->primary >> 48);
+}
+
+// Returns the FNV-1a checksum of a word list, which identifies the list a hash was built from
+unsigned long long wordListChecksum(char* const* words, int count)
+{
+    unsigned long long hash = 14695981039346656037ull;
+    for (int i = 0; i < count; i++)
+    {
+        for (const char* c = words[i]; ; c++)
+        {
+            hash = (hash ^ (unsigned char)*c) * 1099511628211ull;
+            if (*c == '\0')
+            {
+                break;
+            }
+        }
+    }
+    return hash;
+}
+
+// --------------------
+// Construction
+// --------------------
+
+// Points the parts of a hash at their places in its block
+static void locateParts(WordHash* hash)
+{
+    const char* base = hash->block;
+    hash->header = hash->block;
+    hash->displacements = (const unsigned int*)(base + sizeof(WordHashHeader));
+    hash->slots = (const WordSlot*)(hash->displacements + hash->header->numBuckets);
+    hash->storage = (const char*)(hash->slots + hash->header->count);
+}
+
+// Finds a displacement for every bucket, largest buckets first while most slots are free; returns false
+// if some bucket has none, which only happens when two of its words hash alike
+static bool placeBuckets(const WordKey* keys, int count, unsigned int numBuckets, unsigned int* displacements,
+                         int* slotWords)
+{
+    int* bucketStart = calloc(numBuckets + 1, sizeof(int));
+    int* filled = calloc(numBuckets, sizeof(int));
+    int* bucketWords = malloc((count > 0 ? count : 1) * sizeof(int));
+    unsigned int* order = malloc(numBuckets * sizeof(unsigned int));
+    int* sizeStart = calloc(MAX_BUCKET_WORDS + 2, sizeof(int));
+    if (!bucketStart || !filled || !bucketWords || !order || !sizeStart)
+    {
+        perror("Error allocating word hash");
+        exit(EXIT_FAILURE);
+    }
+
+    // Group the words by bucket
+    for (int i = 0; i < count; i++)
+    {
+        bucketStart[bucketOf(&keys[i], numBuckets) + 1]++;
+    }
+    for (unsigned int b = 0; b < numBuckets; b++)
+    {
+        int size = bucketStart[b + 1];
+        if (size > MAX_BUCKET_WORDS)
+        {
+            free(bucketStart);
+            free(filled);
+            free(bucketWords);
+            free(order);
+            free(sizeStart);
+            return false;
+        }
+        sizeStart[MAX_BUCKET_WORDS - size + 1]++;
+        bucketStart[b + 1] += bucketStart[b];
+    }
+    for (int i = 0; i < count; i++)
+    {
+        unsigned int b = bucketOf(&keys[i], numBuckets);
+        bucketWords[bucketStart[b] + filled[b]++] = i;
+    }
+
+    // Order the buckets from the largest to the smallest
+    for (int s = 1; s <= MAX_BUCKET_WORDS + 1; s++)
+    {
+        sizeStart[s] += sizeStart[s - 1];
+    }
+    for (unsigned int b = 0; b < numBuckets; b++)
+    {
+        order[sizeStart[MAX_BUCKET_WORDS - filled[b]]++] = b;
+    }
+    free(filled);
+    free(sizeStart);
+
+    for (int i = 0; i < count; i++)
+    {
+        slotWords[i] = -1;
+    }
+    unsigned long long limit = (unsigned long long)count * DISPLACEMENT_ROUNDS;
+    if (limit > 0xFFFFFFFFull)
+    {
+        limit = 0xFFFFFFFFull;
+    }
+
+    bool placed = true;
+    for (unsigned int o = 0; o < numBuckets && placed; o++)
+    {
+        unsigned int b = order[o];
+        const int* words = &bucketWords[bucketStart[b]];
+        int size = bucketStart[b + 1] - bucketStart[b];
+        if (size == 0)
+        {
+            displacements[b] = 0;
+            continue;
+        }
+
+        placed = false;
+        for (unsigned long long displacement = 0; displacement < limit && !placed; displacement++)
+        {
+            // Every word of the bucket needs a free slot, and no two of them the same one
+            unsigned int slots[MAX_BUCKET_WORDS];
+            bool fits = true;
+            for (int w = 0; w < size && fits; w++)
+            {
+                slots[w] = slotOf(&keys[words[w]], (unsigned int)displacement, (unsigned int)count);
+                fits = slotWords[slots[w]] < 0;
+                for (int v = 0; v < w && fits; v++)
+                {
+                    fits = slots[v] != slots[w];
+                }
+            }
+            if (fits)
+            {
+                for (int w = 0; w < size; w++)
+                {
+                    slotWords[slots[w]] = words[w];
+                }
+                displacements[b] = (unsigned int)displacement;
+                placed = true;
+            }
+        }
+    }
+
+    free(bucketStart);
+    free(bucketWords);
+    free(order);
+    return placed;
+}
+
+// Builds the perfect hash of a list of distinct words; exits if no displacement can be found
+WordHash* buildWordHash(char* const* words, int count)
+{
+    unsigned int numBuckets = (unsigned int)(count / WORD_HASH_BUCKET_SIZE + 1);
+    unsigned long long storageSize = 0;
+    for (int i = 0; i < count; i++)
+    {
+        storageSize += strlen(words[i]) + 1;
+    }
+
+    WordHash* hash = malloc(sizeof(WordHash));
+    size_t blockSize = sizeof(WordHashHeader) + numBuckets * sizeof(unsigned int) + count * sizeof(WordSlot) +
+                       storageSize;
+    void* block = calloc(1, blockSize);
+    WordKey* keys = malloc((count > 0 ? count : 1) * sizeof(WordKey));
+    int* slotWords = malloc((count > 0 ? count : 1) * sizeof(int));
+    if (!hash || !block || !keys || !slotWords)
+    {
+        perror("Error allocating word hash");
+        exit(EXIT_FAILURE);
+    }
+
+    WordHashHeader* header = block;
+    memcpy(header->magic, "WHSH", 4);
+    header->version = WORD_HASH_VERSION;
+    header->count = (unsigned int)count;
+    header->numBuckets = numBuckets;
+    header->checksum = wordListChecksum(words, count);
+    header->storageSize = storageSize;
+    hash->block = block;
+    hash->blockSize = blockSize;
+    hash->mapped = false;
+    locateParts(hash);
+    unsigned int* displacements = (unsigned int*)hash->displacements;
+    WordSlot* slots = (WordSlot*)hash->slots;
+    char* storage = (char*)hash->storage;
+
+    // A seed fails only if two words of a bucket collide on both hashes; try another then
+    bool placed = false;
+    for (unsigned long long attempt = 0; attempt < MAX_SEEDS && !placed; attempt++)
+    {
+        header->seed = mixBits(attempt + 1);
+        for (int i = 0; i < count; i++)
+        {
+            keys[i] = hashWord(words[i], header->seed);
+        }
+        placed = placeBuckets(keys, count, numBuckets, displacements, slotWords);
+    }
+    if (!placed)
+    {
+        fprintf(stderr, "Error building word hash: no displacement found\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Pack the words in list order and point each slot at its word
+    unsigned int* offsets = malloc((count > 0 ? count : 1) * sizeof(unsigned int));
+    if (!offsets)
+    {
+        perror("Error allocating word hash");
+        exit(EXIT_FAILURE);
+    }
+    size_t used = 0;
+    for (int i = 0; i < count; i++)
+    {
+        size_t length = strlen(words[i]) + 1;
+        memcpy(storage + used, words[i], length);
+        offsets[i] = (unsigned int)used;
+        used += length;
+    }
+    for (int s = 0; s < count; s++)
+    {
+        int word = slotWords[s];
+        slots[s].offset = offsets[word];
+        slots[s].fingerprint = fingerprintOf(&keys[word]);
+        slots[s].length = (unsigned short)keys[word].length;
+    }
+
+    free(offsets);
+    free(keys);
+    free(slotWords);
+    return hash;
+}
+
+// --------------------
+// Files
+// --------------------
+
+// Writes a hash to a file, replacing the previous one atomically
+bool saveWordHash(const WordHash* hash, const char* filename)
+{
+    // Write beside the old file and rename over it, so a reader never maps half a hash
+    char temporary[1024];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", filename);
+    FILE* file = fopen(temporary, "wb");
+    if (!file)
+    {
+        perror("Error creating word hash file");
+        return false;
+    }
+    bool written = fwrite(hash->block, 1, hash->blockSize, file) == hash->blockSize;
+    written = (fclose(file) == 0) && written;
+    if (!written || rename(temporary, filename) != 0)
+    {
+        perror("Error writing word hash file");
+        remove(temporary);
+        return false;
+    }
+    return true;
+}
+
+// Maps a hash file read-only; returns NULL if it is missing, truncated or of another version
+WordHash* mapWordHash(const char* filename)
+{
+    int fd = open(filename, O_RDONLY);
+    struct stat info;
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(WordHashHeader))
+    {
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)info.st_size;
+    void* block = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (block == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    // The sizes in the header must account for the whole file
+    const WordHashHeader* header = block;
+    unsigned long long expected = sizeof(WordHashHeader) + (unsigned long long)header->numBuckets * sizeof(unsigned int) +
+                                  (unsigned long long)header->count * sizeof(WordSlot) + header->storageSize;
+    if (memcmp(header->magic, "WHSH", 4) != 0 || header->version != WORD_HASH_VERSION || expected != size ||
+        header->numBuckets == 0)
+    {
+        munmap(block, size);
+        return NULL;
+    }
+
+    WordHash* hash = malloc(sizeof(WordHash));
+    if (!hash)
+    {
+        perror("Error allocating word hash");
+        exit(EXIT_FAILURE);
+    }
+    hash->block = block;
+    hash->blockSize = size;
+    hash->mapped = true;
+    locateParts(hash);
+    return hash;
+}
+
+// Frees or unmaps a hash
+void freeWordHash(WordHash* hash)
+{
+    if (!hash)
+    {
+        return;
+    }
+    if (hash->mapped)
+    {
+        munmap(hash->block, hash->blockSize);
+    }
+    else
+    {
+        free(hash->block);
+    }
+    free(hash);
+}
+
+// --------------------
+// Lookup
+// --------------------
+
+// Checks if a word is in the list the hash was built from
+bool lookupWordHash(const WordHash* hash, const char* word)
+{
+    const WordHashHeader* header = hash->header;
+    if (header->count == 0)
+    {
+        return false;
+    }
+
+    WordKey key = hashWord(word, header->seed);
+    unsigned int displacement = hash->displacements[bucketOf(&key, header->numBuckets)];
+    const WordSlot* slot = &hash->slots[slotOf(&key, displacement, header->count)];
+
+    // Words outside the list almost always stop at the fingerprint; a match is confirmed on the word itself
+    if (slot->fingerprint != fingerprintOf(&key) || slot->length != key.length)
+    {
+        return false;
+    }
+    return memcmp(hash->storage + slot->offset, word, key.length) == 0;
+}
@@ -0,0 +1,95 @@
+// wordhash.h
+
+#ifndef WORDHASH_H
+#define WORDHASH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Version written in new hash files and the only one mapWordHash accepts
+#define WORD_HASH_VERSION 1
+
+// Average number of words sharing a displacement; more words per bucket make the table smaller and
+// the build slower
+#define WORD_HASH_BUCKET_SIZE 5
+
+// A word hash answers "is this a word?" for a fixed word list with a minimal perfect hash (hash, displace
+// and compress): each word's 64-bit hashes pick a bucket and a first slot, and the bucket's displacement
+// moves every word of the bucket to a slot no other word has. There are exactly as many slots as words.
+// A slot holds a 16-bit fingerprint of its word and the word's offset in the packed storage, so a word
+// that is not in the list is turned away after reading one displacement and one slot, and only a
+// fingerprint match reads the stored word to confirm it.
+//
+// The hash lives in one block laid out as its file, so a saved hash is mapped and used in place:
+//
+//   header          WordHashHeader
+//   displacements   numBuckets 4-byte displacements
+//   slots           count WordSlot
+//   storage         storageSize bytes of NUL terminated words
+//
+// Numbers are in host byte order; a file from another machine, another version or another word list is
+// simply rebuilt.
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents the start of a hash block
+typedef struct
+{
+    char magic[4];                 // "WHSH"
+    unsigned int version;
+    unsigned int count;            // Number of words, and of slots
+    unsigned int numBuckets;
+    unsigned long long seed;       // Seed of the word hashes the displacements were found for
+    unsigned long long checksum;   // FNV-1a of the word list the hash was built from
+    unsigned long long storageSize;
+} WordHashHeader;
+
+// Represents the slot of one word
+typedef struct
+{
+    unsigned int offset;           // Offset of the word in the storage
+    unsigned short fingerprint;    // Top bits of the word's hash, compared before the word is read
+    unsigned short length;         // Length of the word in letter codes
+} WordSlot;
+
+// Represents a minimal perfect hash over a word list, built in memory or mapped from a file
+typedef struct WordHash
+{
+    const WordHashHeader* header;
+    const unsigned int* displacements;
+    const WordSlot* slots;
+    const char* storage;
+    void* block;                   // Whole hash as laid out in its file
+    size_t blockSize;
+    bool mapped;                   // The block is a mapping of a file rather than heap memory
+} WordHash;
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Returns the FNV-1a checksum of a word list, which identifies the list a hash was built from
+unsigned long long wordListChecksum(char* const* words, int count);
+
+// Builds the perfect hash of a list of distinct words; exits if no displacement can be found
+WordHash* buildWordHash(char* const* words, int count);
+
+// Writes a hash to a file, replacing the previous one atomically; returns false on failure
+bool saveWordHash(const WordHash* hash, const char* filename);
+
+// Maps a hash file read-only; returns NULL if it is missing, truncated or of another version
+WordHash* mapWordHash(const char* filename);
+
+// Frees or unmaps a hash
+void freeWordHash(WordHash* hash);
+
+// Checks if a word is in the list the hash was built from
+bool lookupWordHash(const WordHash* hash, const char* word);
+
+#endif // WORDHASH_H
@@ -0,0 +1,360 @@
+// wordlist.c
+
+#include "wordlist.h"
+#include "arbol_diccionario.h"
+#include "wordhash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Chunks the file is cut into per pool thread, so a slow chunk does not hold up the others
+#define CHUNKS_PER_THREAD 4
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents one chunk of the file and the sorted words normalized from it
+typedef struct
+{
+    const char* text;              // Mapped file
+    size_t start;                  // First byte of the chunk
+    size_t end;                    // Byte after the chunk; chunks end on whitespace
+    char* storage;                 // Output text, laid out at the same offsets as the input
+    char** words;                  // Sorted distinct words of the chunk (or of the shards merged into it)
+    int count;
+} Shard;
+
+// Represents two shards merged into the first one
+typedef struct
+{
+    Shard* into;
+    Shard* from;
+} MergeTask;
+
+// Represents a subtree of the balanced tree filled by one task
+typedef struct
+{
+    Node* nodes;
+    char* const* words;
+    int first;
+    int last;
+} SubtreeTask;
+
+// --------------------
+// Normalization
+// --------------------
+
+// Orders two word pointers alphabetically
+static int compareWords(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// Removes the repeated words of a sorted array; returns the new count
+static int removeDuplicates(char** words, int count)
+{
+    int distinct = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (distinct == 0 || strcmp(words[i], words[distinct - 1]) != 0)
+        {
+            words[distinct++] = words[i];
+        }
+    }
+    return distinct;
+}
+
+// Encodes, sorts and deduplicates the words of one chunk
+static void normalizeShard(void* arg)
+{
+    Shard* shard = arg;
+    int capacity = 0;
+    shard->words = NULL;
+    shard->count = 0;
+
+    size_t position = shard->start;
+    while (position < shard->end)
+    {
+        while (position < shard->end && isspace((unsigned char)shard->text[position]))
+        {
+            position++;
+        }
+        size_t first = position;
+        while (position < shard->end && !isspace((unsigned char)shard->text[position]))
+        {
+            position++;
+        }
+        size_t length = position - first;
+        char text[2 * MAX_WORD_LENGTH_LOCAL];
+        if (length == 0 || length >= sizeof(text))
+        {
+            continue; // Too long to ever be played
+        }
+        memcpy(text, shard->text + first, length);
+        text[length] = '\0';
+
+        // A word never has more letter codes than bytes, so it is encoded in place; its separator (or the
+        // extra byte at the end of the storage) takes the terminator
+        char* word = shard->storage + first;
+        if (encodeWord(text, word, MAX_WORD_LENGTH_LOCAL) <= 0)
+        {
+            continue; // Holds a letter that is not a tile, or is too long to ever be played
+        }
+
+        if (shard->count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 1024;
+            char** words = realloc(shard->words, capacity * sizeof(char*));
+            if (!words)
+            {
+                perror("Error allocating word list");
+                exit(EXIT_FAILURE);
+            }
+            shard->words = words;
+        }
+        shard->words[shard->count++] = word;
+    }
+
+    qsort(shard->words, shard->count, sizeof(char*), compareWords);
+    shard->count = removeDuplicates(shard->words, shard->count);
+}
+
+// Merges the sorted words of two shards into the first, dropping words both have
+static void mergeShards(void* arg)
+{
+    MergeTask* task = arg;
+    Shard* a = task->into;
+    Shard* b = task->from;
+    char** merged = malloc(((size_t)a->count + b->count + 1) * sizeof(char*));
+    if (!merged)
+    {
+        perror("Error allocating word list");
+        exit(EXIT_FAILURE);
+    }
+
+    int i = 0, j = 0, count = 0;
+    while (i < a->count || j < b->count)
+    {
+        int order = (i == a->count) ? 1 : (j == b->count) ? -1 : strcmp(a->words[i], b->words[j]);
+        merged[count++] = (order <= 0) ? a->words[i] : b->words[j];
+        i += (order <= 0);
+        j += (order >= 0);
+    }
+
+    free(a->words);
+    free(b->words);
+    a->words = merged;
+    a->count = count;
+    b->words = NULL;
+    b->count = 0;
+}
+
+// --------------------
+// Word List Functions
+// --------------------
+
+// Reads a whitespace separated word file into a normalized list, splitting the work across the pool
+void readWordList(const char* filename, ThreadPool* pool, WordList* list)
+{
+    int fd = open(filename, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0)
+    {
+        perror("Error opening dictionary file");
+        exit(EXIT_FAILURE);
+    }
+    size_t size = (size_t)info.st_size;
+
+    const char* text = "";
+    if (size > 0)
+    {
+        text = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (text == MAP_FAILED)
+        {
+            perror("Error mapping dictionary file");
+            exit(EXIT_FAILURE);
+        }
+        madvise((void*)text, size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    // One extra byte terminates a last word that has no newline after it
+    list->storage = malloc(size + 1);
+    int numShards = pool->numThreads * CHUNKS_PER_THREAD;
+    Shard* shards = calloc(numShards, sizeof(Shard));
+    MergeTask* merges = malloc(numShards * sizeof(MergeTask));
+    if (!list->storage || !shards || !merges)
+    {
+        perror("Error allocating word list");
+        exit(EXIT_FAILURE);
+    }
+
+    // Cut the file on whitespace so no word is split between two chunks
+    size_t start = 0;
+    for (int i = 0; i < numShards; i++)
+    {
+        size_t end = (i == numShards - 1) ? size : size / numShards * (i + 1);
+        end = (end < start) ? start : end;
+        while (end < size && !isspace((unsigned char)text[end]))
+        {
+            end++;
+        }
+        shards[i].text = text;
+        shards[i].start = start;
+        shards[i].end = end;
+        shards[i].storage = list->storage;
+        submitTask(pool, normalizeShard, &shards[i]);
+        start = end;
+    }
+    waitForTasks(pool);
+    if (size > 0)
+    {
+        munmap((void*)text, size);
+    }
+
+    // Merge neighbouring shards pairwise; each round halves their number
+    for (int step = 1; step < numShards; step *= 2)
+    {
+        int numMerges = 0;
+        for (int i = 0; i + step < numShards; i += 2 * step)
+        {
+            merges[numMerges].into = &shards[i];
+            merges[numMerges].from = &shards[i + step];
+            submitTask(pool, mergeShards, &merges[numMerges]);
+            numMerges++;
+        }
+        waitForTasks(pool);
+    }
+
+    list->words = shards[0].words;
+    list->count = shards[0].count;
+    free(shards);
+    free(merges);
+}
+
+// Frees a word list
+void freeWordList(WordList* list)
+{
+    free(list->words);
+    free(list->storage);
+    list->words = NULL;
+    list->storage = NULL;
+    list->count = 0;
+}
+
+// --------------------
+// Lexicon Construction
+// --------------------
+
+// Fills one subtree of the balanced tree
+static void buildSubtree(void* arg)
+{
+    SubtreeTask* task = arg;
+    buildBalanced(task->nodes, task->words, task->first, task->last);
+}
+
+// Fills the top levels of the balanced tree and queues the subtrees below them
+// Node i holds word i, so a parent knows where its children are before they are filled
+static Node* linkTopLevels(Node* nodes, char* const* words, int first, int last, int depth, ThreadPool* pool,
+                           SubtreeTask* tasks, int* numTasks)
+{
+    if (first > last)
+    {
+        return NULL;
+    }
+    int middle = first + (last - first) / 2;
+    if (depth == 0)
+    {
+        SubtreeTask* task = &tasks[(*numTasks)++];
+        task->nodes = nodes;
+        task->words = words;
+        task->first = first;
+        task->last = last;
+        submitTask(pool, buildSubtree, task);
+        return &nodes[middle];
+    }
+
+    Node* node = &nodes[middle];
+    strcpy(node->word, words[middle]);
+    node->left = linkTopLevels(nodes, words, first, middle - 1, depth - 1, pool, tasks, numTasks);
+    node->right = linkTopLevels(nodes, words, middle + 1, last, depth - 1, pool, tasks, numTasks);
+    return node;
+}
+
+// Builds a balanced lexicon tree from a normalized list, filling disjoint subtrees concurrently
+Lexicon* buildLexicon(const WordList* list, ThreadPool* pool)
+{
+    Lexicon* lexicon = malloc(sizeof(Lexicon));
+    Node* nodes = malloc((list->count > 0 ? list->count : 1) * sizeof(Node));
+    int depth = 0;
+    while ((1 << depth) < pool->numThreads * CHUNKS_PER_THREAD)
+    {
+        depth++;
+    }
+    SubtreeTask* tasks = malloc((1 << depth) * sizeof(SubtreeTask));
+    if (!lexicon || !nodes || !tasks)
+    {
+        perror("Error allocating lexicon");
+        exit(EXIT_FAILURE);
+    }
+
+    int numTasks = 0;
+    lexicon->root = linkTopLevels(nodes, list->words, 0, list->count - 1, depth, pool, tasks, &numTasks);
+    lexicon->nodes = nodes;
+    lexicon->hash = NULL;
+    lexicon->checksum = wordListChecksum(list->words, list->count);
+    waitForTasks(pool);
+
+    free(tasks);
+    return lexicon;
+}
+
+// Gives a lexicon the perfect hash of its word list, mapped from the hash file when that was built from
+// the same words, else built and written there
+static void attachWordHash(Lexicon* lexicon, const WordList* list, const char* hashFile)
+{
+    WordHash* hash = mapWordHash(hashFile);
+    if (hash != NULL && (hash->header->checksum != lexicon->checksum || hash->header->count != (unsigned int)list->count))
+    {
+        freeWordHash(hash);
+        hash = NULL;
+    }
+    if (hash == NULL)
+    {
+        // A hash that cannot be saved still serves this process
+        hash = buildWordHash(list->words, list->count);
+        saveWordHash(hash, hashFile);
+    }
+    lexicon->hash = hash;
+}
+
+// Reads a word file and builds its lexicon with the given number of threads (0 uses one per core)
+Lexicon* loadLexicon(const char* filename, int numThreads)
+{
+    return loadHashedLexicon(filename, NULL, numThreads);
+}
+
+// Reads a word file and builds its lexicon, plus its perfect hash when 'hashFile' is not NULL
+Lexicon* loadHashedLexicon(const char* filename, const char* hashFile, int numThreads)
+{
+    ThreadPool pool;
+    startThreadPool(&pool, numThreads);
+
+    WordList list;
+    readWordList(filename, &pool, &list);
+    Lexicon* lexicon = buildLexicon(&list, &pool);
+    if (hashFile != NULL)
+    {
+        attachWordHash(lexicon, &list, hashFile);
+    }
+
+    stopThreadPool(&pool);
+    freeWordList(&list);
+    return lexicon;
+}
@@ -0,0 +1,45 @@
+// wordlist.h
+
+#ifndef WORDLIST_H
+#define WORDLIST_H
+
+#include "scrabble.h"
+#include "threadpool.h"
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents a normalized word list: letter codes, sorted and without duplicates
+typedef struct
+{
+    char** words;                  // Sorted words, pointing into 'storage'
+    int count;
+    char* storage;                 // Text of every word, NUL terminated
+} WordList;
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Reads a whitespace separated word file into a normalized list, splitting the work across the pool:
+// the mapped file is cut into chunks that are encoded as letter codes, sorted and deduplicated
+// concurrently, then merged pairwise. Words too long to play or holding a letter that is not a tile
+// are dropped. Exits on an unreadable file
+void readWordList(const char* filename, ThreadPool* pool, WordList* list);
+
+// Frees a word list
+void freeWordList(WordList* list);
+
+// Builds a balanced lexicon tree from a normalized list, filling disjoint subtrees concurrently
+Lexicon* buildLexicon(const WordList* list, ThreadPool* pool);
+
+// Reads a word file and builds its lexicon with the given number of threads (0 uses one per core)
+Lexicon* loadLexicon(const char* filename, int numThreads);
+
+// Reads a word file and builds its lexicon; when 'hashFile' is not NULL, isValidWord answers from a
+// perfect hash of the words mapped from that file, which is built and written first if it is missing or
+// was built from other words
+Lexicon* loadHashedLexicon(const char* filename, const char* hashFile, int numThreads);
+
+#endif // WORDLIST_H
@@ -0,0 +1,214 @@
+// worker.c
+
+#include "worker.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// --------------------
+// Worker Thread
+// --------------------
+
+// Publishes the progress of the running job and reports whether it may continue
+static bool reportProgress(void* user, int done, int total)
+{
+    SearchWorker* worker = user;
+
+    pthread_mutex_lock(&worker->mutex);
+    worker->linesDone = done;
+    worker->linesTotal = total;
+    bool keepGoing = !worker->cancel && !worker->quit;
+    pthread_mutex_unlock(&worker->mutex);
+
+    return keepGoing;
+}
+
+// Waits for jobs and searches them until asked to quit
+static void* workerLoop(void* arg)
+{
+    SearchWorker* worker = arg;
+
+    // Position searched by this thread; the GUI never touches it
+    Game* position = malloc(sizeof(Game));
+    if (!position)
+    {
+        perror("Error allocating worker position");
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_mutex_lock(&worker->mutex);
+    while (!worker->quit)
+    {
+        if (!worker->pending)
+        {
+            pthread_cond_wait(&worker->wake, &worker->mutex);
+            continue;
+        }
+
+        // Take the job and release the lock for the duration of the search
+        SearchResult result = {0};
+        result.jobId = worker->jobId;
+        result.kind = worker->kind;
+        cloneGame(&worker->snapshot, position);
+        worker->pending = false;
+        worker->cancel = false;
+        worker->linesDone = 0;
+        pthread_mutex_unlock(&worker->mutex);
+
+        const Player* player = (position->turn == Player1) ? &position->player1 : &position->player2;
+        MoveList list;
+        initMoveList(&list);
+        double searchStart = profilerNow();
+        // The first turn only needs the best placements, which the opening table holds for every rack
+        int generated = findOpeningMoves(worker->openings, position, player->letters, &list)
+                            ? list.count
+                            : generateSortedMoves(worker->cache, position, player->letters, &list, reportProgress, worker);
+        if (generated >= 0)
+        {
+            recordMetric(Metric_HintSearch, profilerNow() - searchStart);
+        }
+        if (generated > 0)
+        {
+            result.found = true;
+            result.move = list.moves[0];
+        }
+        result.movesConsidered = generated > 0 ? generated : 0;
+        freeMoveList(&list);
+
+        pthread_mutex_lock(&worker->mutex);
+
+        // Publish only if the job completed and nothing newer replaced it
+        if (generated >= 0 && !worker->pending && worker->jobId == result.jobId)
+        {
+            worker->result = result;
+            worker->status = Search_Finished;
+        }
+        else if (!worker->pending)
+        {
+            worker->status = Search_Idle;
+        }
+    }
+    pthread_mutex_unlock(&worker->mutex);
+
+    free(position);
+    return NULL;
+}
+
+// --------------------
+// Worker Control
+// --------------------
+
+// Starts the worker thread; searches are answered from the cache or the opening table when they are not NULL
+void startWorker(SearchWorker* worker, MoveCache* cache, const OpeningTable* openings)
+{
+    pthread_mutex_init(&worker->mutex, NULL);
+    worker->cache = cache;
+    worker->openings = openings;
+    pthread_cond_init(&worker->wake, NULL);
+    worker->jobId = 0;
+    worker->pending = false;
+    worker->cancel = false;
+    worker->quit = false;
+    worker->status = Search_Idle;
+    worker->linesDone = 0;
+    worker->linesTotal = 2 * LENGTH;
+
+    if (pthread_create(&worker->thread, NULL, workerLoop, worker) != 0)
+    {
+        perror("Error starting search worker");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Cancels any running job and joins the worker thread
+void stopWorker(SearchWorker* worker)
+{
+    pthread_mutex_lock(&worker->mutex);
+    worker->quit = true;
+    worker->cancel = true;
+    pthread_cond_signal(&worker->wake);
+    pthread_mutex_unlock(&worker->mutex);
+
+    pthread_join(worker->thread, NULL);
+    pthread_cond_destroy(&worker->wake);
+    pthread_mutex_destroy(&worker->mutex);
+}
+
+// Copies the game and queues a search on it, cancelling any job still running
+int submitSearch(SearchWorker* worker, const Game* game, SearchKind kind)
+{
+    pthread_mutex_lock(&worker->mutex);
+    cloneGame(game, &worker->snapshot);
+    worker->kind = kind;
+    worker->jobId++;
+    worker->pending = true;
+    worker->cancel = true; // Stops the previous job, if any; cleared when the new one starts
+    worker->status = Search_Running;
+    worker->linesDone = 0;
+    int jobId = worker->jobId;
+    pthread_cond_signal(&worker->wake);
+    pthread_mutex_unlock(&worker->mutex);
+
+    return jobId;
+}
+
+// Asks the running job to stop; its result is discarded
+void cancelSearch(SearchWorker* worker)
+{
+    pthread_mutex_lock(&worker->mutex);
+    worker->pending = false;
+    worker->cancel = true;
+    worker->jobId++; // Makes any result in flight stale
+    worker->status = Search_Idle;
+    pthread_mutex_unlock(&worker->mutex);
+}
+
+// Collects a finished result without blocking; returns false if none is ready
+bool pollSearch(SearchWorker* worker, SearchResult* result)
+{
+    // The worker only holds the lock for short bookkeeping, never during a search
+    if (pthread_mutex_trylock(&worker->mutex) != 0)
+    {
+        return false;
+    }
+
+    bool ready = worker->status == Search_Finished;
+    if (ready)
+    {
+        *result = worker->result;
+        worker->status = Search_Idle;
+    }
+    pthread_mutex_unlock(&worker->mutex);
+
+    return ready;
+}
+
+// Reports whether a job is queued or running
+bool isSearchRunning(SearchWorker* worker)
+{
+    pthread_mutex_lock(&worker->mutex);
+    bool running = worker->status == Search_Running;
+    pthread_mutex_unlock(&worker->mutex);
+
+    return running;
+}
+
+// Reports whether a job is running or its result has not been collected yet
+bool isSearchBusy(SearchWorker* worker)
+{
+    pthread_mutex_lock(&worker->mutex);
+    bool busy = worker->status != Search_Idle;
+    pthread_mutex_unlock(&worker->mutex);
+
+    return busy;
+}
+
+// Returns the fraction of the running job already searched, between 0 and 1
+float searchProgress(SearchWorker* worker)
+{
+    pthread_mutex_lock(&worker->mutex);
+    float progress = worker->linesTotal > 0 ? (float)worker->linesDone / worker->linesTotal : 0.0f;
+    pthread_mutex_unlock(&worker->mutex);
+
+    return progress;
+}
@@ -0,0 +1,97 @@
+// worker.h
+
+#ifndef WORKER_H
+#define WORKER_H
+
+#include "scrabble.h"
+#include "movegen.h"
+#include "movecache.h"
+#include "openings.h"
+#include <pthread.h>
+
+// --------------------
+// Enumerations
+// --------------------
+
+// Represents the kind of search requested from the worker
+typedef enum
+{
+    Search_Hint,                   // Best placement for the player whose turn it is, shown as a suggestion
+    Search_BotMove,                // Best placement for the player whose turn it is, to be played by the bot
+} SearchKind;
+
+// Represents the lifecycle of the worker's current job
+typedef enum
+{
+    Search_Idle,                   // No job submitted or the last result was collected
+    Search_Running,                // A job is being searched
+    Search_Finished,               // A result is waiting to be collected
+} SearchStatus;
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents the outcome of a finished search
+typedef struct
+{
+    int jobId;                     // Identifier returned by submitSearch
+    SearchKind kind;               // Kind of search that produced the result
+    bool found;                    // Indicates if a legal placement exists
+    Move move;                     // Best placement found
+    int movesConsidered;           // Number of legal placements generated
+} SearchResult;
+
+// Represents a background thread that searches game positions away from the render loop
+typedef struct
+{
+    pthread_t thread;              // Worker thread
+    pthread_mutex_t mutex;         // Protects every field below
+    pthread_cond_t wake;           // Signalled when a job is submitted or the worker must quit
+    MoveCache* cache;              // Move lists of earlier searches, or NULL; set at start and not locked
+    const OpeningTable* openings;  // Best openings of every rack, or NULL; set at start and not locked
+
+    Game snapshot;                 // Private copy of the position to search
+    SearchKind kind;               // Kind of the pending or running job
+    int jobId;                     // Identifier of the latest submitted job
+    bool pending;                  // A job was submitted and not picked up yet
+    bool cancel;                   // The running job must stop as soon as possible
+    bool quit;                     // The worker thread must exit
+
+    SearchStatus status;           // State of the latest job
+    int linesDone;                 // Board lines searched by the running job
+    int linesTotal;                // Board lines the running job has to search
+    SearchResult result;           // Result of the latest finished job
+} SearchWorker;
+
+// --------------------
+// Function Prototypes
+// --------------------
+
+// Starts the worker thread; searches are answered from the cache or, on an empty board, from the opening
+// table when they are not NULL
+void startWorker(SearchWorker* worker, MoveCache* cache, const OpeningTable* openings);
+
+// Cancels any running job and joins the worker thread
+void stopWorker(SearchWorker* worker);
+
+// Copies the game and queues a search on it, cancelling any job still running
+// Returns the job identifier that the result will carry
+int submitSearch(SearchWorker* worker, const Game* game, SearchKind kind);
+
+// Asks the running job to stop; its result is discarded
+void cancelSearch(SearchWorker* worker);
+
+// Collects a finished result without blocking; returns false if none is ready
+bool pollSearch(SearchWorker* worker, SearchResult* result);
+
+// Reports whether a job is queued or running
+bool isSearchRunning(SearchWorker* worker);
+
+// Reports whether a job is running or its result has not been collected yet
+bool isSearchBusy(SearchWorker* worker);
+
+// Returns the fraction of the running job already searched, between 0 and 1
+float searchProgress(SearchWorker* worker);
+
+#endif // WORKER_H
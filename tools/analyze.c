@@ -0,0 +1,276 @@
+// analyze.c
+
+#include "scrabble.h"
+#include "analysis.h"
+#include "record.h"
+#include "gcg.h"
+#include "threadpool.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Largest number of turns analyzed at once; longer games are analyzed in batches
+#define MAX_BATCH_TURNS 256
+
+// Memory kept for move lists unless --cache says otherwise, in megabytes
+#define DEFAULT_CACHE_MB 64
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents the options and running totals of an analysis run
+typedef struct
+{
+    int onlyGame;                  // Game to analyze, 0 for all of them
+    bool summaryOnly;              // Print one line per game instead of every turn
+    int game;                      // Number of the game being read
+    int turn;                      // Number of turns of the game seen so far
+    int pointsLost[2];             // Points each player left on the board in the current game
+    double equityLost[2];          // Equity each player gave away in the current game
+    long turnsAnalyzed;
+    const BingoIndex* bingos;      // Seven-letter anagram keys valuing leaves, NULL with --no-bingo
+    MoveCache* moveCache;          // Move lists of positions already analyzed, NULL with --cache 0
+} AnalysisRun;
+
+// --------------------
+// Analysis
+// --------------------
+
+// Analyzes the buffered turns in parallel and prints them in order
+static void flushTurns(ThreadPool* pool, TurnAnalysis turns[], int numTurns, AnalysisRun* run)
+{
+    analyzeTurns(pool, turns, numTurns);
+
+    for (int i = 0; i < numTurns; i++)
+    {
+        const TurnAnalysis* turn = &turns[i];
+        const Player* player = (turn->player == Player1) ? &turn->position.player1 : &turn->position.player2;
+        run->pointsLost[turn->player] += turn->pointsLost;
+        run->equityLost[turn->player] += turn->equityLost;
+        run->turnsAnalyzed++;
+        if (run->summaryOnly)
+        {
+            continue;
+        }
+
+        char rack[GCG_TEXT_LENGTH];
+        char played[GCG_PLACEMENT_LENGTH], bestScore[GCG_PLACEMENT_LENGTH], bestEquity[GCG_PLACEMENT_LENGTH];
+        formatGcgRack(player->letters, rack, sizeof(rack));
+        formatGcgPlacement(&turn->position, &turn->bestScore, bestScore, sizeof(bestScore));
+        formatGcgPlacement(&turn->position, &turn->bestEquity, bestEquity, sizeof(bestEquity));
+        if (turn->swapped)
+        {
+            // The tiles swapped, the whole rack when none are listed
+            char swapped[GCG_TEXT_LENGTH];
+            formatGcgRack(turn->played.numLetters > 0 ? turn->played.letters : player->letters, swapped, sizeof(swapped));
+            snprintf(played, sizeof(played), "-%s", swapped);
+        }
+        else
+        {
+            formatGcgPlacement(&turn->position, &turn->played, played, sizeof(played));
+        }
+
+        // The tiles the best exchange swaps, the ones it does not keep
+        char exchange[GCG_TEXT_LENGTH + 1] = "";
+        if (turn->canExchange)
+        {
+            char letters[MAX_LETTERS];
+            for (int slot = 0; slot < MAX_LETTERS; slot++)
+            {
+                letters[slot] = (turn->exchangeKeep >> slot & 1) ? '\0' : player->letters[slot];
+            }
+            exchange[0] = '-';
+            formatGcgRack(letters, exchange + 1, sizeof(exchange) - 1);
+        }
+
+        printf("%3d P%d %-7s %-20s %+4d | best score %-20s %+4d (-%d) | best equity %-20s %6.1f (-%.1f) "
+               "bingo %4.1f%% | best exchange %-8s %6.1f | %d moves\n",
+               run->turn - numTurns + i + 1, turn->player + 1, rack, played, turn->played.score, bestScore,
+               turn->bestScore.score, turn->pointsLost, bestEquity, turn->bestEquityValue, turn->equityLost,
+               100.0 * turn->bingoChance, turn->canExchange ? exchange : "none", turn->exchangeValue,
+               turn->numMoves);
+    }
+}
+
+// Walks a record, analyzing every turn of the selected games
+static int runAnalysis(const char* recordName, const Lexicon* lexicon, int numThreads, AnalysisRun* run)
+{
+    RecordReader* reader = openRecordReader(recordName);
+    Game* game = malloc(sizeof(Game));
+    TurnAnalysis* turns = malloc(MAX_BATCH_TURNS * sizeof(TurnAnalysis));
+    if (!reader || !game || !turns)
+    {
+        return EXIT_FAILURE;
+    }
+
+    ThreadPool pool;
+    startThreadPool(&pool, numThreads);
+
+    int numTurns = 0;
+    bool selected = false;
+    double start = nowSeconds();
+    GameEvent event;
+    while (readGameEvent(reader, &event))
+    {
+        if (event.type == Record_GameStart)
+        {
+            run->game++;
+            run->turn = 0;
+            memset(run->pointsLost, 0, sizeof(run->pointsLost));
+            memset(run->equityLost, 0, sizeof(run->equityLost));
+            selected = run->onlyGame == 0 || run->onlyGame == run->game;
+            if (selected && !run->summaryOnly)
+            {
+                printf("Game %d (seed %llu)\n", run->game, event.seed);
+            }
+        }
+        else if (event.type == Record_GameEnd)
+        {
+            if (selected)
+            {
+                flushTurns(&pool, turns, numTurns, run);
+                numTurns = 0;
+                printf("Game %d: %d-%d, points lost %d / %d, equity lost %.1f / %.1f\n", run->game,
+                       event.finalScores[0], event.finalScores[1], run->pointsLost[0], run->pointsLost[1],
+                       run->equityLost[0], run->equityLost[1]);
+            }
+            selected = false;
+        }
+        else if (selected)
+        {
+            // Keep the position before the turn; it is analyzed once the batch is full
+            TurnAnalysis* turn = &turns[numTurns++];
+            cloneGame(game, &turn->position);
+            turn->player = event.player;
+            turn->bingos = run->bingos;
+            turn->moveCache = run->moveCache;
+            turn->swapped = event.type == Record_Reroll || event.type == Record_Exchange;
+            memset(&turn->played, 0, sizeof(Move));
+            if (event.type == Record_Play)
+            {
+                memcpy(turn->played.squares, event.squares, event.numLetters * sizeof(Coordinate));
+                memcpy(turn->played.letters, event.letters, event.numLetters);
+                turn->played.numLetters = event.numLetters;
+                turn->played.score = event.score;
+            }
+            else if (event.type == Record_Exchange)
+            {
+                memcpy(turn->played.letters, event.letters, event.numLetters);
+                turn->played.numLetters = event.numLetters;
+            }
+            run->turn++;
+            if (numTurns == MAX_BATCH_TURNS)
+            {
+                flushTurns(&pool, turns, numTurns, run);
+                numTurns = 0;
+            }
+        }
+        applyGameEvent(game, lexicon, &event);
+    }
+    double seconds = nowSeconds() - start;
+
+    printf("%ld turns analyzed in %.3f s (%.0f turns per second) on %d threads\n", run->turnsAnalyzed, seconds,
+           seconds > 0 ? run->turnsAnalyzed / seconds : 0.0, pool.numThreads);
+    if (run->moveCache != NULL)
+    {
+        MoveCacheStats stats;
+        getMoveCacheStats(run->moveCache, &stats);
+        printf("Move cache: %lu hits, %lu misses, %lu evictions, %d lists in %.1f of %.0f MB\n", stats.hits,
+               stats.misses, stats.evictions, stats.entries, stats.bytes / 1048576.0, stats.budget / 1048576.0);
+    }
+
+    stopThreadPool(&pool);
+    closeRecordReader(reader);
+    free(game);
+    free(turns);
+    return EXIT_SUCCESS;
+}
+
+// --------------------
+// Main Function
+// --------------------
+
+// Prints how to run the tool
+static void printUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [--dict FILE] [--layout FILE] [--threads N] [--game N] [--summary] [--no-bingo] [--cache MB] RECORD\n"
+            "  Replays every game of a binary record and, for each turn, compares the move made with the\n"
+            "  best scoring and the best equity placements, reporting the points and equity lost.\n"
+            "  Equity counts the chance of drawing the leave into a bingo unless --no-bingo is given.\n"
+            "  Positions repeated with the same rack reuse their move lists, kept in --cache MB (default %d,\n"
+            "  0 disables it). --layout reads the board's premium squares from FILE.\n",
+            program, DEFAULT_CACHE_MB);
+}
+
+// Entry point of the analyzer
+int main(int argc, char** argv)
+{
+    const char* dictionary = "palabras.txt";
+    const char* recordName = NULL;
+    int numThreads = 0;
+    bool bingoOdds = true;
+    int cacheMegabytes = DEFAULT_CACHE_MB;
+    AnalysisRun run = {0};
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--dict") == 0 && i + 1 < argc)
+        {
+            dictionary = argv[++i];
+        }
+        else if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc)
+        {
+            if (!loadBoardLayout(argv[++i]))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            numThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--game") == 0 && i + 1 < argc)
+        {
+            run.onlyGame = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--summary") == 0)
+        {
+            run.summaryOnly = true;
+        }
+        else if (strcmp(argv[i], "--no-bingo") == 0)
+        {
+            bingoOdds = false;
+        }
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+        {
+            cacheMegabytes = atoi(argv[++i]);
+        }
+        else if (recordName == NULL && argv[i][0] != '-')
+        {
+            recordName = argv[i];
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (recordName == NULL)
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Lexicon* lexicon = loadValidWords(dictionary);
+    BingoIndex* bingos = bingoOdds ? buildBingoIndex(lexicon) : NULL;
+    run.bingos = bingos;
+    run.moveCache = cacheMegabytes > 0 ? createMoveCache((size_t)cacheMegabytes * 1024 * 1024) : NULL;
+    int status = runAnalysis(recordName, lexicon, numThreads, &run);
+    freeMoveCache(run.moveCache);
+    freeBingoIndex(bingos);
+    freeLexicon(lexicon);
+    return status;
+}
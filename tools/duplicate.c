@@ -0,0 +1,210 @@
+// duplicate.c
+
+#include "scrabble.h"
+#include "duplicate.h"
+#include "openings.h"
+#include "gcg.h"
+#include "threadpool.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Players seated unless --players says otherwise
+#define DEFAULT_PLAYERS 500
+
+// Placements the weakest simulated player chooses among; the strongest always finds the top
+#define SIMULATED_RANKS 40
+
+// One submission in this many has a tile changed, to exercise the rejections
+#define MISTAKE_RATE 20
+
+// --------------------
+// Simulated Players
+// --------------------
+
+// Fills one submission per player: player i picks among the best 1 + i % SIMULATED_RANKS placements,
+// and now and then changes a tile by mistake
+static void simulateSubmissions(const MoveList* list, int numPlayers, unsigned long long* rng,
+                                Submission submissions[])
+{
+    for (int p = 0; p < numPlayers; p++)
+    {
+        Submission* submission = &submissions[p];
+        memset(submission, 0, sizeof(Submission));
+        submission->player = p;
+
+        int ranks = 1 + p % SIMULATED_RANKS;
+        if (ranks > list->count)
+        {
+            ranks = list->count;
+        }
+        submission->move = list->moves[nextSplitMix(rng) % ranks];
+        if (nextSplitMix(rng) % MISTAKE_RATE == 0)
+        {
+            int tile = (int)(nextSplitMix(rng) % submission->move.numLetters);
+            submission->move.letters[tile] = (char)(1 + nextSplitMix(rng) % ALPHABET_SIZE);
+        }
+    }
+}
+
+// --------------------
+// Main Function
+// --------------------
+
+// Prints how to run the tool
+static void printUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [--dict FILE] [--layout FILE] [--players N] [--threads N] [--seed S] [--openings FILE]\n"
+            "          [--quiet]\n"
+            "  Plays a duplicate game in which N simulated players (default %d, at most %d) submit a\n"
+            "  placement of the common rack each round, and prints how long each round took to judge.\n"
+            "  --layout reads the board's premium squares from FILE.\n",
+            program, DEFAULT_PLAYERS, MAX_DUPLICATE_PLAYERS);
+}
+
+// Entry point of the duplicate game simulator
+int main(int argc, char** argv)
+{
+    const char* dictionary = "palabras.txt";
+    const char* openingFile = NULL;
+    int numPlayers = DEFAULT_PLAYERS;
+    int numThreads = 0;
+    unsigned long long seed = (unsigned long long)time(NULL);
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--dict") == 0 && i + 1 < argc)
+        {
+            dictionary = argv[++i];
+        }
+        else if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc)
+        {
+            if (!loadBoardLayout(argv[++i]))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--players") == 0 && i + 1 < argc)
+        {
+            numPlayers = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            numThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--openings") == 0 && i + 1 < argc)
+        {
+            openingFile = argv[++i];
+        }
+        else if (strcmp(argv[i], "--quiet") == 0)
+        {
+            quiet = true;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (numPlayers < 1 || numPlayers > MAX_DUPLICATE_PLAYERS)
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Lexicon* lexicon = loadValidWords(dictionary);
+    OpeningTable* openings = openingFile ? mapOpeningTable(openingFile, lexicon) : NULL;
+    if (openingFile && !openings)
+    {
+        fprintf(stderr, "Ignoring %s: not an opening table for %s\n", openingFile, dictionary);
+    }
+    Submission* submissions = malloc(numPlayers * sizeof(Submission));
+    if (!submissions)
+    {
+        perror("Error allocating submissions");
+        return EXIT_FAILURE;
+    }
+
+    ThreadPool pool;
+    startThreadPool(&pool, numThreads);
+    DuplicateGame dup;
+    initDuplicateGame(&dup, lexicon, seed, numPlayers);
+    dup.openings = openings;
+    unsigned long long rng = seed;
+    MoveList list;
+    initMoveList(&list);
+    double totalSeconds = 0;
+    double slowestSeconds = 0;
+
+    printf("Seed %llu, %d players, %d threads\n", seed, numPlayers, pool.numThreads);
+    while (!dup.game.gameOver)
+    {
+        // The players' own searches are not part of the round's time
+        clearMoveList(&list);
+        generateMoves(&dup.game, dup.game.player1.letters, &list, NULL, NULL);
+        sortMovesByScore(&list);
+        int numSubmissions = list.count > 0 ? numPlayers : 0;
+        if (numSubmissions > 0)
+        {
+            simulateSubmissions(&list, numPlayers, &rng, submissions);
+        }
+
+        Game before;
+        cloneGame(&dup.game, &before);
+        DuplicateRound round;
+        double start = nowSeconds();
+        playDuplicateRound(&dup, submissions, numSubmissions, &pool, &round);
+        double seconds = nowSeconds() - start;
+        totalSeconds += seconds;
+        if (seconds > slowestSeconds)
+        {
+            slowestSeconds = seconds;
+        }
+
+        if (!quiet)
+        {
+            char rack[GCG_TEXT_LENGTH];
+            char top[GCG_PLACEMENT_LENGTH];
+            formatGcgRack(before.player1.letters, rack, sizeof(rack));
+            formatGcgPlacement(&before, &round.top, top, sizeof(top));
+            if (round.played)
+            {
+                printf("%3d  %-9s %-22s %4d  %5d valid  best %4d  %7.2f ms\n", dup.round, rack, top,
+                       round.top.score, round.numValid, round.bestSubmitted, seconds * 1e3);
+            }
+            else
+            {
+                printf("%3d  %-9s redrawn\n", dup.round, rack);
+            }
+        }
+    }
+
+    int best = 0;
+    for (int p = 1; p < numPlayers; p++)
+    {
+        if (dup.scores[p] > dup.scores[best])
+        {
+            best = p;
+        }
+    }
+    printf("%d rounds, top total %d, best player %d with %d (%.1f%%)\n", dup.round, dup.topTotal, best,
+           dup.scores[best], dup.topTotal > 0 ? 100.0 * dup.scores[best] / dup.topTotal : 0.0);
+    printf("Rounds judged in %.2f ms on average, %.2f ms at most\n",
+           dup.round > 0 ? totalSeconds * 1e3 / dup.round : 0.0, slowestSeconds * 1e3);
+
+    freeMoveList(&list);
+    freeDuplicateGame(&dup);
+    stopThreadPool(&pool);
+    free(submissions);
+    freeOpeningTable(openings);
+    freeLexicon(lexicon);
+    return EXIT_SUCCESS;
+}
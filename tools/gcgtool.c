@@ -0,0 +1,310 @@
+// gcgtool.c
+
+#include "scrabble.h"
+#include "gcg.h"
+#include "record.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --------------------
+// Helpers
+// --------------------
+
+// Copies the letter codes of a rack, without its empty slots
+static void rackString(const char letters[MAX_LETTERS], char* text)
+{
+    int length = 0;
+    for (int i = 0; i < MAX_LETTERS; i++)
+    {
+        if (letters[i] != '\0')
+        {
+            text[length++] = letters[i];
+        }
+    }
+    text[length] = '\0';
+}
+
+// --------------------
+// Audit
+// --------------------
+
+// Represents the totals of an audit run
+typedef struct
+{
+    long games;
+    long moves;
+    long plays;
+    long missingWords;                       // Words formed that the lexicon does not have
+    long misfits;                            // Plays that do not fit the board as replayed
+    long scoreDifferences;                   // Plays the engine scores differently from the file
+} AuditTotals;
+
+// Replays one game, reporting the words missing from the lexicon and the plays that do not fit
+static void auditGame(const char* filename, const GcgGame* gcg, const Lexicon* lexicon, bool verbose,
+                      AuditTotals* totals)
+{
+    Game* game = malloc(sizeof(Game));
+    GcgUndo* undos = malloc(GCG_MAX_MOVES * sizeof(GcgUndo));
+    if (!game || !undos)
+    {
+        perror("Error allocating audit game");
+        exit(EXIT_FAILURE);
+    }
+    initGame(game, lexicon, 0);
+    memset(game->player1.letters, '\0', MAX_LETTERS);
+    memset(game->player2.letters, '\0', MAX_LETTERS);
+
+    int made = 0;
+    for (int i = 0; i < gcg->numMoves; i++)
+    {
+        const GcgMove* move = &gcg->moves[i];
+
+        // A challenged play comes off the board before its line is applied
+        if (move->type == Gcg_Withdrawn && made > 0 && gcg->moves[i - 1].type == Gcg_Play)
+        {
+            unmakeGcgMove(game, &undos[--made]);
+        }
+
+        int score = makeGcgMove(game, move, &undos[made]);
+        char word[GCG_TEXT_LENGTH];
+        formatGcgTiles(move->word, word, sizeof(word));
+        totals->moves++;
+        if (move->type == Gcg_Play)
+        {
+            totals->plays++;
+            if (score == GCG_MISFIT)
+            {
+                totals->misfits++;
+                printf("%s: move %d (%s %s) does not fit the board\n", filename, i + 1,
+                       gcg->nicknames[move->player], word);
+            }
+            else
+            {
+                char words[256];
+                int missing = listGcgWords(game, &undos[made], words, sizeof(words));
+                totals->missingWords += missing;
+                if (missing > 0)
+                {
+                    printf("%s: move %d by %s forms %s\n", filename, i + 1, gcg->nicknames[move->player], words);
+                }
+                if (score >= 0 && score != move->score)
+                {
+                    totals->scoreDifferences++;
+                    if (verbose)
+                    {
+                        printf("%s: move %d %s scores %d, the file says %d\n", filename, i + 1, word, score,
+                               move->score);
+                    }
+                }
+            }
+        }
+        made++;
+    }
+
+    totals->games++;
+    freeGame(game);
+    free(game);
+    free(undos);
+}
+
+// Audits GCG files against the lexicon
+static int runAudit(int count, char** filenames, const Lexicon* lexicon, bool verbose)
+{
+    GcgGame* gcg = malloc(sizeof(GcgGame));
+    if (!gcg)
+    {
+        perror("Error allocating GCG game");
+        exit(EXIT_FAILURE);
+    }
+
+    AuditTotals totals = {0};
+    int failed = 0;
+    double start = nowSeconds();
+    for (int i = 0; i < count; i++)
+    {
+        if (!readGcgFile(filenames[i], gcg))
+        {
+            failed++;
+            continue;
+        }
+        auditGame(filenames[i], gcg, lexicon, verbose, &totals);
+    }
+    double seconds = nowSeconds() - start;
+
+    printf("%ld games, %ld moves (%ld plays) in %.3f s (%.0f games per second)\n", totals.games, totals.moves,
+           totals.plays, seconds, seconds > 0 ? totals.games / seconds : 0.0);
+    printf("%ld words missing from the lexicon, %ld plays that do not fit, %ld plays scored differently, "
+           "%d unreadable files\n", totals.missingWords, totals.misfits, totals.scoreDifferences, failed);
+
+    free(gcg);
+    return (failed == 0 && totals.missingWords == 0 && totals.misfits == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --------------------
+// Export
+// --------------------
+
+// Writes a finished game to its own GCG file in the directory
+static bool saveGcg(const char* directory, int number, const GcgGame* gcg)
+{
+    char filename[1024];
+    snprintf(filename, sizeof(filename), "%s/game_%06d.gcg", directory, number);
+    FILE* file = fopen(filename, "w");
+    if (!file)
+    {
+        perror("Error creating GCG file");
+        return false;
+    }
+    writeGcg(file, gcg);
+    fclose(file);
+    return true;
+}
+
+// Converts every game of a binary record into GCG files
+static int runExport(const char* recordName, const char* directory, const Lexicon* lexicon)
+{
+    RecordReader* reader = openRecordReader(recordName);
+    Game* game = malloc(sizeof(Game));
+    GcgGame* gcg = malloc(sizeof(GcgGame));
+    if (!reader || !game || !gcg)
+    {
+        return EXIT_FAILURE;
+    }
+
+    int exported = 0;
+    bool inGame = false;
+    GameEvent event;
+    while (readGameEvent(reader, &event))
+    {
+        if (event.type == Record_GameStart)
+        {
+            memset(gcg, 0, sizeof(GcgGame));
+            strcpy(gcg->nicknames[0], "player1");
+            strcpy(gcg->nicknames[1], "player2");
+            inGame = true;
+        }
+        else if (event.type == Record_GameEnd)
+        {
+            if (inGame && !saveGcg(directory, ++exported, gcg))
+            {
+                break;
+            }
+            inGame = false;
+        }
+        else if (inGame && gcg->numMoves < GCG_MAX_MOVES)
+        {
+            // Describe the event against the position before it
+            GcgMove* move = &gcg->moves[gcg->numMoves++];
+            const Player* player = (event.player == Player1) ? &game->player1 : &game->player2;
+            memset(move, 0, sizeof(GcgMove));
+            move->player = event.player == Player1 ? 0 : 1;
+            rackString(player->letters, move->rack);
+
+            if (event.type == Record_Play)
+            {
+                describeGcgPlay(game, event.squares, event.letters, event.numLetters, move);
+                move->score = event.score;
+            }
+            else if (event.type == Record_Reroll)
+            {
+                move->type = Gcg_Exchange;
+                rackString(player->letters, move->exchanged);
+            }
+            else if (event.type == Record_Exchange)
+            {
+                move->type = Gcg_Exchange;
+                memcpy(move->exchanged, event.letters, event.numLetters);
+                move->exchanged[event.numLetters] = '\0';
+            }
+            else
+            {
+                move->type = Gcg_Pass; // Asking to end the game passes the turn
+            }
+            move->total = player->score + move->score;
+        }
+        applyGameEvent(game, lexicon, &event);
+    }
+
+    printf("Exported %d games to %s\n", exported, directory);
+    closeRecordReader(reader);
+    free(game);
+    free(gcg);
+    return EXIT_SUCCESS;
+}
+
+// --------------------
+// Main Function
+// --------------------
+
+// Prints how to run the tool
+static void printUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s audit [--dict FILE] [--layout FILE] [--verbose] FILE.gcg...\n"
+            "       %s export [--dict FILE] [--layout FILE] RECORD DIRECTORY\n"
+            "  audit   replays GCG games against the lexicon and reports missing words and misfit plays\n"
+            "  export  writes every game of a binary record as a GCG file\n",
+            program, program);
+}
+
+// Entry point of the GCG tool
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char* command = argv[1];
+    const char* dictionary = "palabras.txt";
+    bool verbose = false;
+    char** arguments = malloc(argc * sizeof(char*));
+    int numArguments = 0;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--dict") == 0 && i + 1 < argc)
+        {
+            dictionary = argv[++i];
+        }
+        else if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc)
+        {
+            if (!loadBoardLayout(argv[++i]))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--verbose") == 0)
+        {
+            verbose = true;
+        }
+        else
+        {
+            arguments[numArguments++] = argv[i];
+        }
+    }
+
+    int status;
+    if (strcmp(command, "audit") == 0 && numArguments > 0)
+    {
+        Lexicon* lexicon = loadValidWords(dictionary);
+        status = runAudit(numArguments, arguments, lexicon, verbose);
+        freeLexicon(lexicon);
+    }
+    else if (strcmp(command, "export") == 0 && numArguments == 2)
+    {
+        Lexicon* lexicon = loadValidWords(dictionary);
+        status = runExport(arguments[0], arguments[1], lexicon);
+        freeLexicon(lexicon);
+    }
+    else
+    {
+        printUsage(argv[0]);
+        status = EXIT_FAILURE;
+    }
+
+    free(arguments);
+    return status;
+}
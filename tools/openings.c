@@ -0,0 +1,99 @@
+// openings.c
+
+#include "scrabble.h"
+#include "openings.h"
+#include "wordlist.h"
+#include "threadpool.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --------------------
+// Main Function
+// --------------------
+
+// Prints how to run the tool
+static void printUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [--dict FILE] [--layout FILE] [--threads N] [--top K] [OUTPUT]\n"
+            "  Works out the best opening placements of every seven-tile rack a full bag can deal and\n"
+            "  writes them to OUTPUT (default openings.tbl), which the game and the bots map to answer\n"
+            "  the first turn without a search. --top keeps K placements per rack (default %d, at most %d).\n"
+            "  --layout reads the board's premium squares from FILE.\n",
+            program, OPENING_TOP_MOVES, MAX_OPENING_TOP_MOVES);
+}
+
+// Entry point of the opening table builder
+int main(int argc, char** argv)
+{
+    const char* dictionary = "palabras.txt";
+    const char* output = NULL;
+    int numThreads = 0;
+    int topMoves = OPENING_TOP_MOVES;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--dict") == 0 && i + 1 < argc)
+        {
+            dictionary = argv[++i];
+        }
+        else if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc)
+        {
+            if (!loadBoardLayout(argv[++i]))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            numThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc)
+        {
+            topMoves = atoi(argv[++i]);
+        }
+        else if (output == NULL && argv[i][0] != '-')
+        {
+            output = argv[i];
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (topMoves < 1 || topMoves > MAX_OPENING_TOP_MOVES)
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (output == NULL)
+    {
+        output = "openings.tbl";
+    }
+
+    double start = nowSeconds();
+    ThreadPool pool;
+    startThreadPool(&pool, numThreads);
+    WordList list;
+    readWordList(dictionary, &pool, &list);
+    OpeningTable* table = buildOpeningTable(&list, topMoves, &pool);
+    stopThreadPool(&pool);
+    if (table == NULL)
+    {
+        freeWordList(&list);
+        return EXIT_FAILURE;
+    }
+
+    bool saved = saveOpeningTable(table, output);
+    if (saved)
+    {
+        printf("%u racks, %u placements each, %.1f MB written to %s in %.1f s\n", table->header->numRacks,
+               table->header->topMoves, table->blockSize / (1024.0 * 1024.0), output, nowSeconds() - start);
+    }
+    freeOpeningTable(table);
+    freeWordList(&list);
+    return saved ? EXIT_SUCCESS : EXIT_FAILURE;
+}
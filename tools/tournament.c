@@ -0,0 +1,660 @@
+// tournament.c
+
+#include "scrabble.h"
+#include "bot.h"
+#include "analysis.h"
+#include "movecache.h"
+#include "threadpool.h"
+#include "util.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --------------------
+// Constants and Definitions
+// --------------------
+
+// Most bot configurations one tournament can hold
+#define MAX_BOTS 16
+
+// Game pairs each pairing plays unless --pairs says otherwise
+#define DEFAULT_PAIRS 20
+
+// Game pairs a sequential test may play before it gives up without a decision
+#define DEFAULT_SPRT_PAIRS 5000
+
+// Memory kept for move lists unless --cache says otherwise, in megabytes
+#define DEFAULT_CACHE_MB 256
+
+// Game pairs queued ahead of the oldest unfinished one, per thread
+#define PAIRS_AHEAD 4
+
+// Normal quantile of a two-sided 95% interval
+#define Z_95 1.959964
+
+// Bots play in game pairs: two games from the same bag, each bot moving first once, which cancels most of
+// the luck of the draw. A pair scores 0, 0.25, 0.5, 0.75 or 1 for its first bot, and the intervals and the
+// sequential test treat the pairs as the samples. Pairs are seeded by their place in the schedule and
+// their results are taken in that order, so a tournament gives the same standings and stops at the same
+// pair whatever the number of threads.
+//
+// With two bots, --sprt runs a sequential probability ratio test of "the first bot is elo1 stronger"
+// against "it is elo0 stronger", with the normal approximation of the log-likelihood ratio; play stops
+// as soon as it crosses either bound.
+
+// --------------------
+// Structures
+// --------------------
+
+// Represents how bots are paired
+typedef enum
+{
+    Pairing_RoundRobin,            // Every bot meets every other one in every cycle
+    Pairing_Swiss,                 // Each round pairs bots with close points that have not met yet
+} Pairing;
+
+struct Tournament;
+
+// Represents two games between two bots from the same bag
+typedef struct
+{
+    int bots[2];                   // Bot moving first in the first game, and its opponent
+    unsigned long long seed;
+    int scores[2][2];              // Final scores of each game, by bot
+    bool done;                     // Set by the playing thread under the tournament's mutex
+    struct Tournament* tournament;
+} GamePair;
+
+// Represents the settings and running standings of a tournament
+typedef struct Tournament
+{
+    BotConfig bots[MAX_BOTS];
+    int numBots;
+    BotContext context;
+    Pairing pairing;
+    int pairsPerPairing;           // Game pairs per pairing and cycle (round robin) or round (Swiss)
+    int rounds;                    // Swiss rounds
+    unsigned long long seed;
+    int reportEvery;               // Game pairs between progress lines
+
+    bool sprt;                     // Stop once the sequential test decides
+    double elo0;
+    double elo1;
+    double alpha;
+    double beta;
+    int decision;                  // 1 when elo1 is accepted, -1 when elo0 is, 0 while undecided
+
+    pthread_mutex_t mutex;         // Protects 'stop' and every pair's 'done'
+    pthread_cond_t finished;       // Signalled when a pair is done
+    bool stop;                     // Set to skip the pairs not started yet
+
+    int pairsPlayed;
+    double points[MAX_BOTS];       // Game points: 1 a win, 0.5 a draw
+    int games[MAX_BOTS];
+    int wins[MAX_BOTS];
+    int draws[MAX_BOTS];
+    int losses[MAX_BOTS];
+    double versus[MAX_BOTS][MAX_BOTS]; // Game points of each bot against each other one
+    int met[MAX_BOTS][MAX_BOTS];       // Games between each two bots
+    double pairSum[MAX_BOTS];      // Sum and sum of squares of each bot's pair scores
+    double pairSquares[MAX_BOTS];
+    int pairCount[MAX_BOTS];
+    int byes[MAX_BOTS];            // Swiss rounds sat out, each worth a win of every game of the round
+} Tournament;
+
+// --------------------
+// Helpers
+// --------------------
+
+// Returns the seed of the game pair at a place of the schedule
+static unsigned long long pairSeed(unsigned long long seed, int index)
+{
+    return mixBits(seed + SPLITMIX_INCREMENT * (unsigned long long)(index + 1));
+}
+
+// Returns the Elo difference that gives a score, kept finite at 0 and 1
+static double eloFromScore(double score)
+{
+    if (score < 1e-3)
+    {
+        score = 1e-3;
+    }
+    if (score > 1.0 - 1e-3)
+    {
+        score = 1.0 - 1e-3;
+    }
+    return -400.0 * log10(1.0 / score - 1.0) + 0.0; // No negative zero for an even score
+}
+
+// Returns the expected score of a player rated 'elo' above the other
+static double scoreFromElo(double elo)
+{
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+// Returns a bot's points in the standings, byes included
+static double standingPoints(const Tournament* t, int bot)
+{
+    return t->points[bot] + 2.0 * t->pairsPerPairing * t->byes[bot];
+}
+
+// Returns the mean and the variance of a bot's pair scores
+static void pairStatistics(const Tournament* t, int bot, double* mean, double* variance)
+{
+    int n = t->pairCount[bot];
+    *mean = n > 0 ? t->pairSum[bot] / n : 0.5;
+    *variance = n > 1 ? (t->pairSquares[bot] - n * *mean * *mean) / (n - 1) : 0.0;
+    if (*variance < 0.0)
+    {
+        *variance = 0.0;
+    }
+}
+
+// Returns the 95% interval of a bot's Elo against its opponents
+static void eloInterval(const Tournament* t, int bot, double* low, double* high)
+{
+    double mean, variance;
+    pairStatistics(t, bot, &mean, &variance);
+    double margin = t->pairCount[bot] > 0 ? Z_95 * sqrt(variance / t->pairCount[bot]) : 0.5;
+    *low = eloFromScore(mean - margin);
+    *high = eloFromScore(mean + margin);
+}
+
+// Returns the log-likelihood ratio of elo1 against elo0 for the first bot's pair scores
+static double sprtRatio(const Tournament* t)
+{
+    double mean, variance;
+    pairStatistics(t, 0, &mean, &variance);
+    if (variance <= 0.0)
+    {
+        return 0.0;
+    }
+    double s0 = scoreFromElo(t->elo0);
+    double s1 = scoreFromElo(t->elo1);
+    return t->pairCount[0] * (s1 - s0) * (2.0 * mean - s0 - s1) / (2.0 * variance);
+}
+
+// Fits ratings to every result at once (Bradley-Terry by minorization-maximization); one virtual draw
+// between every two bots that met keeps a bot that never scored finite. Ratings average 0
+static void fitRatings(const Tournament* t, double ratings[MAX_BOTS])
+{
+    double strength[MAX_BOTS];
+    for (int i = 0; i < t->numBots; i++)
+    {
+        strength[i] = 1.0;
+    }
+    for (int iteration = 0; iteration < 500; iteration++)
+    {
+        for (int i = 0; i < t->numBots; i++)
+        {
+            double won = 0.0, expected = 0.0;
+            for (int j = 0; j < t->numBots; j++)
+            {
+                if (j != i && t->met[i][j] > 0)
+                {
+                    won += t->versus[i][j] + 0.5;
+                    expected += (t->met[i][j] + 1) / (strength[i] + strength[j]);
+                }
+            }
+            if (expected > 0.0)
+            {
+                strength[i] = won / expected;
+            }
+        }
+    }
+
+    double mean = 0.0;
+    for (int i = 0; i < t->numBots; i++)
+    {
+        ratings[i] = 400.0 * log10(strength[i]);
+        mean += ratings[i] / t->numBots;
+    }
+    for (int i = 0; i < t->numBots; i++)
+    {
+        ratings[i] -= mean;
+    }
+}
+
+// --------------------
+// Playing
+// --------------------
+
+// Plays both games of a pair unless the tournament has stopped
+static void playPair(void* arg)
+{
+    GamePair* pair = arg;
+    Tournament* t = pair->tournament;
+    pthread_mutex_lock(&t->mutex);
+    bool stop = t->stop;
+    pthread_mutex_unlock(&t->mutex);
+
+    if (!stop)
+    {
+        const BotConfig* first = &t->bots[pair->bots[0]];
+        const BotConfig* second = &t->bots[pair->bots[1]];
+        BotGame game;
+        playBotGame(&t->context, first, second, pair->seed, &game);
+        pair->scores[0][0] = game.scores[0];
+        pair->scores[0][1] = game.scores[1];
+        playBotGame(&t->context, second, first, pair->seed, &game);
+        pair->scores[1][0] = game.scores[1];
+        pair->scores[1][1] = game.scores[0];
+    }
+
+    pthread_mutex_lock(&t->mutex);
+    pair->done = true;
+    pthread_cond_broadcast(&t->finished);
+    pthread_mutex_unlock(&t->mutex);
+}
+
+// Adds the result of a pair to the standings, and stops the tournament once the sequential test decides
+static void recordPair(Tournament* t, const GamePair* pair)
+{
+    int a = pair->bots[0];
+    int b = pair->bots[1];
+    double pairScore = 0.0;
+    for (int g = 0; g < 2; g++)
+    {
+        int difference = pair->scores[g][0] - pair->scores[g][1];
+        double points = difference > 0 ? 1.0 : difference == 0 ? 0.5 : 0.0;
+        pairScore += points / 2;
+        t->points[a] += points;
+        t->points[b] += 1.0 - points;
+        t->versus[a][b] += points;
+        t->versus[b][a] += 1.0 - points;
+        t->met[a][b]++;
+        t->met[b][a]++;
+        t->games[a]++;
+        t->games[b]++;
+        t->wins[a] += difference > 0;
+        t->wins[b] += difference < 0;
+        t->draws[a] += difference == 0;
+        t->draws[b] += difference == 0;
+        t->losses[a] += difference < 0;
+        t->losses[b] += difference > 0;
+    }
+    t->pairSum[a] += pairScore;
+    t->pairSquares[a] += pairScore * pairScore;
+    t->pairCount[a]++;
+    t->pairSum[b] += 1.0 - pairScore;
+    t->pairSquares[b] += (1.0 - pairScore) * (1.0 - pairScore);
+    t->pairCount[b]++;
+    t->pairsPlayed++;
+
+    if (t->sprt)
+    {
+        double ratio = sprtRatio(t);
+        if (ratio >= log((1.0 - t->beta) / t->alpha))
+        {
+            t->decision = 1;
+        }
+        else if (ratio <= log(t->beta / (1.0 - t->alpha)))
+        {
+            t->decision = -1;
+        }
+        if (t->decision != 0)
+        {
+            pthread_mutex_lock(&t->mutex);
+            t->stop = true;
+            pthread_mutex_unlock(&t->mutex);
+        }
+    }
+}
+
+// Prints the standing of the first bot against the second
+static void printMatchLine(const Tournament* t)
+{
+    double mean, variance, low, high;
+    pairStatistics(t, 0, &mean, &variance);
+    eloInterval(t, 0, &low, &high);
+    printf("%5d pairs  %s %d-%d-%d  score %5.1f%%  Elo %+6.1f [%+6.1f, %+6.1f]", t->pairsPlayed, t->bots[0].name,
+           t->wins[0], t->draws[0], t->losses[0], 100.0 * mean, eloFromScore(mean), low, high);
+    if (t->sprt)
+    {
+        printf("  LLR %+5.2f [%+.2f, %+.2f]", sprtRatio(t), log(t->beta / (1.0 - t->alpha)),
+               log((1.0 - t->beta) / t->alpha));
+    }
+    printf("\n");
+}
+
+// Prints every bot from the best rated down
+static void printStandings(const Tournament* t)
+{
+    double ratings[MAX_BOTS];
+    int order[MAX_BOTS];
+    fitRatings(t, ratings);
+    for (int i = 0; i < t->numBots; i++)
+    {
+        int j = i;
+        for (; j > 0 && ratings[order[j - 1]] < ratings[i]; j--)
+        {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+
+    printf("  #  %-20s %6s %8s %7s %7s %14s\n", "Bot", "Games", "Points", "Score", "Elo", "95%");
+    for (int rank = 0; rank < t->numBots; rank++)
+    {
+        int bot = order[rank];
+        double low, high;
+        eloInterval(t, bot, &low, &high);
+        double mean, variance;
+        pairStatistics(t, bot, &mean, &variance);
+        double offset = ratings[bot] - eloFromScore(mean);
+        printf("%3d  %-20s %6d %8.1f %6.1f%% %+7.1f", rank + 1, t->bots[bot].name, t->games[bot],
+               standingPoints(t, bot), t->games[bot] > 0 ? 100.0 * t->points[bot] / t->games[bot] : 0.0,
+               ratings[bot]);
+        if (t->games[bot] > 0)
+        {
+            printf(" [%+5.0f, %+5.0f]", low + offset, high + offset);
+        }
+        printf("\n");
+    }
+}
+
+// Plays pairs in parallel and takes their results in order, reporting as they come in
+static void runPairs(Tournament* t, ThreadPool* pool, GamePair pairs[], int count)
+{
+    int ahead = PAIRS_AHEAD * pool->numThreads;
+    int submitted = 0;
+    for (int next = 0; next < count && !t->stop; next++)
+    {
+        while (submitted < count && submitted < next + ahead)
+        {
+            submitTask(pool, playPair, &pairs[submitted++]);
+        }
+
+        pthread_mutex_lock(&t->mutex);
+        while (!pairs[next].done)
+        {
+            pthread_cond_wait(&t->finished, &t->mutex);
+        }
+        pthread_mutex_unlock(&t->mutex);
+
+        recordPair(t, &pairs[next]);
+        if (t->numBots == 2 && (t->pairsPlayed % t->reportEvery == 0 || t->stop))
+        {
+            printMatchLine(t);
+        }
+    }
+    waitForTasks(pool);
+}
+
+// Fills a pair of the schedule
+static void schedulePair(Tournament* t, GamePair* pair, int index, int a, int b)
+{
+    memset(pair, 0, sizeof(GamePair));
+    pair->bots[0] = a;
+    pair->bots[1] = b;
+    pair->seed = pairSeed(t->seed, index);
+    pair->tournament = t;
+}
+
+// Plays every bot against every other one, cycle after cycle
+static void runRoundRobin(Tournament* t, ThreadPool* pool)
+{
+    int pairings = t->numBots * (t->numBots - 1) / 2;
+    int count = pairings * t->pairsPerPairing;
+    GamePair* pairs = malloc(count * sizeof(GamePair));
+    if (!pairs)
+    {
+        perror("Error allocating schedule");
+        exit(EXIT_FAILURE);
+    }
+    int index = 0;
+    for (int cycle = 0; cycle < t->pairsPerPairing; cycle++)
+    {
+        for (int a = 0; a < t->numBots; a++)
+        {
+            for (int b = a + 1; b < t->numBots; b++)
+            {
+                schedulePair(t, &pairs[index], index, a, b);
+                index++;
+            }
+        }
+    }
+    runPairs(t, pool, pairs, count);
+    free(pairs);
+}
+
+// Plays Swiss rounds: bots are ranked by points and each takes the best ranked one it has not met, or
+// the best ranked one left if it has met them all. With an odd number the lowest ranked bot among those
+// that sat out least sits out first, and scores as if it had won
+static void runSwiss(Tournament* t, ThreadPool* pool)
+{
+    GamePair* pairs = malloc((t->numBots / 2) * t->pairsPerPairing * sizeof(GamePair));
+    if (!pairs)
+    {
+        perror("Error allocating schedule");
+        exit(EXIT_FAILURE);
+    }
+    int index = 0;
+    for (int round = 0; round < t->rounds; round++)
+    {
+        int order[MAX_BOTS] = {0};
+        for (int i = 0; i < t->numBots; i++)
+        {
+            int j = i;
+            for (; j > 0 && standingPoints(t, order[j - 1]) < standingPoints(t, i); j--)
+            {
+                order[j] = order[j - 1];
+            }
+            order[j] = i;
+        }
+
+        bool paired[MAX_BOTS] = {false};
+        if (t->numBots % 2 != 0)
+        {
+            int bye = order[t->numBots - 1];
+            for (int i = t->numBots - 1; i >= 0; i--)
+            {
+                if (t->byes[order[i]] < t->byes[bye])
+                {
+                    bye = order[i];
+                }
+            }
+            paired[bye] = true;
+            t->byes[bye]++;
+            printf("Round %d: %s sits out\n", round + 1, t->bots[bye].name);
+        }
+        int count = 0;
+        for (int i = 0; i < t->numBots; i++)
+        {
+            int a = order[i];
+            if (paired[a])
+            {
+                continue;
+            }
+            int opponent = -1;
+            for (int j = i + 1; j < t->numBots; j++)
+            {
+                int b = order[j];
+                if (!paired[b] && (opponent < 0 || (t->met[a][opponent] > 0 && t->met[a][b] == 0)))
+                {
+                    opponent = b;
+                }
+            }
+            paired[a] = paired[opponent] = true;
+            for (int p = 0; p < t->pairsPerPairing; p++)
+            {
+                schedulePair(t, &pairs[count++], index++, a, opponent);
+            }
+        }
+        runPairs(t, pool, pairs, count);
+        printf("After round %d:\n", round + 1);
+        printStandings(t);
+    }
+    free(pairs);
+}
+
+// --------------------
+// Main Function
+// --------------------
+
+// Prints how to run the tool
+static void printUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [--dict FILE] [--layout FILE] [--threads N] [--seed S] [--pairs N] [--swiss ROUNDS]\n"
+            "          [--sprt ELO0,ELO1] [--alpha A] [--beta B] [--report N] [--cache MB] BOT BOT...\n"
+            "  Plays bots against each other in game pairs (the same bag, each bot moving first once),\n"
+            "  round robin or in Swiss rounds, and rates them with Elo and 95%% intervals. A bot is written\n"
+            "  [NAME=]STRATEGY[,swap=VALUE], the strategy being score, equity or bingo. --pairs sets the\n"
+            "  game pairs of each pairing (default %d). With two bots, --sprt plays up to --pairs pairs\n"
+            "  (default %d) and stops once the first bot is shown ELO1 stronger or not ELO0 stronger.\n"
+            "  --layout reads the board's premium squares from FILE.\n",
+            program, DEFAULT_PAIRS, DEFAULT_SPRT_PAIRS);
+}
+
+// Entry point of the tournament runner
+int main(int argc, char** argv)
+{
+    const char* dictionary = "palabras.txt";
+    int numThreads = 0;
+    int cacheMegabytes = DEFAULT_CACHE_MB;
+    int pairs = 0;
+    Tournament* t = calloc(1, sizeof(Tournament));
+    if (!t)
+    {
+        perror("Error allocating tournament");
+        return EXIT_FAILURE;
+    }
+    t->pairing = Pairing_RoundRobin;
+    t->seed = 1;
+    t->reportEvery = 10;
+    t->alpha = 0.05;
+    t->beta = 0.05;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--dict") == 0 && i + 1 < argc)
+        {
+            dictionary = argv[++i];
+        }
+        else if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc)
+        {
+            if (!loadBoardLayout(argv[++i]))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            numThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            t->seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--pairs") == 0 && i + 1 < argc)
+        {
+            pairs = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--swiss") == 0 && i + 1 < argc)
+        {
+            t->pairing = Pairing_Swiss;
+            t->rounds = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--sprt") == 0 && i + 1 < argc &&
+                 sscanf(argv[i + 1], "%lf,%lf", &t->elo0, &t->elo1) == 2)
+        {
+            t->sprt = true;
+            i++;
+        }
+        else if (strcmp(argv[i], "--alpha") == 0 && i + 1 < argc)
+        {
+            t->alpha = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--beta") == 0 && i + 1 < argc)
+        {
+            t->beta = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc)
+        {
+            t->reportEvery = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+        {
+            cacheMegabytes = atoi(argv[++i]);
+        }
+        else if (argv[i][0] != '-' && t->numBots < MAX_BOTS && parseBotConfig(argv[i], &t->bots[t->numBots]))
+        {
+            t->numBots++;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    t->pairsPerPairing = pairs > 0 ? pairs : t->sprt ? DEFAULT_SPRT_PAIRS : DEFAULT_PAIRS;
+    bool sprtUsable = !t->sprt || (t->numBots == 2 && t->pairing == Pairing_RoundRobin && t->elo1 > t->elo0 &&
+                                   t->alpha > 0.0 && t->alpha < 1.0 && t->beta > 0.0 && t->beta < 1.0);
+    if (t->numBots < 2 || !sprtUsable || t->reportEvery < 1 || (t->pairing == Pairing_Swiss && t->rounds < 1))
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Lexicon* lexicon = loadValidWords(dictionary);
+    bool needBingos = false;
+    for (int i = 0; i < t->numBots; i++)
+    {
+        needBingos = needBingos || t->bots[i].strategy == Bot_Bingo;
+    }
+    BingoIndex* bingos = needBingos ? buildBingoIndex(lexicon) : NULL;
+    MoveCache* moveCache = cacheMegabytes > 0 ? createMoveCache((size_t)cacheMegabytes * 1024 * 1024) : NULL;
+    t->context.lexicon = lexicon;
+    t->context.bingos = bingos;
+    t->context.moveCache = moveCache;
+    pthread_mutex_init(&t->mutex, NULL);
+    pthread_cond_init(&t->finished, NULL);
+
+    ThreadPool pool;
+    startThreadPool(&pool, numThreads);
+    printf("Seed %llu, %d threads\n", t->seed, pool.numThreads);
+    for (int i = 0; i < t->numBots; i++)
+    {
+        printf("  %-20s %s, swap below %g\n", t->bots[i].name, botStrategyName(t->bots[i].strategy),
+               t->bots[i].swapBelow);
+    }
+
+    double start = nowSeconds();
+    if (t->pairing == Pairing_Swiss)
+    {
+        runSwiss(t, &pool);
+    }
+    else
+    {
+        runRoundRobin(t, &pool);
+        printStandings(t);
+    }
+    stopThreadPool(&pool);
+    double seconds = nowSeconds() - start;
+
+    if (t->sprt)
+    {
+        printf("%s after %d pairs: %s\n", t->decision > 0 ? "H1 accepted" : t->decision < 0 ? "H0 accepted" : "No decision",
+               t->pairsPlayed, t->decision > 0 ? "the first bot is the stronger" :
+                               t->decision < 0 ? "the first bot is not the stronger" : "the pair limit was reached");
+    }
+    printf("%d games in %.1f s (%.2f games per second)\n", 2 * t->pairsPlayed, seconds,
+           seconds > 0 ? 2 * t->pairsPlayed / seconds : 0.0);
+    if (moveCache != NULL)
+    {
+        MoveCacheStats stats;
+        getMoveCacheStats(moveCache, &stats);
+        printf("Move cache: %lu hits, %lu misses\n", stats.hits, stats.misses);
+    }
+
+    pthread_cond_destroy(&t->finished);
+    pthread_mutex_destroy(&t->mutex);
+    freeMoveCache(moveCache);
+    freeBingoIndex(bingos);
+    freeLexicon(lexicon);
+    free(t);
+    return EXIT_SUCCESS;
+}